@@ -1,9 +1,42 @@
+#include <cstdlib>
+#include <cstring>
 #include "ezg_engine/engine.hpp"
 
+using ezg::util::StressSceneGenerator;
+
 int main(int argc, char* argv[]) {
+  // --stress-objects replaces the default scene with a generated one
+  ezg::util::StressSceneConfig stress{};
+  bool useStressScene    = false;
+  uint32_t recordThreads = 0;
+  for (int i = 1; i + 1 < argc; i++) {
+    if (std::strcmp(argv[i], "--stress-objects") == 0) {
+      stress.num_objects = std::strtoul(argv[++i], nullptr, 10);
+      useStressScene     = true;
+    } else if (std::strcmp(argv[i], "--stress-layout") == 0) {
+      StressSceneGenerator::ParseDistribution(argv[++i], stress.distribution);
+    } else if (std::strcmp(argv[i], "--stress-repeat") == 0) {
+      StressSceneGenerator::ParseRepetition(argv[++i], stress.repetition);
+    } else if (std::strcmp(argv[i], "--stress-animated") == 0) {
+      stress.animated_fraction = std::strtof(argv[++i], nullptr);
+    } else if (std::strcmp(argv[i], "--stress-animation") == 0) {
+      StressSceneGenerator::ParseAnimation(argv[++i], stress.animation);
+    } else if (std::strcmp(argv[i], "--stress-seed") == 0) {
+      stress.seed = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--record-threads") == 0) {
+      // defaults to 1, inline, compare against N with a stress scene of many materials
+      recordThreads = std::strtoul(argv[++i], nullptr, 10);
+    }
+  }
   ezg::EGEngine engine;
+  if (useStressScene) {
+    engine.SetStressScene(stress);
+  }
+  if (recordThreads > 0) {
+    engine.SetRecordThreads(recordThreads);
+  }
   engine.Init();
   engine.Run();
   engine.Destroy();
   return 0;
-}
\ No newline at end of file
+}
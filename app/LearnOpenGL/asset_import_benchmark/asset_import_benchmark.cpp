@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "log.hpp"
+#include "managers/import_stats.hpp"
+#include "managers/resource_manager.hpp"
+#include "systems/window_system.hpp"
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace ezg::system;
+using namespace ezg::gl;
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+extern "C" {
+__declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
+}
+#endif
+
+enum class AssetType { Gltf, Obj, Hdr, Cubemap };
+
+struct Asset {
+  AssetType type;
+  std::string path;
+  // files read by the import, evicted from the page cache before cold runs
+  std::vector<std::string> files;
+  std::vector<std::string> faces;
+};
+
+struct Run {
+  ImportRecord record;
+  bool cold;
+  uint32_t index;
+};
+
+static constexpr std::array<const char*, 6> CubemapFaces = {"right", "left",  "top",
+                                                            "bottom", "front", "back"};
+
+static void print_usage(const char* program) {
+  spd::info(
+      "Usage: {} [--runs <n>] [--cold] [--output <file.json>] [--cubemap <dir>]... <file or "
+      "directory>...",
+      program);
+  spd::info("  directories (e.g. glTF-Sample-Models/2.0) are searched for .gltf, .obj and .hdr");
+  spd::info("  --cubemap expects right/left/top/bottom/front/back images in the directory");
+  spd::info("  --cold evicts every file of an asset from the OS file cache before one extra run");
+}
+
+static std::vector<std::string> list_files(const fs::path& dir) {
+  std::vector<std::string> files;
+  for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+    if (entry.is_regular_file()) {
+      files.push_back(entry.path().string());
+    }
+  }
+  return files;
+}
+
+static void add_file(const fs::path& path, std::vector<Asset>& assets) {
+  const auto ext = path.extension().string();
+  if (ext == ".gltf") {
+    // buffers and textures live next to the .gltf
+    assets.push_back({AssetType::Gltf, path.string(), list_files(path.parent_path()), {}});
+  } else if (ext == ".obj") {
+    assets.push_back({AssetType::Obj, path.string(), {path.string()}, {}});
+  } else if (ext == ".hdr") {
+    assets.push_back({AssetType::Hdr, path.string(), {path.string()}, {}});
+  }
+}
+
+static bool add_cubemap(const fs::path& dir, std::vector<Asset>& assets) {
+  Asset asset{AssetType::Cubemap, dir.string(), {}, {}};
+  for (const auto* face : CubemapFaces) {
+    for (const auto& entry : fs::directory_iterator(dir)) {
+      if (entry.path().stem() == face) {
+        asset.faces.push_back(entry.path().string());
+        break;
+      }
+    }
+  }
+  if (asset.faces.size() != CubemapFaces.size()) {
+    spd::error("Cubemap directory {} needs right/left/top/bottom/front/back images", dir.string());
+    return false;
+  }
+  asset.files = asset.faces;
+  assets.push_back(std::move(asset));
+  return true;
+}
+
+// evict the files from the page cache so the next import has to hit the disk
+static bool drop_file_cache(const std::vector<std::string>& files) {
+#ifdef __linux__
+  bool success = true;
+  for (const auto& file : files) {
+    const int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+      success = false;
+      continue;
+    }
+    fdatasync(fd);
+    success &= posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+  }
+  return success;
+#else
+  (void)files;
+  return false;
+#endif
+}
+
+static void import_asset(const Asset& asset) {
+  auto& resource_manager = ResourceManager::GetInstance();
+  switch (asset.type) {
+    case AssetType::Gltf:
+      resource_manager.load_gltf_model(asset.path);
+      break;
+    case AssetType::Obj:
+      resource_manager.load_model(asset.path, asset.path);
+      break;
+    case AssetType::Hdr:
+      resource_manager.load_hdr_texture(asset.path);
+      break;
+    case AssetType::Cubemap:
+      resource_manager.load_cubemap_textures(asset.path, asset.faces);
+      break;
+  }
+  // next run imports from scratch
+  resource_manager.clear_caches();
+}
+
+static double get_mb_per_s(uint64_t bytes, double ms) {
+  return ms > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / (ms * 1e-3) : 0.0;
+}
+
+static void write_json_string(std::ofstream& file, const std::string& str) {
+  file << '"';
+  for (const char c : str) {
+    if (c == '"' || c == '\\') {
+      file << '\\' << c;
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      file << c;
+    }
+  }
+  file << '"';
+}
+
+static void write_stages(std::ofstream& file, const ImportRecord& record) {
+  file << "{";
+  for (size_t i = 0; i < record.stage_ms.size(); i++) {
+    file << (i == 0 ? "" : ",") << "\"" << ImportStats::get_stage_name(static_cast<ImportStage>(i))
+         << "_ms\":" << record.stage_ms[i];
+  }
+  file << "}";
+}
+
+// sums of all runs with the given cache state, the whole-set throughput
+static ImportRecord sum_runs(const std::vector<Run>& runs, bool cold) {
+  ImportRecord total{};
+  for (const auto& run : runs) {
+    if (run.cold != cold) {
+      continue;
+    }
+    total.file_bytes += run.record.file_bytes;
+    total.total_ms += run.record.total_ms;
+    for (size_t i = 0; i < total.stage_ms.size(); i++) {
+      total.stage_ms[i] += run.record.stage_ms[i];
+    }
+  }
+  return total;
+}
+
+static bool write_json(const std::string& path, const std::vector<Run>& runs) {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    spd::error("Failed to open {} for writing import results", path);
+    return false;
+  }
+  file.precision(4);
+  file << std::fixed;
+  file << "{\n\"runs\":[\n";
+  for (size_t i = 0; i < runs.size(); i++) {
+    const auto& record = runs[i].record;
+    file << (i == 0 ? "" : ",\n") << "{\"path\":";
+    write_json_string(file, record.path);
+    file << ",\"type\":\"" << record.type << "\",\"cache\":\"" << (runs[i].cold ? "cold" : "warm")
+         << "\",\"run\":" << runs[i].index << ",\"file_bytes\":" << record.file_bytes
+         << ",\"total_ms\":" << record.total_ms
+         << ",\"mb_per_s\":" << get_mb_per_s(record.file_bytes, record.total_ms) << ",\"stages\":";
+    write_stages(file, record);
+    file << "}";
+  }
+  file << "\n],\n\"summary\":{";
+  for (const bool cold : {false, true}) {
+    const auto total = sum_runs(runs, cold);
+    file << (cold ? "," : "") << "\"" << (cold ? "cold" : "warm")
+         << "\":{\"file_bytes\":" << total.file_bytes << ",\"total_ms\":" << total.total_ms
+         << ",\"mb_per_s\":" << get_mb_per_s(total.file_bytes, total.total_ms) << ",\"stages\":";
+    write_stages(file, total);
+    file << "}";
+  }
+  file << "}\n}\n";
+  spd::info("Import results written to {}", path);
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t num_runs = 3;
+  bool cold         = false;
+  std::string output_path;
+  std::vector<Asset> assets;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--runs") == 0 && has_value) {
+      num_runs = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--cold") == 0) {
+      cold = true;
+    } else if (std::strcmp(argv[i], "--output") == 0 && has_value) {
+      output_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--cubemap") == 0 && has_value) {
+      if (!add_cubemap(argv[++i], assets)) {
+        return 1;
+      }
+    } else if (argv[i][0] != '-' && fs::is_directory(argv[i])) {
+      for (const auto& entry : fs::recursive_directory_iterator(argv[i])) {
+        // tinygltf is built without Draco
+        if (entry.is_regular_file() && entry.path().string().find("Draco") == std::string::npos) {
+          add_file(entry.path(), assets);
+        }
+      }
+    } else if (argv[i][0] != '-' && fs::is_regular_file(argv[i])) {
+      add_file(argv[i], assets);
+    } else {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (assets.empty()) {
+    print_usage(argv[0]);
+    return 1;
+  }
+  std::sort(assets.begin(), assets.end(),
+            [](const Asset& a, const Asset& b) { return a.path < b.path; });
+
+  // uploads need a context, nothing is shown
+  auto window_config     = Window::default_config();
+  window_config.title    = "Asset Import Benchmark";
+  window_config.headless = true;
+  Window window(window_config);
+
+  auto& import_stats = ImportStats::GetInstance();
+  import_stats.set_enabled(true);
+  std::vector<Run> runs;
+  bool cache_drop_failed = false;
+  for (const auto& asset : assets) {
+    if (cold) {
+      if (drop_file_cache(asset.files)) {
+        import_asset(asset);
+        for (auto& record : import_stats.take_records()) {
+          runs.push_back({std::move(record), true, 0});
+        }
+      } else {
+        cache_drop_failed = true;
+      }
+    }
+    for (uint32_t run = 0; run < num_runs; run++) {
+      import_asset(asset);
+      for (auto& record : import_stats.take_records()) {
+        runs.push_back({std::move(record), false, run});
+      }
+    }
+  }
+  if (cache_drop_failed) {
+    spd::warn("Could not evict files from the OS file cache on this platform, cold runs skipped");
+  }
+
+  for (const auto& run : runs) {
+    const auto& record = run.record;
+    spd::info("{:<5} {:>8.2f} ms {:>8.1f} MB/s  io {:.2f} parse {:.2f} decode {:.2f} image {:.2f} "
+              "upload {:.2f}  {}",
+              run.cold ? "cold" : "warm", record.total_ms,
+              get_mb_per_s(record.file_bytes, record.total_ms), record.get(ImportStage::FileIO),
+              record.get(ImportStage::Parse), record.get(ImportStage::Decode),
+              record.get(ImportStage::ImageDecode), record.get(ImportStage::Upload), record.path);
+  }
+  if (!output_path.empty()) {
+    write_json(output_path, runs);
+  }
+  return 0;
+}
@@ -1,15 +1,106 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
 #include "engine/engine.hpp"
+#include "log.hpp"
 
 using namespace ezg::system;
 using namespace ezg::gl;
+using ezg::util::StressSceneGenerator;
 
+#ifdef _WIN32
 extern "C" {
 __declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
 }
+#endif
+
+static void print_usage(const char* program) {
+  spd::info(
+      "Usage: {} [--scene <name>] [--width <px>] [--height <px>] [--headless] [--frames <n>] "
+      "[--screenshot <file.ppm>] [--fixed-dt <seconds>] [--camera-path <file>] "
+      "[--record-camera <file>] [--benchmark <file.json>] [--warmup <frames>] [--on-demand] "
+      "[--idle-timeout <seconds>] [--single-threaded] [--draw-threads <n>]",
+      program);
+  spd::info(
+      "  --scene StressScene options: [--stress-objects <n>] [--stress-meshes <n>] "
+      "[--stress-materials <n>] [--stress-layout grid|uniform|clusters] "
+      "[--stress-repeat sequential|interleaved|random] [--stress-animated <fraction>] "
+      "[--stress-animation spin|orbit|bounce] [--stress-seed <n>]");
+}
+
+int main(int argc, char* argv[]) {
+  EngineConfig config{};
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--headless") == 0) {
+      config.headless = true;
+    } else if (std::strcmp(argv[i], "--frames") == 0 && has_value) {
+      config.max_frames = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--scene") == 0 && has_value) {
+      config.scene = argv[++i];
+    } else if (std::strcmp(argv[i], "--width") == 0 && has_value) {
+      config.width = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--height") == 0 && has_value) {
+      config.height = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--screenshot") == 0 && has_value) {
+      config.screenshot_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--fixed-dt") == 0 && has_value) {
+      config.fixed_time_step = std::strtof(argv[++i], nullptr);
+    } else if (std::strcmp(argv[i], "--camera-path") == 0 && has_value) {
+      config.camera_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--record-camera") == 0 && has_value) {
+      config.record_camera_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--benchmark") == 0 && has_value) {
+      config.benchmark_output = argv[++i];
+    } else if (std::strcmp(argv[i], "--warmup") == 0 && has_value) {
+      config.warmup_frames = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--on-demand") == 0) {
+      config.on_demand = true;
+    } else if (std::strcmp(argv[i], "--idle-timeout") == 0 && has_value) {
+      config.idle_timeout = std::strtod(argv[++i], nullptr);
+    } else if (std::strcmp(argv[i], "--single-threaded") == 0) {
+      config.render_thread = false;
+    } else if (std::strcmp(argv[i], "--draw-threads") == 0 && has_value) {
+      config.draw_list_threads = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--stress-objects") == 0 && has_value) {
+      config.stress.num_objects = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--stress-meshes") == 0 && has_value) {
+      config.stress.num_meshes = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--stress-materials") == 0 && has_value) {
+      config.stress.num_materials = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--stress-layout") == 0 && has_value &&
+               StressSceneGenerator::ParseDistribution(argv[i + 1], config.stress.distribution)) {
+      i++;
+    } else if (std::strcmp(argv[i], "--stress-repeat") == 0 && has_value &&
+               StressSceneGenerator::ParseRepetition(argv[i + 1], config.stress.repetition)) {
+      i++;
+    } else if (std::strcmp(argv[i], "--stress-animated") == 0 && has_value) {
+      config.stress.animated_fraction = std::strtof(argv[++i], nullptr);
+    } else if (std::strcmp(argv[i], "--stress-animation") == 0 && has_value &&
+               StressSceneGenerator::ParseAnimation(argv[i + 1], config.stress.animation)) {
+      i++;
+    } else if (std::strcmp(argv[i], "--stress-seed") == 0 && has_value) {
+      config.stress.seed = std::strtoul(argv[++i], nullptr, 10);
+    } else {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (!Engine::has_scene(config.scene)) {
+    std::string names;
+    for (const auto& name : Engine::get_scene_names()) {
+      names += names.empty() ? name : ", " + name;
+    }
+    spd::error("Unknown scene '{}', available scenes: {}", config.scene, names);
+    return 1;
+  }
+  if (config.headless && config.max_frames == 0 && config.camera_path.empty()) {
+    // nobody can close a hidden window
+    config.max_frames = 1;
+  }
 
-int main() {
   Engine engine;
-  engine.initialize("SimpleScene");
+  engine.initialize(config);
   engine.run();
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,57 @@
+#include <vector>
+#include "assets/aabb.hpp"
+#include "benchmark.hpp"
+
+using namespace ezg::bench;
+using namespace ezg::gl;
+
+static std::vector<AABB> make_boxes(int64_t count) {
+  std::vector<AABB> boxes;
+  boxes.reserve(count);
+  for (int64_t i = 0; i < count; i++) {
+    const auto f = static_cast<float>(i);
+    boxes.emplace_back(glm::vec3(f, -1.0f, -f), glm::vec3(f + 2.0f, 1.0f + 0.01f * f, 3.0f - f));
+  }
+  return boxes;
+}
+
+// range(0): number of boxes moved per iteration, the per frame work of placing loaded models
+static void BM_AABBTranslate(State& state) {
+  auto boxes = make_boxes(state.range(0));
+  float t    = 0.0f;
+  for (auto _ : state) {
+    t += 0.001f;
+    for (auto& box : boxes) {
+      box.translate(glm::vec3(t, 0.0f, -t));
+    }
+    DoNotOptimize(boxes.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_AABBTranslate)->Arg(64)->Arg(4096)->Arg(65536);
+
+static void BM_AABBScale(State& state) {
+  const auto source = make_boxes(state.range(0));
+  auto boxes        = source;
+  for (auto _ : state) {
+    for (auto& box : boxes) {
+      box.scale(1.0001f);
+    }
+    DoNotOptimize(boxes.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_AABBScale)->Arg(64)->Arg(4096)->Arg(65536);
+
+static void BM_AABBGetCenter(State& state) {
+  const auto boxes = make_boxes(state.range(0));
+  for (auto _ : state) {
+    glm::vec3 sum{0.0f};
+    for (const auto& box : boxes) {
+      sum += box.get_center();
+    }
+    DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_AABBGetCenter)->Arg(64)->Arg(4096)->Arg(65536);
@@ -0,0 +1,145 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace ezg::bench {
+static std::vector<std::unique_ptr<Benchmark>>& registry() {
+  static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+  return benchmarks;
+}
+
+void UseCharPointer(const volatile char*) {}
+
+void State::Start() {
+  m_start   = Clock::now();
+  m_running = true;
+}
+
+void State::Stop() {
+  if (m_running) {
+    m_elapsed_ns += std::chrono::duration<double, std::nano>(Clock::now() - m_start).count();
+    m_running = false;
+  }
+}
+
+void State::PauseTiming() {
+  Stop();
+}
+
+void State::ResumeTiming() {
+  Start();
+}
+
+Benchmark* Benchmark::Arg(int64_t arg) {
+  m_args.push_back({arg});
+  return this;
+}
+
+Benchmark* Benchmark::Args(std::vector<int64_t> args) {
+  m_args.push_back(std::move(args));
+  return this;
+}
+
+Benchmark* RegisterBenchmark(const char* name, BenchmarkFunc func) {
+  return registry().emplace_back(std::make_unique<Benchmark>(name, func)).get();
+}
+
+static std::string format_time(double ns) {
+  char buffer[32];
+  if (ns < 1e3) {
+    std::snprintf(buffer, sizeof(buffer), "%.1f ns", ns);
+  } else if (ns < 1e6) {
+    std::snprintf(buffer, sizeof(buffer), "%.2f us", ns * 1e-3);
+  } else {
+    std::snprintf(buffer, sizeof(buffer), "%.2f ms", ns * 1e-6);
+  }
+  return buffer;
+}
+
+static std::string format_rate(double per_second, const char* unit) {
+  char buffer[32];
+  if (per_second >= 1e9) {
+    std::snprintf(buffer, sizeof(buffer), "%.2fG%s/s", per_second * 1e-9, unit);
+  } else if (per_second >= 1e6) {
+    std::snprintf(buffer, sizeof(buffer), "%.2fM%s/s", per_second * 1e-6, unit);
+  } else if (per_second >= 1e3) {
+    std::snprintf(buffer, sizeof(buffer), "%.2fk%s/s", per_second * 1e-3, unit);
+  } else {
+    std::snprintf(buffer, sizeof(buffer), "%.2f%s/s", per_second, unit);
+  }
+  return buffer;
+}
+
+// grow the iteration count until one run takes at least min_time_s, like Google Benchmark does
+static State run_benchmark(const Benchmark& benchmark, const std::vector<int64_t>& args,
+                           double min_time_s) {
+  constexpr int64_t MaxIterations = 1'000'000'000;
+  int64_t iterations              = 1;
+  while (true) {
+    State state(args, iterations);
+    benchmark.GetFunc()(state);
+    const double elapsed_s = state.GetElapsedNs() * 1e-9;
+    if (elapsed_s >= min_time_s || iterations >= MaxIterations) {
+      return state;
+    }
+    const double scale = elapsed_s > 0.0 ? std::min(1.4 * min_time_s / elapsed_s, 10.0) : 10.0;
+    const auto next    = static_cast<int64_t>(static_cast<double>(iterations) * scale);
+    iterations         = std::min(MaxIterations, std::max(iterations + 1, next));
+  }
+}
+
+int RunBenchmarks(int argc, char* argv[]) {
+  const char* filter = "";
+  double min_time_s  = 0.5;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--filter") == 0 && has_value) {
+      filter = argv[++i];
+    } else if (std::strcmp(argv[i], "--min-time") == 0 && has_value) {
+      min_time_s = std::strtod(argv[++i], nullptr);
+    } else {
+      std::printf("Usage: %s [--filter <substring>] [--min-time <seconds>]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::printf("%-56s %14s %12s %14s\n", "Benchmark", "Time", "Iterations", "Throughput");
+  std::printf("%s\n", std::string(99, '-').c_str());
+  for (const auto& benchmark : registry()) {
+    auto arg_lists = benchmark->GetArgs();
+    if (arg_lists.empty()) {
+      arg_lists.emplace_back();
+    }
+    for (const auto& args : arg_lists) {
+      std::string name = benchmark->GetName();
+      for (const auto arg : args) {
+        name += "/" + std::to_string(arg);
+      }
+      if (name.find(filter) == std::string::npos) {
+        continue;
+      }
+      const auto state       = run_benchmark(*benchmark, args, min_time_s);
+      const double ns_per_it = state.GetElapsedNs() / static_cast<double>(state.iterations());
+      const double elapsed_s = state.GetElapsedNs() * 1e-9;
+      std::string throughput;
+      if (state.GetBytesProcessed() > 0) {
+        throughput = format_rate(state.GetBytesProcessed() / elapsed_s, "B");
+      } else if (state.GetItemsProcessed() > 0) {
+        throughput = format_rate(state.GetItemsProcessed() / elapsed_s, "");
+      }
+      std::printf("%-56s %14s %12lld %14s %s\n", name.c_str(), format_time(ns_per_it).c_str(),
+                  static_cast<long long>(state.iterations()), throughput.c_str(),
+                  state.GetLabel().c_str());
+    }
+  }
+  return 0;
+}
+}  // namespace ezg::bench
+
+int main(int argc, char* argv[]) {
+  return ezg::bench::RunBenchmarks(argc, argv);
+}
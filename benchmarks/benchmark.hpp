@@ -0,0 +1,126 @@
+#ifndef EZG_BENCHMARK_HPP
+#define EZG_BENCHMARK_HPP
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ezg::bench {
+/// @brief Timing state handed to a benchmark function, mirrors the part of Google Benchmark's
+/// State the suite uses so the functions can be moved over unchanged.
+///
+///   static void BM_Foo(State& state) {
+///     for (auto _ : state) { ... }
+///   }
+///   EZG_BENCHMARK(BM_Foo)->Arg(64)->Arg(4096);
+class State {
+public:
+  // empty value type so `for (auto _ : state)` doesn't trip unused variable warnings
+  struct [[maybe_unused]] Value {};
+
+  struct Iterator {
+    State* state;
+    int64_t remaining;
+
+    bool operator!=(const Iterator&) {
+      if (remaining > 0) {
+        return true;
+      }
+      state->Stop();
+      return false;
+    }
+    Iterator& operator++() {
+      --remaining;
+      return *this;
+    }
+    Value operator*() const { return {}; }
+  };
+
+  State(std::vector<int64_t> args, int64_t iterations)
+      : m_args(std::move(args)), m_iterations(iterations) {}
+
+  Iterator begin() {
+    Start();
+    return {this, m_iterations};
+  }
+  Iterator end() { return {this, 0}; }
+
+  [[nodiscard]] int64_t range(size_t index = 0) const { return m_args.at(index); }
+  [[nodiscard]] int64_t iterations() const { return m_iterations; }
+
+  /// @brief Exclude per iteration setup (fresh containers, resets) from the measurement.
+  void PauseTiming();
+  void ResumeTiming();
+
+  void SetItemsProcessed(int64_t items) { m_items = items; }
+  void SetBytesProcessed(int64_t bytes) { m_bytes = bytes; }
+  void SetLabel(std::string label) { m_label = std::move(label); }
+
+  [[nodiscard]] double GetElapsedNs() const { return m_elapsed_ns; }
+  [[nodiscard]] int64_t GetItemsProcessed() const { return m_items; }
+  [[nodiscard]] int64_t GetBytesProcessed() const { return m_bytes; }
+  [[nodiscard]] const std::string& GetLabel() const { return m_label; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void Start();
+  void Stop();
+
+  std::vector<int64_t> m_args;
+  int64_t m_iterations;
+  Clock::time_point m_start{};
+  double m_elapsed_ns{0.0};
+  bool m_running{false};
+  int64_t m_items{0};
+  int64_t m_bytes{0};
+  std::string m_label;
+};
+
+using BenchmarkFunc = void (*)(State&);
+
+class Benchmark {
+public:
+  Benchmark(std::string name, BenchmarkFunc func) : m_name(std::move(name)), m_func(func) {}
+
+  /// @brief Run once per added argument, read back with state.range(0).
+  Benchmark* Arg(int64_t arg);
+  /// @brief Run once per added argument list, read back with state.range(i).
+  Benchmark* Args(std::vector<int64_t> args);
+
+  [[nodiscard]] const std::string& GetName() const { return m_name; }
+  [[nodiscard]] BenchmarkFunc GetFunc() const { return m_func; }
+  [[nodiscard]] const std::vector<std::vector<int64_t>>& GetArgs() const { return m_args; }
+
+private:
+  std::string m_name;
+  BenchmarkFunc m_func;
+  std::vector<std::vector<int64_t>> m_args;
+};
+
+Benchmark* RegisterBenchmark(const char* name, BenchmarkFunc func);
+
+/// @brief Run every registered benchmark whose name contains the --filter argument.
+int RunBenchmarks(int argc, char* argv[]);
+
+void UseCharPointer(const volatile char* ptr);
+
+/// @brief Keep the compiler from discarding a result that is otherwise unused.
+template <class T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  // the call can't be inlined (defined in another translation unit), so value must be computed
+  UseCharPointer(&reinterpret_cast<const volatile char&>(value));
+#endif
+}
+}  // namespace ezg::bench
+
+#define EZG_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define EZG_BENCHMARK_CONCAT(a, b) EZG_BENCHMARK_CONCAT_IMPL(a, b)
+#define EZG_BENCHMARK(func)                                                      \
+  [[maybe_unused]] static ::ezg::bench::Benchmark* EZG_BENCHMARK_CONCAT(         \
+      ezg_benchmark_, __LINE__) = ::ezg::bench::RegisterBenchmark(#func, func)
+
+#endif  //EZG_BENCHMARK_HPP
@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "benchmark.hpp"
+#include "ezg_engine/draw_batches.hpp"
+#include "ezg_engine/material_system.hpp"
+#include "ezg_engine/mesh.hpp"
+#include "ezg_engine/scene_system.hpp"
+
+using namespace ezg::bench;
+using namespace ezg;
+
+// Draw groups and binds of a frame with a texture set per material vs. the bindless set. The
+// groups come from BuildDrawGroups over a SceneSystem, the timings are of that grouping only.
+// Recording the groups into a command buffer needs a Vulkan device and isn't measured here.
+namespace {
+struct BenchScene {
+  std::vector<Mesh> meshes;
+  std::vector<Material> materials;
+  std::unique_ptr<SceneSystem> scene = std::make_unique<SceneSystem>();
+};
+
+// range(0) materials over range(1) pipelines, 16 objects of 4 meshes per material. The scene
+// sorts by material id, materials are created in pipeline order like the engine's
+std::unique_ptr<BenchScene> make_scene(State& state) {
+  const auto num_materials = static_cast<size_t>(state.range(0));
+  const auto num_pipelines = static_cast<size_t>(state.range(1));
+  auto bench               = std::make_unique<BenchScene>();
+  bench->meshes.resize(4);
+  bench->materials.resize(num_materials);
+  for (size_t i = 0; i < num_materials; i++) {
+    // only compared, never used as a real pipeline
+    const auto pipeline          = static_cast<uint64_t>(1 + i * num_pipelines / num_materials);
+    bench->materials[i].pipeline = reinterpret_cast<VkPipeline>(pipeline);
+  }
+  std::vector<SceneObjectInfo> infos(num_materials * 16);
+  for (size_t i = 0; i < infos.size(); i++) {
+    infos[i].mesh     = &bench->meshes[(i / num_materials) % bench->meshes.size()];
+    infos[i].material = &bench->materials[i % num_materials];
+  }
+  bench->scene->AddObjectBatch(infos.data(), static_cast<uint32_t>(infos.size()));
+  return bench;
+}
+
+struct BindCounts {
+  uint32_t setBinds{0};
+  uint32_t pipelineBinds{0};
+};
+
+// the binds RecordDrawGroups makes for the groups in one command buffer. Per material sets
+// rebind the global, object and texture set with every pipeline, the bindless set is bound
+// once up front
+BindCounts count_binds(const std::vector<DrawGroup>& groups, DrawGroupSplit split) {
+  BindCounts counts;
+  counts.setBinds        = split == DrawGroupSplit::Pipeline ? 1 : 0;
+  Material* lastMaterial = nullptr;
+  for (const auto& group : groups) {
+    if (group.material != lastMaterial) {
+      counts.pipelineBinds++;
+      counts.setBinds += split == DrawGroupSplit::Material ? 3 : 0;
+      lastMaterial = group.material;
+    }
+  }
+  return counts;
+}
+
+void run_grouping(State& state, DrawGroupSplit split) {
+  const auto bench = make_scene(state);
+  std::vector<DrawBatch> batches;
+  std::vector<DrawGroup> groups;
+  std::vector<uint32_t> objectBatches;
+  for (auto _ : state) {
+    BuildDrawGroups(*bench->scene, split, batches, groups, objectBatches);
+    DoNotOptimize(groups.data());
+  }
+  const BindCounts counts = count_binds(groups, split);
+  state.SetLabel(std::to_string(groups.size()) + " draws, " + std::to_string(counts.setBinds) +
+                 " descriptor binds, " + std::to_string(counts.pipelineBinds) +
+                 " pipeline binds per frame");
+  state.SetItemsProcessed(state.iterations() * bench->scene->GetDrawOrder().size());
+}
+}  // namespace
+
+// range(0): materials, range(1): pipelines they use. EGEngine before the bindless set, a draw
+// group per material
+static void BM_GroupPerMaterialSets(State& state) {
+  run_grouping(state, DrawGroupSplit::Material);
+}
+EZG_BENCHMARK(BM_GroupPerMaterialSets)->Args({16, 2})->Args({256, 2})->Args({4096, 8});
+
+// range(0): materials, range(1): pipelines they use. Materials sharing a pipeline share a group
+static void BM_GroupBindless(State& state) {
+  run_grouping(state, DrawGroupSplit::Pipeline);
+}
+EZG_BENCHMARK(BM_GroupBindless)->Args({16, 2})->Args({256, 2})->Args({4096, 8});
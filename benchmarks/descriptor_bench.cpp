@@ -0,0 +1,75 @@
+#include <unordered_map>
+#include "benchmark.hpp"
+#include "vulkan_helper/vk_descriptors.hpp"
+
+using namespace ezg::bench;
+using LayoutInfo = vkh::DescriptorLayoutCache::DescriptorLayoutInfo;
+
+namespace {
+// same hasher the cache uses internally
+struct LayoutHash {
+  size_t operator()(const LayoutInfo& info) const { return info.hash(); }
+};
+
+LayoutInfo make_layout(uint32_t num_bindings, uint32_t variant) {
+  static constexpr VkDescriptorType Types[] = {
+      VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+  LayoutInfo info;
+  for (uint32_t i = 0; i < num_bindings; i++) {
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding         = i;
+    binding.descriptorType  = Types[(i + variant) % 4];
+    binding.descriptorCount = 1 + (variant / 4) % 4;
+    binding.stageFlags      = (variant / 16) % 2 == 0
+                                  ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
+                                  : VK_SHADER_STAGE_FRAGMENT_BIT;
+    info.bindings.push_back(binding);
+  }
+  return info;
+}
+}  // namespace
+
+// range(0): bindings per layout
+static void BM_DescriptorLayoutHash(State& state) {
+  const auto info = make_layout(static_cast<uint32_t>(state.range(0)), 0);
+  for (auto _ : state) {
+    DoNotOptimize(info.hash());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+EZG_BENCHMARK(BM_DescriptorLayoutHash)->Arg(1)->Arg(4)->Arg(16);
+
+static void BM_DescriptorLayoutEqual(State& state) {
+  const auto a = make_layout(static_cast<uint32_t>(state.range(0)), 0);
+  const auto b = make_layout(static_cast<uint32_t>(state.range(0)), 0);
+  for (auto _ : state) {
+    DoNotOptimize(a == b);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+EZG_BENCHMARK(BM_DescriptorLayoutEqual)->Arg(1)->Arg(4)->Arg(16);
+
+// cache hit path of CreateDescriptorSetLayout, range(0): bindings per layout, range(1): layouts
+// in the cache. The label reports how many distinct hashes the cached layouts produced.
+static void BM_DescriptorLayoutCacheLookup(State& state) {
+  const auto num_bindings = static_cast<uint32_t>(state.range(0));
+  const auto num_layouts  = static_cast<uint32_t>(state.range(1));
+  std::unordered_map<LayoutInfo, uint32_t, LayoutHash> cache;
+  std::vector<LayoutInfo> queries;
+  std::unordered_map<size_t, uint32_t> hashes;
+  for (uint32_t i = 0; i < num_layouts; i++) {
+    auto info = make_layout(num_bindings, i);
+    hashes[info.hash()]++;
+    cache.try_emplace(info, i);
+    queries.push_back(std::move(info));
+  }
+  size_t next = 0;
+  for (auto _ : state) {
+    DoNotOptimize(cache.find(queries[next]));
+    next = next + 1 == queries.size() ? 0 : next + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(std::to_string(hashes.size()) + " distinct hashes");
+}
+EZG_BENCHMARK(BM_DescriptorLayoutCacheLookup)->Args({4, 8})->Args({4, 32})->Args({16, 32});
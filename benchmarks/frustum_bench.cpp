@@ -0,0 +1,32 @@
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "benchmark.hpp"
+#include "renderer/frustum.hpp"
+
+using namespace ezg::bench;
+using namespace ezg::gl;
+
+// range(0): number of unit boxes on a line across the frustum, most fail at the side planes
+static void BM_FrustumCull(State& state) {
+  const auto count = state.range(0);
+  std::vector<glm::mat4> matrices;
+  matrices.reserve(count);
+  for (int64_t i = 0; i < count; i++) {
+    const auto f = static_cast<float>(i) / static_cast<float>(count);
+    const auto x = 200.0f * f - 100.0f;
+    matrices.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, -5.0f)));
+  }
+  const AABB bounds(glm::vec3(-0.5f), glm::vec3(0.5f));
+  const auto projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+  const Frustum frustum(projection * glm::lookAt(glm::vec3(0.0f, 0.0f, 5.0f), glm::vec3(0.0f),
+                                                 glm::vec3(0.0f, 1.0f, 0.0f)));
+  for (auto _ : state) {
+    int64_t visible = 0;
+    for (const auto& matrix : matrices) {
+      visible += frustum.intersects(bounds, matrix) ? 1 : 0;
+    }
+    DoNotOptimize(visible);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+EZG_BENCHMARK(BM_FrustumCull)->Arg(4096)->Arg(65536)->Arg(1048576);
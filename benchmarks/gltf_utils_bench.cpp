@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "assets/mesh.hpp"
+#include "benchmark.hpp"
+#include "utils/gltf_utils.hpp"
+
+using namespace ezg::bench;
+using namespace ezg::gl;
+
+namespace {
+// grid of quads with POSITION, NORMAL, TEXCOORD_0, TANGENT and uint32 indices in one buffer,
+// laid out the way exporters usually write it (one buffer view per attribute)
+tinygltf::Model make_grid_model(uint32_t num_vertices, int num_nodes = 1) {
+  const auto side =
+      std::max(2u, static_cast<uint32_t>(std::sqrt(static_cast<float>(num_vertices))));
+  const uint32_t vertex_count = side * side;
+
+  std::vector<glm::vec3> positions(vertex_count);
+  std::vector<glm::vec3> normals(vertex_count, glm::vec3(0.0f, 1.0f, 0.0f));
+  std::vector<glm::vec2> uvs(vertex_count);
+  std::vector<glm::vec4> tangents(vertex_count, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+  for (uint32_t z = 0; z < side; z++) {
+    for (uint32_t x = 0; x < side; x++) {
+      const auto u            = static_cast<float>(x) / static_cast<float>(side - 1);
+      const auto v            = static_cast<float>(z) / static_cast<float>(side - 1);
+      positions[z * side + x] = glm::vec3(u - 0.5f, 0.1f * std::sin(u * 6.28f), v - 0.5f);
+      uvs[z * side + x]       = glm::vec2(u, v);
+    }
+  }
+  std::vector<uint32_t> indices;
+  indices.reserve((side - 1) * (side - 1) * 6);
+  for (uint32_t z = 0; z + 1 < side; z++) {
+    for (uint32_t x = 0; x + 1 < side; x++) {
+      const uint32_t i = z * side + x;
+      indices.insert(indices.end(), {i, i + side, i + 1, i + 1, i + side, i + side + 1});
+    }
+  }
+
+  tinygltf::Model model;
+  auto& buffer        = model.buffers.emplace_back();
+  const auto add_view = [&](const void* data, size_t bytes, int component_type, int type,
+                            size_t count) {
+    const auto offset = buffer.data.size();
+    buffer.data.resize(offset + bytes);
+    std::memcpy(buffer.data.data() + offset, data, bytes);
+
+    auto& view      = model.bufferViews.emplace_back();
+    view.buffer     = 0;
+    view.byteOffset = offset;
+    view.byteLength = bytes;
+
+    auto& accessor         = model.accessors.emplace_back();
+    accessor.bufferView    = static_cast<int>(model.bufferViews.size() - 1);
+    accessor.componentType = component_type;
+    accessor.type          = type;
+    accessor.count         = count;
+    return static_cast<int>(model.accessors.size() - 1);
+  };
+
+  tinygltf::Primitive primitive;
+  primitive.attributes["POSITION"] =
+      add_view(positions.data(), positions.size() * sizeof(glm::vec3),
+               TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, positions.size());
+  primitive.attributes["NORMAL"] =
+      add_view(normals.data(), normals.size() * sizeof(glm::vec3), TINYGLTF_COMPONENT_TYPE_FLOAT,
+               TINYGLTF_TYPE_VEC3, normals.size());
+  primitive.attributes["TEXCOORD_0"] =
+      add_view(uvs.data(), uvs.size() * sizeof(glm::vec2), TINYGLTF_COMPONENT_TYPE_FLOAT,
+               TINYGLTF_TYPE_VEC2, uvs.size());
+  primitive.attributes["TANGENT"] =
+      add_view(tangents.data(), tangents.size() * sizeof(glm::vec4),
+               TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC4, tangents.size());
+  primitive.indices = add_view(indices.data(), indices.size() * sizeof(uint32_t),
+                               TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, TINYGLTF_TYPE_SCALAR,
+                               indices.size());
+  model.meshes.emplace_back().primitives.push_back(primitive);
+
+  // a chain of nodes instancing the mesh, each with its own TRS
+  auto& scene = model.scenes.emplace_back();
+  for (int i = 0; i < num_nodes; i++) {
+    auto& node       = model.nodes.emplace_back();
+    node.mesh        = 0;
+    node.translation = {static_cast<double>(i), 0.0, 0.0};
+    node.rotation    = {0.0, 0.3826834, 0.0, 0.9238795};
+    node.scale       = {1.5, 1.5, 1.5};
+    if (i == 0) {
+      scene.nodes.push_back(0);
+    } else {
+      model.nodes[i - 1].children.push_back(i);
+    }
+  }
+  model.defaultScene = 0;
+  return model;
+}
+
+tinygltf::Primitive& get_primitive(tinygltf::Model& model) {
+  return model.meshes[0].primitives[0];
+}
+}  // namespace
+
+static void BM_ExtractGltfVertices(State& state) {
+  auto model          = make_grid_model(static_cast<uint32_t>(state.range(0)));
+  size_t num_vertices = 0;
+  for (auto _ : state) {
+    std::vector<Vertex> vertices;
+    extract_gltf_vertices(get_primitive(model), model, vertices);
+    num_vertices = vertices.size();
+    DoNotOptimize(vertices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_vertices));
+}
+EZG_BENCHMARK(BM_ExtractGltfVertices)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 18);
+
+static void BM_ExtractGltfIndices(State& state) {
+  auto model         = make_grid_model(static_cast<uint32_t>(state.range(0)));
+  size_t num_indices = 0;
+  for (auto _ : state) {
+    std::vector<uint32_t> indices;
+    extract_gltf_indices(get_primitive(model), model, indices);
+    num_indices = indices.size();
+    DoNotOptimize(indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_indices));
+}
+EZG_BENCHMARK(BM_ExtractGltfIndices)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 18);
+
+// range(0): vertices per mesh, range(1): nodes in the hierarchy
+static void BM_ComputeSceneBounds(State& state) {
+  const auto model = make_grid_model(static_cast<uint32_t>(state.range(0)),
+                                     static_cast<int>(state.range(1)));
+  glm::vec3 bbox_min{}, bbox_max{};
+  for (auto _ : state) {
+    computeSceneBounds(model, bbox_min, bbox_max);
+    DoNotOptimize(bbox_min);
+    DoNotOptimize(bbox_max);
+  }
+  // every index is visited once per node
+  const auto num_indices = model.accessors[model.meshes[0].primitives[0].indices].count;
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_indices) * state.range(1));
+}
+EZG_BENCHMARK(BM_ComputeSceneBounds)
+    ->Args({1 << 10, 1})
+    ->Args({1 << 14, 1})
+    ->Args({1 << 18, 1})
+    ->Args({1 << 10, 64});
@@ -0,0 +1,103 @@
+#include <atomic>
+#include <thread>
+#include "benchmark.hpp"
+#include "systems/input_system.hpp"
+
+using namespace ezg::bench;
+using namespace ezg::system;
+
+// the camera polls a handful of keys every frame, range(0) is the number of queries
+static void BM_InputIsKeyPressed(State& state) {
+  auto& input = KeyboardMouseInput::GetInstance();
+  input.press_key(GLFW_KEY_W);
+  input.update_snapshot();
+  const int64_t num_queries = state.range(0);
+  for (auto _ : state) {
+    int pressed = 0;
+    for (int64_t i = 0; i < num_queries; i++) {
+      pressed += input.is_key_pressed(GLFW_KEY_SPACE + static_cast<int32_t>(i % 64));
+    }
+    DoNotOptimize(pressed);
+  }
+  input.release_key(GLFW_KEY_W);
+  input.update_snapshot();
+  state.SetItemsProcessed(state.iterations() * num_queries);
+}
+EZG_BENCHMARK(BM_InputIsKeyPressed)->Arg(1)->Arg(16)->Arg(256);
+
+// one press per frame: queue the event, fold it into the snapshot, query the edge
+static void BM_InputWasKeyPressedOnce(State& state) {
+  auto& input = KeyboardMouseInput::GetInstance();
+  for (auto _ : state) {
+    input.press_key(GLFW_KEY_F1);
+    input.release_key(GLFW_KEY_F1);
+    input.update_snapshot();
+    DoNotOptimize(input.was_key_pressed_once(GLFW_KEY_F1));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+EZG_BENCHMARK(BM_InputWasKeyPressedOnce);
+
+static void BM_InputCursorDelta(State& state) {
+  auto& input = KeyboardMouseInput::GetInstance();
+  double x    = 0.0;
+  for (auto _ : state) {
+    x += 1.0;
+    input.set_cursor_pos(x, -x);
+    input.update_snapshot();
+    DoNotOptimize(input.calculate_cursor_position_delta());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+EZG_BENCHMARK(BM_InputCursorDelta);
+
+// range(0): events queued per frame, the cost of draining them into a snapshot
+static void BM_InputSnapshotUpdate(State& state) {
+  auto& input       = KeyboardMouseInput::GetInstance();
+  const auto events = static_cast<int32_t>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int32_t i = 0; i < events; i++) {
+      if (i % 2 == 0) {
+        input.set_cursor_pos(i, i);
+      } else {
+        input.press_key(GLFW_KEY_A + i % 26);
+      }
+    }
+    state.ResumeTiming();
+    input.update_snapshot();
+    DoNotOptimize(input.get_snapshot().keys_down);
+  }
+  state.SetItemsProcessed(state.iterations() * events);
+}
+EZG_BENCHMARK(BM_InputSnapshotUpdate)->Arg(1)->Arg(64)->Arg(1024);
+
+// queries while another thread keeps feeding key events, as the GLFW callbacks do when the
+// game logic polls from a different thread. Queries only read the snapshot, so the writer
+// never slows them down (it just fills the queue and drops events)
+static void BM_InputIsKeyPressedContended(State& state) {
+  auto& input = KeyboardMouseInput::GetInstance();
+  std::atomic<bool> stop{false};
+  std::thread writer([&] {
+    int32_t key = GLFW_KEY_A;
+    while (!stop.load(std::memory_order_relaxed)) {
+      input.press_key(key);
+      input.release_key(key);
+      key = key == GLFW_KEY_Z ? GLFW_KEY_A : key + 1;
+    }
+  });
+  const int64_t num_queries = state.range(0);
+  for (auto _ : state) {
+    int pressed = 0;
+    for (int64_t i = 0; i < num_queries; i++) {
+      pressed += input.is_key_pressed(GLFW_KEY_A + static_cast<int32_t>(i % 26));
+    }
+    DoNotOptimize(pressed);
+  }
+  stop = true;
+  writer.join();
+  // leave an empty queue for the other benchmarks
+  input.update_snapshot();
+  state.SetItemsProcessed(state.iterations() * num_queries);
+}
+EZG_BENCHMARK(BM_InputIsKeyPressedContended)->Arg(16)->Arg(256);
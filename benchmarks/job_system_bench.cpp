@@ -0,0 +1,94 @@
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include "benchmark.hpp"
+#include "ezg_util/job_system.hpp"
+
+using namespace ezg::bench;
+using namespace ezg::util;
+
+// range(0): empty jobs submitted from a non-worker thread, the scheduling overhead per job
+static void BM_JobSubmitThroughput(State& state) {
+  auto& jobs = JobSystem::Get();
+  for (auto _ : state) {
+    JobCounter counter(static_cast<uint32_t>(state.range(0)));
+    for (int64_t i = 0; i < state.range(0); i++) {
+      jobs.Submit([&counter] { counter.Decrement(); });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_JobSubmitThroughput)->Arg(1024)->Arg(65536);
+
+// range(0): jobs pushed into one worker's deque, every other worker has to steal them
+static void BM_JobStealContention(State& state) {
+  auto& jobs = JobSystem::Get();
+  for (auto _ : state) {
+    JobCounter counter(static_cast<uint32_t>(state.range(0)) + 1);
+    jobs.Submit([&jobs, &counter, count = state.range(0)] {
+      for (int64_t i = 0; i < count; i++) {
+        jobs.Submit([&counter] { counter.Decrement(); });
+      }
+      counter.Decrement();
+    });
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_JobStealContention)->Arg(1024)->Arg(65536);
+
+// range(0): decrements of one shared counter spread over all threads
+static void BM_JobCounterContention(State& state) {
+  const auto count      = static_cast<size_t>(state.range(0));
+  const auto num_chunks = static_cast<size_t>(JobSystem::Get().GetNumWorkers()) + 1;
+  for (auto _ : state) {
+    JobCounter shared(static_cast<uint32_t>(count));
+    const auto grain = (count + num_chunks - 1) / num_chunks;
+    ParallelFor(0, count, grain, [&shared](size_t begin, size_t end) {
+      for (auto i = begin; i < end; i++) {
+        shared.Decrement();
+      }
+    });
+    DoNotOptimize(shared.IsDone());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_JobCounterContention)->Arg(65536);
+
+static Task<void> AddOne(std::atomic<int64_t>& sum) {
+  co_await JobSystem::Get().Schedule();
+  sum.fetch_add(1, std::memory_order_relaxed);
+}
+
+// range(0): spawned coroutines hopping onto a worker, the cost of a task frame and resume
+static void BM_CoroutineSpawn(State& state) {
+  auto& jobs = JobSystem::Get();
+  std::atomic<int64_t> sum{0};
+  for (auto _ : state) {
+    JobCounter counter;
+    for (int64_t i = 0; i < state.range(0); i++) {
+      jobs.Spawn(AddOne(sum), &counter);
+    }
+    counter.Wait();
+  }
+  DoNotOptimize(sum.load());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_CoroutineSpawn)->Arg(1024)->Arg(65536);
+
+// range(0): elements, range(1): grain, a light per element workload like transform updates
+static void BM_ParallelFor(State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  std::vector<float> values(count, 1.0f);
+  for (auto _ : state) {
+    ParallelFor(0, count, static_cast<size_t>(state.range(1)), [&values](size_t begin, size_t end) {
+      for (auto i = begin; i < end; i++) {
+        values[i] = std::sqrt(values[i] + 1.0f);
+      }
+    });
+    DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_ParallelFor)->Args({65536, 1024})->Args({1048576, 1024})->Args({1048576, 65536});
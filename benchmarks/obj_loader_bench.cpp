@@ -0,0 +1,105 @@
+#include <tiny_obj_loader.h>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include "benchmark.hpp"
+#include "ezg_util/obj_loader.hpp"
+
+using namespace ezg::bench;
+using namespace ezg::util;
+
+namespace {
+// side x side grid of quads with positions, uvs and normals, written once per size to the temp
+// directory, the way exporters write it (%.6f components, v/vt/vn indices)
+const std::string& get_grid_obj(int64_t side) {
+  static std::map<int64_t, std::string> paths;
+  auto& path = paths[side];
+  if (!path.empty()) {
+    return path;
+  }
+  path = (std::filesystem::temp_directory_path() / ("ezg_bench_grid_" + std::to_string(side) +
+                                                    ".obj"))
+             .string();
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  char line[128];
+  for (int64_t z = 0; z < side; z++) {
+    for (int64_t x = 0; x < side; x++) {
+      const auto u = static_cast<double>(x) / static_cast<double>(side - 1);
+      const auto v = static_cast<double>(z) / static_cast<double>(side - 1);
+      snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+               u - 0.5, 0.1 * std::sin(u * 6.28), v - 0.5, u, v, 0.0, 1.0, 0.0);
+      out << line;
+    }
+  }
+  for (int64_t z = 0; z + 1 < side; z++) {
+    for (int64_t x = 0; x + 1 < side; x++) {
+      const int64_t i = z * side + x + 1;
+      // every attribute shares the vertex index
+      out << 'f';
+      for (const int64_t corner : {i, i + side, i + side + 1, i + 1}) {
+        out << ' ' << corner << '/' << corner << '/' << corner;
+      }
+      out << '\n';
+    }
+  }
+  return path;
+}
+}  // namespace
+
+// range(0): grid side, tinyobjloader followed by the one vertex per face corner expansion the
+// engines did before
+static void BM_ObjLoadTinyObj(State& state) {
+  const auto& path   = get_grid_obj(state.range(0));
+  size_t num_indices = 0;
+  for (auto _ : state) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn;
+    std::string err;
+    tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), nullptr);
+    std::vector<ObjVertex> vertices;
+    std::vector<uint32_t> indices;
+    for (const auto& shape : shapes) {
+      for (const auto& idx : shape.mesh.indices) {
+        ObjVertex vertex;
+        vertex.position = {attrib.vertices[3 * idx.vertex_index + 0],
+                           attrib.vertices[3 * idx.vertex_index + 1],
+                           attrib.vertices[3 * idx.vertex_index + 2]};
+        vertex.normal   = {attrib.normals[3 * idx.normal_index + 0],
+                           attrib.normals[3 * idx.normal_index + 1],
+                           attrib.normals[3 * idx.normal_index + 2]};
+        vertex.uv       = {attrib.texcoords[2 * idx.texcoord_index + 0],
+                           attrib.texcoords[2 * idx.texcoord_index + 1]};
+        indices.push_back(static_cast<uint32_t>(vertices.size()));
+        vertices.push_back(vertex);
+      }
+    }
+    num_indices = indices.size();
+    DoNotOptimize(vertices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_indices));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(std::filesystem::file_size(path)));
+}
+EZG_BENCHMARK(BM_ObjLoadTinyObj)->Arg(128)->Arg(1024);
+
+// range(0): grid side, mapped, parsed in parallel chunks and welded
+static void BM_ObjLoadParallel(State& state) {
+  const auto& path   = get_grid_obj(state.range(0));
+  size_t num_indices = 0;
+  for (auto _ : state) {
+    ObjModel model;
+    std::string error;
+    LoadObj(path, model, error);
+    num_indices = model.indices.size();
+    DoNotOptimize(model.vertices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(num_indices));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(std::filesystem::file_size(path)));
+}
+EZG_BENCHMARK(BM_ObjLoadParallel)->Arg(128)->Arg(1024);
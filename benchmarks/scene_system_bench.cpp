@@ -0,0 +1,39 @@
+#include <memory>
+#include <vector>
+#include "benchmark.hpp"
+#include "ezg_engine/material_system.hpp"
+#include "ezg_engine/mesh.hpp"
+#include "ezg_engine/scene_system.hpp"
+
+using namespace ezg::bench;
+using namespace ezg;
+
+// range(0): objects per batch, range(1): distinct meshes (and materials) they reference
+static void BM_SceneAddObjectBatch(State& state) {
+  const auto num_objects = static_cast<size_t>(state.range(0));
+  const auto num_unique  = static_cast<size_t>(state.range(1));
+  std::vector<Mesh> meshes(num_unique);
+  std::vector<Material> materials(num_unique);
+  std::vector<SceneObjectInfo> infos(num_objects);
+  for (size_t i = 0; i < num_objects; i++) {
+    infos[i].mesh            = &meshes[(i * 7) % num_unique];
+    infos[i].material        = &materials[(i * 3) % num_unique];
+    infos[i].transformMatrix = glm::mat4(static_cast<float>(i));
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto scene = std::make_unique<SceneSystem>();
+    state.ResumeTiming();
+    scene->AddObjectBatch(infos.data(), static_cast<uint32_t>(infos.size()));
+    DoNotOptimize(scene.get());
+    state.PauseTiming();
+    scene.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_SceneAddObjectBatch)
+    ->Args({256, 4})
+    ->Args({4096, 16})
+    ->Args({65536, 16})
+    ->Args({65536, 4096});
@@ -0,0 +1,99 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "benchmark.hpp"
+#include "graphics/shader.hpp"
+
+using namespace ezg::bench;
+using namespace ezg::gl;
+
+// ShaderProgram only talks to GL through glad's function pointers, pointing them at these stubs
+// lets the uniform lookup run without a context: the program reports num_stub_uniforms active
+// uniforms named "u_uniform_<i>" and every glUniform* call is a no-op.
+namespace {
+int num_stub_uniforms = 0;
+
+void APIENTRY stub_get_programiv(GLuint, GLenum pname, GLint* params) {
+  *params = pname == GL_ACTIVE_UNIFORMS ? num_stub_uniforms : 0;
+}
+
+void APIENTRY stub_get_active_uniform(GLuint, GLuint index, GLsizei buf_size, GLsizei* length,
+                                      GLint* size, GLenum* type, GLchar* name) {
+  *length = std::snprintf(name, buf_size, "u_uniform_%u", index);
+  *size   = 1;
+  *type   = GL_FLOAT;
+}
+
+GLint APIENTRY stub_get_uniform_location(GLuint, const GLchar*) {
+  return -1;
+}
+
+void APIENTRY stub_delete_program(GLuint) {}
+void APIENTRY stub_uniform_1i(GLint, GLint) {}
+void APIENTRY stub_uniform_1f(GLint, GLfloat) {}
+void APIENTRY stub_uniform_3fv(GLint, GLsizei, const GLfloat*) {}
+void APIENTRY stub_uniform_matrix_4fv(GLint, GLsizei, GLboolean, const GLfloat*) {}
+
+ShaderProgram make_stub_program(int num_uniforms) {
+  glad_glGetProgramiv       = stub_get_programiv;
+  glad_glGetActiveUniform   = stub_get_active_uniform;
+  glad_glGetUniformLocation = stub_get_uniform_location;
+  glad_glDeleteProgram      = stub_delete_program;
+  glad_glUniform1i          = stub_uniform_1i;
+  glad_glUniform1f          = stub_uniform_1f;
+  glad_glUniform3fv         = stub_uniform_3fv;
+  glad_glUniformMatrix4fv   = stub_uniform_matrix_4fv;
+  num_stub_uniforms         = num_uniforms;
+  return ShaderProgram("benchmark", 1);
+}
+
+std::vector<std::string> make_names(int64_t count) {
+  std::vector<std::string> names;
+  for (int64_t i = 0; i < count; i++) {
+    names.push_back("u_uniform_" + std::to_string(i));
+  }
+  return names;
+}
+}  // namespace
+
+// range(0): active uniforms in the program, every one of them is set once per iteration
+static void BM_SetUniformFloat(State& state) {
+  auto program     = make_stub_program(static_cast<int>(state.range(0)));
+  const auto names = make_names(state.range(0));
+  for (auto _ : state) {
+    for (const auto& name : names) {
+      program.set_uniform(name, 1.0f);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+EZG_BENCHMARK(BM_SetUniformFloat)->Arg(8)->Arg(64);
+
+// the renderer passes string literals, so every call also builds a temporary std::string
+static void BM_SetUniformLiteral(State& state) {
+  auto program = make_stub_program(static_cast<int>(state.range(0)));
+  const glm::mat4 matrix{1.0f};
+  const glm::vec3 color{1.0f};
+  for (auto _ : state) {
+    program.set_uniform("u_uniform_0", matrix)
+        .set_uniform("u_uniform_1", color)
+        .set_uniform("u_uniform_2", 3)
+        .set_uniform("u_uniform_3", 0.5f);
+  }
+  state.SetItemsProcessed(state.iterations() * 4);
+}
+EZG_BENCHMARK(BM_SetUniformLiteral)->Arg(8)->Arg(64);
+
+// names the program doesn't have: optimized out uniforms and typos, the mat4 overload falls back
+// to glGetUniformLocation
+static void BM_SetUniformMiss(State& state) {
+  auto program                    = make_stub_program(static_cast<int>(state.range(0)));
+  const std::string missing_float = "u_not_a_uniform";
+  const std::string missing_mat4  = "u_not_a_matrix";
+  const glm::mat4 matrix{1.0f};
+  for (auto _ : state) {
+    program.set_uniform(missing_float, 1.0f).set_uniform(missing_mat4, matrix);
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+EZG_BENCHMARK(BM_SetUniformMiss)->Arg(8)->Arg(64);
@@ -0,0 +1,37 @@
+#include "draw_batches.hpp"
+#include "material_system.hpp"
+#include "mesh.hpp"
+#include "scene_system.hpp"
+
+namespace ezg {
+void BuildDrawGroups(const SceneSystem& scene, DrawGroupSplit split,
+                     std::vector<DrawBatch>& batches, std::vector<DrawGroup>& groups,
+                     std::vector<uint32_t>& objectBatches) {
+  // the scene keeps its objects sorted by draw key, runs of equal mesh and material become
+  // instanced batches, runs of equal material or pipeline and index type draw groups
+  const auto& objects   = scene.GetObjects();
+  const auto& drawOrder = scene.GetDrawOrder();
+  batches.clear();
+  groups.clear();
+  // removed objects keep their slot, the cull pass skips them
+  objectBatches.assign(objects.size(), InvalidBatch);
+  for (uint32_t n = 0; n < drawOrder.size(); n++) {
+    const auto& object = objects[drawOrder[n]];
+    Mesh* mesh         = scene.GetMesh(object.meshId);
+    Material* material = scene.GetMaterial(object.materialId);
+    if (batches.empty() || batches.back().mesh != mesh || batches.back().material != material) {
+      const bool newGroup = groups.empty() || groups.back().indexType != mesh->m_indexType ||
+                            (split == DrawGroupSplit::Material
+                                 ? groups.back().material != material
+                                 : groups.back().material->pipeline != material->pipeline);
+      if (newGroup) {
+        groups.push_back({material, mesh->m_indexType, static_cast<uint32_t>(batches.size()), 0});
+      }
+      batches.push_back({mesh, material, n, 0});
+      groups.back().batchCount++;
+    }
+    batches.back().instanceCount++;
+    objectBatches[drawOrder[n]] = static_cast<uint32_t>(batches.size() - 1);
+  }
+}
+}  // namespace ezg
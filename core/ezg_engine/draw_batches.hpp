@@ -0,0 +1,47 @@
+#ifndef DRAW_BATCHES_HPP
+#define DRAW_BATCHES_HPP
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+namespace ezg {
+struct Mesh;
+struct Material;
+class SceneSystem;
+
+// batch of removed objects, matches shaders/cull.comp
+constexpr uint32_t InvalidBatch = UINT32_MAX;
+
+// objects with the same mesh and material, one indirect command
+struct DrawBatch {
+  Mesh* mesh;
+  Material* material;
+  // range of the batch in the visible instance buffer
+  uint32_t firstInstance;
+  uint32_t instanceCount;
+};
+
+// consecutive batches with the same pipeline and index type, drawn by one multi draw
+struct DrawGroup {
+  // material of the first batch, the others share its pipeline
+  Material* material;
+  VkIndexType indexType;
+  uint32_t firstBatch;
+  uint32_t batchCount;
+};
+
+// what ends a draw group besides the index type
+enum class DrawGroupSplit {
+  // every material change, materials that bind their own descriptor sets
+  Material,
+  // every pipeline change, materials read from the bindless set
+  Pipeline
+};
+
+/// @brief Split the scene draw order into instanced batches and draw groups. objectBatches gets
+/// the batch of every scene slot, InvalidBatch for removed objects.
+void BuildDrawGroups(const SceneSystem& scene, DrawGroupSplit split,
+                     std::vector<DrawBatch>& batches, std::vector<DrawGroup>& groups,
+                     std::vector<uint32_t>& objectBatches);
+}  // namespace ezg
+#endif  //DRAW_BATCHES_HPP
@@ -1,7 +1,12 @@
 #include "engine.hpp"
 #include <SDL2/SDL_vulkan.h>
+#include <algorithm>
 #include <fstream>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include "ezg_util/job_system.hpp"
+#include "ezg_util/profiler.hpp"
 #include "texture.hpp"
 #include "vulkan_helper/core.hpp"
 #include "vulkan_helper/vk_init.hpp"
@@ -13,6 +18,12 @@
 #include <glm/gtx/transform.hpp>
 
 namespace ezg {
+// animated stress objects per job, a transform takes well under a microsecond
+constexpr size_t StressUpdateGrain = 4096;
+// frame data the CPU writes, mapped once for the lifetime of the buffer
+constexpr VmaAllocationCreateFlags HostMapped =
+    VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
 void EGEngine::Init() {
   // We initialize SDL and create a window with it.
   SDL_Init(SDL_INIT_VIDEO);
@@ -37,12 +48,18 @@ void EGEngine::Init() {
 
   InitDescriptors();
 
+  // the materials the pipelines create reference the textures
+  LoadImages();
+
   InitPipelines();
 
-  LoadImages();
+  InitCulling();
 
   LoadMeshes();
 
+  // start the copies now, frames skip what isn't uploaded yet
+  m_uploads.Flush();
+
   InitScene();
 
   m_initialized = true;
@@ -59,8 +76,46 @@ void EGEngine::InitVulkan() {
   SDL_Vulkan_CreateSurface(m_window, m_instance, &m_surface);
   // Select physical device
   vkh::PhysicalDeviceSelector pdSelector{vkhInstance};
+  // timeline semaphores track the uploads, they are only core since Vulkan 1.2
+  pdSelector.AddRequiredExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+  // the culled draws take their count from a buffer when available, core since Vulkan 1.2
+  pdSelector.AddOptionalExtension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+  // the bindless texture array, core since Vulkan 1.2, its maintenance3 dependency since 1.1
+  pdSelector.AddRequiredExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+  // every draw group is one multi draw indirect
+  VkPhysicalDeviceFeatures requiredFeatures{};
+  requiredFeatures.multiDrawIndirect = VK_TRUE;
+  pdSelector.SetRequiredFeatures(requiredFeatures);
   vkh::PhysicalDevice vkhPhysicalDevice =
       pdSelector.SetSurface(m_surface).RequirePresent(true).Select();
+  m_supportsDrawIndirectCount =
+      vkhPhysicalDevice.CheckExtensionsSupported({VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME});
+  // the selector only checks for the extension, the features it exposes are each optional
+  VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingFeatures{};
+  descriptorIndexingFeatures.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+  VkPhysicalDeviceFeatures2 supportedFeatures{};
+  supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  supportedFeatures.pNext = &descriptorIndexingFeatures;
+  vkh::VulkanFunction::GetInstance().fp_vkGetPhysicalDeviceFeatures2(
+      vkhPhysicalDevice.physicalDevice, &supportedFeatures);
+  if (!descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing ||
+      !descriptorIndexingFeatures.runtimeDescriptorArray ||
+      !descriptorIndexingFeatures.descriptorBindingPartiallyBound ||
+      !descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+      !descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending) {
+    throw std::runtime_error("Descriptor indexing features for bindless textures not supported!");
+  }
+  // enable only what the bindless set uses
+  descriptorIndexingFeatures = {};
+  descriptorIndexingFeatures.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+  descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing    = VK_TRUE;
+  descriptorIndexingFeatures.runtimeDescriptorArray                       = VK_TRUE;
+  descriptorIndexingFeatures.descriptorBindingPartiallyBound              = VK_TRUE;
+  descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+  descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending    = VK_TRUE;
+
   vkh::DeviceBuilder deviceBuilder{vkhPhysicalDevice};
   VkPhysicalDeviceShaderDrawParametersFeatures shader_draw_parameters_features{};
   shader_draw_parameters_features.sType =
@@ -68,7 +123,15 @@ void EGEngine::InitVulkan() {
   shader_draw_parameters_features.pNext                = nullptr;
   shader_draw_parameters_features.shaderDrawParameters = VK_TRUE;
 
-  vkh::Device vkhDevice = deviceBuilder.addPNext(&shader_draw_parameters_features).Build();
+  VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures{};
+  timelineSemaphoreFeatures.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+  timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+
+  vkh::Device vkhDevice = deviceBuilder.addPNext(&shader_draw_parameters_features)
+                              .addPNext(&timelineSemaphoreFeatures)
+                              .addPNext(&descriptorIndexingFeatures)
+                              .Build();
   m_debugUtil = std::make_unique<vkh::debug::DebugUtil>();
   m_debugUtil->SetDevice(vkhDevice.vkDevice);
   m_device                      = vkhDevice.vkDevice;
@@ -87,6 +150,10 @@ void EGEngine::InitVulkan() {
   m_dispatchTable = vkhDevice.MakeDispatchTable();
   vkh::VulkanFunction::GetInstance().GetDeviceProcAddr(m_device, fp_vkDestroyDevice,
                                                        "vkDestroyDevice");
+  if (m_supportsDrawIndirectCount) {
+    vkh::VulkanFunction::GetInstance().GetDeviceProcAddr(
+        m_device, fp_vkCmdDrawIndexedIndirectCountKHR, "vkCmdDrawIndexedIndirectCountKHR");
+  }
   std::cout << "The GPU has a minimum buffer alignment of "
             << m_gpuProperties.limits.minUniformBufferOffsetAlignment << std::endl;
 }
@@ -263,14 +330,44 @@ void EGEngine::InitCommands() {
       m_dispatchTable.destroyCommandPool(m_frames[i].cmdPool, nullptr);
     });
   }
-  VkCommandPoolCreateInfo uploadCmdPoolInfo =
-      vkh::init::CommandPoolCreateInfo(m_queueFamilyIndices.graphics);
-  vkh::VkCheck(
-      m_dispatchTable.createCommandPool(&uploadCmdPoolInfo, nullptr, &m_uploadContext.cmdPool),
-      "create upload context command pool");
-  m_mainDestructionQueue.PushFunction([=]() {
-    m_dispatchTable.destroyCommandPool(m_uploadContext.cmdPool, nullptr);
-  });
+  // one pool per recording thread and frame, a pool is only ever used by one thread at a time
+  if (m_numRecordThreads > 1) {
+    VkCommandPoolCreateInfo secondaryPoolInfo =
+        vkh::init::CommandPoolCreateInfo(m_queueFamilyIndices.graphics, 0);
+    for (auto& frame : m_frames) {
+      frame.secondaryPools.resize(m_numRecordThreads);
+      frame.secondaryCmdBuffers.resize(m_numRecordThreads);
+      for (uint32_t t = 0; t < m_numRecordThreads; t++) {
+        vkh::VkCheck(m_dispatchTable.createCommandPool(&secondaryPoolInfo, nullptr,
+                                                       &frame.secondaryPools[t]),
+                     "Create secondary command pool");
+        VkCommandBufferAllocateInfo secondaryInfo = vkh::init::CommandBufferAllocateInfo(
+            frame.secondaryPools[t], 1, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+        vkh::VkCheck(
+            m_dispatchTable.allocateCommandBuffers(&secondaryInfo, &frame.secondaryCmdBuffers[t]),
+            "Allocate secondary command buffer");
+      }
+    }
+    m_mainDestructionQueue.PushFunction([=]() {
+      for (auto& frame : m_frames) {
+        for (VkCommandPool pool : frame.secondaryPools) {
+          m_dispatchTable.destroyCommandPool(pool, nullptr);
+        }
+      }
+    });
+  }
+  vkh::Log("Recording draws on " + std::to_string(m_numRecordThreads) + " threads");
+
+  UploadQueues uploadQueues{};
+  uploadQueues.transferFamily = m_queueFamilyIndices.transfer;
+  uploadQueues.transfer       = m_queueFamilies.transfer;
+  uploadQueues.graphicsFamily = m_queueFamilyIndices.graphics;
+  uploadQueues.graphics       = m_queueFamilies.graphics;
+  m_uploads.Init(&m_dispatchTable, m_allocator, uploadQueues);
+  m_mainDestructionQueue.PushFunction([=]() { m_uploads.Cleanup(); });
+
+  m_geometryPool.Init(m_allocator, &m_uploads);
+  m_mainDestructionQueue.PushFunction([=]() { m_geometryPool.Cleanup(); });
 }
 
 void EGEngine::InitSyncStructures() {
@@ -294,13 +391,6 @@ void EGEngine::InitSyncStructures() {
       m_dispatchTable.destroySemaphore(m_frames[i].renderSemaphore, nullptr);
     });
   }
-
-  VkFenceCreateInfo uploadFenceInfo = vkh::init::FenceCreateInfo();
-  vkh::VkCheck(m_dispatchTable.createFence(&uploadFenceInfo, nullptr, &m_uploadContext.uploadFence),
-               "create upload context fence");
-  m_mainDestructionQueue.PushFunction([=]() {
-    m_dispatchTable.destroyFence(m_uploadContext.uploadFence, nullptr);
-  });
 }
 
 void EGEngine::InitDescriptors() {
@@ -313,18 +403,12 @@ void EGEngine::InitDescriptors() {
   const size_t sceneParamBufferSize = FRAME_OVERLAP * PadUniformBufferSize(sizeof(GPUSceneData));
   m_sceneParameterBuffer =
       CreateBuffer(sceneParamBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO,
-                   VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
-
-  VkDescriptorSetLayoutBinding textureBind = vkh::init::DescriptorSetLayoutBinding(
-      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 0);
-  VkDescriptorSetLayoutCreateInfo setInfo{};
-  setInfo.bindingCount = 1;
-  setInfo.flags        = 0;
-  setInfo.pNext        = nullptr;
-  setInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-  setInfo.pBindings    = &textureBind;
+                   HostMapped);
 
-  m_singleTextureSetLayout = m_descriptorLayoutCache->CreateDescriptorSetLayout(&setInfo);
+  m_materialBuffer = CreateBuffer(sizeof(GPUMaterialData) * MaxMaterials,
+                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO,
+                                  HostMapped);
+  m_materialSystem.Init(&m_dispatchTable, m_allocator, m_materialBuffer);
 
   for (int i = 0; i < FRAME_OVERLAP; ++i) {
     m_frames[i].descriptorAllocator = new vkh::DescriptorAllocator();
@@ -332,11 +416,35 @@ void EGEngine::InitDescriptors() {
 
     m_frames[i].cameraBuffer =
         CreateBuffer(sizeof(GPUCameraData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                     VMA_MEMORY_USAGE_AUTO, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+                     VMA_MEMORY_USAGE_AUTO, HostMapped);
 
     m_frames[i].objectBuffer =
-        CreateBuffer(sizeof(GPUObjectData) * MAX_OBJECTS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                     VMA_MEMORY_USAGE_AUTO, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
+        CreateBuffer(sizeof(GPUObjectData) * m_maxObjects, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VMA_MEMORY_USAGE_AUTO, HostMapped);
+
+    // the CPU writes the batches and the command templates, the compacted draws and visible
+    // instances never leave the GPU
+    m_frames[i].cullObjectBuffer =
+        CreateBuffer(sizeof(uint32_t) * m_maxObjects, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VMA_MEMORY_USAGE_AUTO, HostMapped);
+    m_frames[i].drawBatchBuffer =
+        CreateBuffer(sizeof(GPUDrawBatch) * m_maxObjects, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     VMA_MEMORY_USAGE_AUTO, HostMapped);
+    m_frames[i].drawCommandBuffer = CreateBuffer(
+        sizeof(VkDrawIndexedIndirectCommand) * m_maxObjects,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VMA_MEMORY_USAGE_AUTO, HostMapped);
+    m_frames[i].compactDrawBuffer =
+        CreateBuffer(sizeof(VkDrawIndexedIndirectCommand) * m_maxObjects,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                     VMA_MEMORY_USAGE_AUTO, 0);
+    m_frames[i].drawCountBuffer = CreateBuffer(
+        sizeof(uint32_t) * m_maxObjects,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VMA_MEMORY_USAGE_AUTO, HostMapped);
+    m_frames[i].visibleInstanceBuffer = CreateBuffer(
+        sizeof(uint32_t) * m_maxObjects, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO,
+        0);
 
     VkDescriptorBufferInfo cameraBufferInfo = m_frames[i].cameraBuffer.GetDescriptorBufferInfo();
     VkDescriptorBufferInfo sceneBufferInfo  = m_sceneParameterBuffer.GetDescriptorBufferInfo();
@@ -344,6 +452,18 @@ void EGEngine::InitDescriptors() {
     sceneBufferInfo.range = sizeof(GPUSceneData);
 
     VkDescriptorBufferInfo objBufferInfo = m_frames[i].objectBuffer.GetDescriptorBufferInfo();
+    VkDescriptorBufferInfo visibleBufferInfo =
+        m_frames[i].visibleInstanceBuffer.GetDescriptorBufferInfo();
+    VkDescriptorBufferInfo cullObjectBufferInfo =
+        m_frames[i].cullObjectBuffer.GetDescriptorBufferInfo();
+    VkDescriptorBufferInfo batchBufferInfo =
+        m_frames[i].drawBatchBuffer.GetDescriptorBufferInfo();
+    VkDescriptorBufferInfo drawBufferInfo =
+        m_frames[i].drawCommandBuffer.GetDescriptorBufferInfo();
+    VkDescriptorBufferInfo compactDrawBufferInfo =
+        m_frames[i].compactDrawBuffer.GetDescriptorBufferInfo();
+    VkDescriptorBufferInfo drawCountBufferInfo =
+        m_frames[i].drawCountBuffer.GetDescriptorBufferInfo();
 
     vkh::DescriptorBuilder::Begin(m_descriptorLayoutCache, m_frames[i].descriptorAllocator)
         .BindBuffer(0, &cameraBufferInfo, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
@@ -355,22 +475,56 @@ void EGEngine::InitDescriptors() {
     vkh::DescriptorBuilder::Begin(m_descriptorLayoutCache, m_frames[i].descriptorAllocator)
         .BindBuffer(0, &objBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
                     VK_SHADER_STAGE_VERTEX_BIT)
+        .BindBuffer(1, &visibleBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_VERTEX_BIT)
         .Build(m_frames[i].objectDescriptor, m_objectSetLayout);
+
+    // bindings of shaders/cull.comp and shaders/compact_draws.comp
+    vkh::DescriptorBuilder::Begin(m_descriptorLayoutCache, m_frames[i].descriptorAllocator)
+        .BindBuffer(0, &objBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+        .BindBuffer(1, &cullObjectBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+        .BindBuffer(2, &batchBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+        .BindBuffer(3, &drawBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+        .BindBuffer(4, &visibleBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+        .BindBuffer(5, &compactDrawBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+        .BindBuffer(6, &drawCountBufferInfo, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    VK_SHADER_STAGE_COMPUTE_BIT)
+        .Build(m_frames[i].cullDescriptor, m_cullSetLayout);
   }
   m_mainDestructionQueue.PushFunction([&]() {
     vmaDestroyBuffer(m_allocator, m_sceneParameterBuffer.m_buffer,
                      m_sceneParameterBuffer.m_allocation);
+    m_materialSystem.Cleanup();
+    vmaDestroyBuffer(m_allocator, m_materialBuffer.m_buffer, m_materialBuffer.m_allocation);
     for (int i = 0; i < FRAME_OVERLAP; ++i) {
       m_frames[i].descriptorAllocator->Cleanup();
       vmaDestroyBuffer(m_allocator, m_frames[i].cameraBuffer.m_buffer,
                        m_frames[i].cameraBuffer.m_allocation);
-      vmaDestroyBuffer(m_allocator, m_frames[i].objectBuffer.m_buffer,
-                       m_frames[i].objectBuffer.m_allocation);
+      for (auto* buffer : {&m_frames[i].objectBuffer, &m_frames[i].cullObjectBuffer,
+                           &m_frames[i].drawBatchBuffer, &m_frames[i].drawCommandBuffer,
+                           &m_frames[i].compactDrawBuffer, &m_frames[i].drawCountBuffer,
+                           &m_frames[i].visibleInstanceBuffer}) {
+        vmaDestroyBuffer(m_allocator, buffer->m_buffer, buffer->m_allocation);
+      }
     }
   });
 }
 
 void EGEngine::InitPipelines() {
+  EZG_PROFILE_FUNCTION();
+  const auto startTime = std::chrono::high_resolution_clock::now();
+
+  m_pipelineCache.Init(m_device, m_gpuProperties, PIPELINE_CACHE_FILE);
+  m_pipelineRegistry.Init(&m_dispatchTable, &m_pipelineCache);
+  // the registry is destroyed first, it merges its worker caches before the cache is saved
+  m_mainDestructionQueue.PushFunction([=]() { m_pipelineCache.Cleanup(); });
+  m_mainDestructionQueue.PushFunction([=]() { m_pipelineRegistry.Cleanup(); });
 
   VkShaderModule meshVertShader;
   if (!LoadShaderModule("../shaders/spv/tri_mesh_ssbo.vert.spv", &meshVertShader)) {
@@ -402,30 +556,18 @@ void EGEngine::InitPipelines() {
   meshPipelineLayoutInfo.pPushConstantRanges    = &pushConstant;
   meshPipelineLayoutInfo.pushConstantRangeCount = 1;
 
-  VkDescriptorSetLayout setLayouts[] = {m_globalSetLayout, m_objectSetLayout};
+  // every material is drawn with the bindless set, they share the layout and the sets stay
+  // bound across pipeline changes
+  VkDescriptorSetLayout setLayouts[] = {m_globalSetLayout, m_objectSetLayout,
+                                        m_materialSystem.GetBindlessSetLayout()};
 
-  meshPipelineLayoutInfo.setLayoutCount = 2;
+  meshPipelineLayoutInfo.setLayoutCount = 3;
   meshPipelineLayoutInfo.pSetLayouts    = setLayouts;
 
-  VkPipelineLayout meshPipelineLayout;
-  VkPipeline meshPipeline;
   vkh::VkCheck(
-      m_dispatchTable.createPipelineLayout(&meshPipelineLayoutInfo, nullptr, &meshPipelineLayout),
+      m_dispatchTable.createPipelineLayout(&meshPipelineLayoutInfo, nullptr, &m_meshPipelineLayout),
       "create mesh pipeline layout");
 
-  VkPipelineLayoutCreateInfo texturedPipelineLayoutInfo = meshPipelineLayoutInfo;
-
-  VkDescriptorSetLayout texturedSetLayouts[] = {m_globalSetLayout, m_objectSetLayout,
-                                                m_singleTextureSetLayout};
-
-  texturedPipelineLayoutInfo.setLayoutCount = 3;
-  texturedPipelineLayoutInfo.pSetLayouts    = texturedSetLayouts;
-
-  VkPipelineLayout texturedPipeLayout;
-  vkh::VkCheck(m_dispatchTable.createPipelineLayout(&texturedPipelineLayoutInfo, nullptr,
-                                                    &texturedPipeLayout),
-               "create texture pipeline layout");
-
   vkh::PipelineBuilder pipelineBuilder{m_dispatchTable.fp_vkCreateGraphicsPipelines};
   // read vertex data from vertex buffers
   pipelineBuilder.m_vertexInputInfo = vkh::init::VertexInputStateCreateInfo();
@@ -451,7 +593,7 @@ void EGEngine::InitPipelines() {
 
   pipelineBuilder.m_colorBlendAttachment = vkh::init::ColorBlendAttachmentState();
 
-  pipelineBuilder.m_pipelineLayout = meshPipelineLayout;
+  pipelineBuilder.m_pipelineLayout = m_meshPipelineLayout;
 
   VertexInputDescription vertexInputDescription = Vertex::GetVertexDescription();
   pipelineBuilder.m_vertexInputInfo.pVertexAttributeDescriptions =
@@ -469,7 +611,7 @@ void EGEngine::InitPipelines() {
   pipelineBuilder.m_shaderStages.push_back(
       vkh::init::PipelineShaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT, colorFragShader));
 
-  meshPipeline = pipelineBuilder.Build(m_device, m_renderPass);
+  PipelineHandle meshPipeline = m_pipelineRegistry.Request(pipelineBuilder, m_renderPass);
 
   pipelineBuilder.m_shaderStages.clear();
   pipelineBuilder.m_shaderStages.push_back(
@@ -477,25 +619,105 @@ void EGEngine::InitPipelines() {
 
   pipelineBuilder.m_shaderStages.push_back(
       vkh::init::PipelineShaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT, texturedFragShader));
-  pipelineBuilder.m_pipelineLayout = texturedPipeLayout;
-  VkPipeline texturePipeline       = pipelineBuilder.Build(m_device, m_renderPass);
-  m_materialSystem.CreateMaterial("textured", texturePipeline, texturedPipeLayout);
+  PipelineHandle texturePipeline = m_pipelineRegistry.Request(pipelineBuilder, m_renderPass);
+
+  // both pipelines compile on the workers, the shader modules are needed until they are done
+  m_pipelineRegistry.WaitIdle();
+  const Texture& board = m_loadedTextures["board"];
+  GPUMaterialData texturedData{};
+  texturedData.albedoTexture = board.bindlessIndex;
+  m_materialSystem.CreateMaterial("textured", texturePipeline.Get(), m_meshPipelineLayout,
+                                  texturedData);
+  m_materialSystem.GetMaterial("textured")->uploadTicket = board.uploadTicket;
   // delete shaders
   m_dispatchTable.destroyShaderModule(meshVertShader, nullptr);
   m_dispatchTable.destroyShaderModule(colorFragShader, nullptr);
   m_dispatchTable.destroyShaderModule(texturedFragShader, nullptr);
 
   m_mainDestructionQueue.PushFunction([=]() {
-    m_dispatchTable.destroyPipelineLayout(meshPipelineLayout, nullptr);
-    m_dispatchTable.destroyPipelineLayout(texturedPipeLayout, nullptr);
-    m_dispatchTable.destroyPipeline(meshPipeline, nullptr);
-    m_dispatchTable.destroyPipeline(texturePipeline, nullptr);
+    m_dispatchTable.destroyPipelineLayout(m_meshPipelineLayout, nullptr);
   });
 
-  m_materialSystem.CreateMaterial("default", meshPipeline, meshPipelineLayout);
+  m_materialSystem.CreateMaterial("default", meshPipeline.Get(), m_meshPipelineLayout);
+
+  const auto pipelineTime = std::chrono::duration<float, std::chrono::milliseconds::period>(
+                                std::chrono::high_resolution_clock::now() - startTime)
+                                .count();
+  vkh::Log(std::to_string(m_pipelineRegistry.GetNumPipelines()) + " pipelines created in " +
+           std::to_string(pipelineTime) + " ms (" +
+           (m_pipelineCache.WasLoaded() ? "warm" : "cold") + " pipeline cache)");
+}
+
+void EGEngine::InitCulling() {
+  VkPushConstantRange pushConstant;
+  pushConstant.offset     = 0;
+  pushConstant.size       = sizeof(GPUCullConstants);
+  pushConstant.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+  VkPipelineLayoutCreateInfo cullPipelineLayoutInfo = vkh::init::PipelineLayoutCreateInfo();
+  cullPipelineLayoutInfo.pPushConstantRanges        = &pushConstant;
+  cullPipelineLayoutInfo.pushConstantRangeCount     = 1;
+  cullPipelineLayoutInfo.setLayoutCount             = 1;
+  cullPipelineLayoutInfo.pSetLayouts                = &m_cullSetLayout;
+  vkh::VkCheck(
+      m_dispatchTable.createPipelineLayout(&cullPipelineLayoutInfo, nullptr, &m_cullPipelineLayout),
+      "create cull pipeline layout");
+
+  auto createComputePipeline = [&](const char* shaderPath, VkPipeline& pipeline) {
+    VkShaderModule shader;
+    if (!LoadShaderModule(shaderPath, &shader)) {
+      vkh::Log(std::string("Error when building compute shader module ") + shaderPath);
+      return;
+    }
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage  = vkh::init::PipelineShaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT,
+                                                                   shader);
+    pipelineInfo.layout = m_cullPipelineLayout;
+    vkh::VkCheck(m_dispatchTable.createComputePipelines(m_pipelineCache.Get(), 1, &pipelineInfo,
+                                                        nullptr, &pipeline),
+                 "create compute pipeline");
+    m_dispatchTable.destroyShaderModule(shader, nullptr);
+  };
+  createComputePipeline("../shaders/spv/cull.comp.spv", m_cullPipeline);
+  createComputePipeline("../shaders/spv/compact_draws.comp.spv", m_compactPipeline);
+
+  // cull start, cull end and draw end of every frame, read back once its fence is signaled
+  if (m_gpuProperties.limits.timestampComputeAndGraphics) {
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 3;
+    for (auto& frame : m_frames) {
+      vkh::VkCheck(m_dispatchTable.createQueryPool(&queryPoolInfo, nullptr, &frame.timestampPool),
+                   "create timestamp query pool");
+    }
+  }
+
+  m_mainDestructionQueue.PushFunction([=]() {
+    for (auto& frame : m_frames) {
+      if (frame.timestampPool != VK_NULL_HANDLE) {
+        m_dispatchTable.destroyQueryPool(frame.timestampPool, nullptr);
+      }
+    }
+    m_dispatchTable.destroyPipeline(m_cullPipeline, nullptr);
+    m_dispatchTable.destroyPipeline(m_compactPipeline, nullptr);
+    m_dispatchTable.destroyPipelineLayout(m_cullPipelineLayout, nullptr);
+  });
+  vkh::Log(std::string("GPU culling enabled, draw counts ") +
+           (m_supportsDrawIndirectCount ? "from the GPU (VK_KHR_draw_indirect_count)"
+                                        : "fixed, culled batches draw zero instances"));
 }
 
 void EGEngine::InitScene() {
+  if (m_stressScene) {
+    AddStressObjects();
+  } else {
+    AddDefaultObjects();
+  }
+}
+
+void EGEngine::AddDefaultObjects() {
   glm::mat4 vaseMat = glm::scale(glm::mat4{1.0f}, {3.f, 3.f, 3.f});
   vaseMat           = glm::translate(vaseMat, {-0.5f, 0, 0});
   std::vector<SceneObjectInfo> sceneObjInfos;
@@ -525,23 +747,46 @@ void EGEngine::InitScene() {
     }
   }
   m_sceneSystem.AddObjectBatch(sceneObjInfos.data(), sceneObjInfos.size());
+}
 
-  Material* texturedMat = m_materialSystem.GetMaterial("textured");
+void EGEngine::AddStressObjects() {
+  // the generated mesh / material indices pick from what the engine has loaded
+  const std::vector<Mesh*> meshes{&m_meshes["tri"], &m_meshes["smoothVase"],
+                                  &m_meshes["flatVase"]};
+  const std::vector<Material*> materials{m_materialSystem.GetMaterial("default"),
+                                         m_materialSystem.GetMaterial("textured")};
+  const auto& instances = m_stressScene->GetInstances();
+  std::vector<SceneObjectInfo> sceneObjInfos(instances.size());
+  for (uint32_t i = 0; i < instances.size(); i++) {
+    sceneObjInfos[i].mesh            = meshes[instances[i].mesh % meshes.size()];
+    sceneObjInfos[i].material        = materials[instances[i].material % materials.size()];
+    sceneObjInfos[i].transformMatrix = m_stressScene->ComputeTransform(i, 0.0f);
+  }
+  m_sceneSystem.AddObjectBatch(sceneObjInfos.data(), sceneObjInfos.size());
+  vkh::Log("Generated stress scene: " + std::to_string(instances.size()) + " objects, " +
+           std::to_string(m_stressScene->GetAnimated().size()) + " animated");
+}
 
-  VkSamplerCreateInfo sampleInfo = vkh::init::SamplerCreateInfo(VK_FILTER_NEAREST);
-  VkSampler basicSampler;
-  m_dispatchTable.createSampler(&sampleInfo, nullptr, &basicSampler);
-  m_mainDestructionQueue.PushFunction([=]() {
-    m_dispatchTable.destroySampler(basicSampler, nullptr);
+void EGEngine::UpdateStressScene(float frameTime) {
+  EZG_PROFILE_FUNCTION();
+  m_stressTime += frameTime;
+  // stress objects were added first, their scene object ids match the generator indices
+  const auto& animated = m_stressScene->GetAnimated();
+  util::ParallelFor(0, animated.size(), StressUpdateGrain, [&](size_t begin, size_t end) {
+    for (auto i = begin; i < end; i++) {
+      m_sceneSystem.SetTransform(animated[i],
+                                 m_stressScene->ComputeTransform(animated[i], m_stressTime));
+    }
   });
-  VkDescriptorImageInfo imageBufferInfo;
-  imageBufferInfo.sampler     = basicSampler;
-  imageBufferInfo.imageView   = m_loadedTextures["board"].imageView;
-  imageBufferInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  vkh::DescriptorBuilder::Begin(m_descriptorLayoutCache, m_descriptorAllocator)
-      .BindImage(0, &imageBufferInfo, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                 VK_SHADER_STAGE_FRAGMENT_BIT)
-      .Build(texturedMat->textureSet, m_singleTextureSetLayout);
+}
+
+void EGEngine::SetRecordThreads(uint32_t numThreads) {
+  m_numRecordThreads = std::max(numThreads, 1u);
+}
+
+void EGEngine::SetStressScene(const util::StressSceneConfig& config) {
+  m_stressScene = std::make_unique<util::StressSceneGenerator>(config);
+  m_maxObjects  = std::max<uint32_t>(MAX_OBJECTS, m_stressScene->GetInstances().size());
 }
 
 bool EGEngine::LoadShaderModule(const char* shaderPath, VkShaderModule* outShaderModule) {
@@ -571,6 +816,7 @@ bool EGEngine::LoadShaderModule(const char* shaderPath, VkShaderModule* outShade
 }
 
 void EGEngine::LoadMeshes() {
+  EZG_PROFILE_FUNCTION();
   Mesh triMesh{};
   //make the array 3 vertices long
   triMesh.m_vertices.resize(3);
@@ -580,10 +826,12 @@ void EGEngine::LoadMeshes() {
   triMesh.m_vertices[1].position = {-1.f, 1.f, 0.0f};
   triMesh.m_vertices[2].position = {0.f, -1.f, 0.0f};
 
-  //vertex colors, all green
-  triMesh.m_vertices[0].color = {0.f, 1.f, 0.0f};  //pure green
-  triMesh.m_vertices[1].color = {0.f, 1.f, 0.0f};  //pure green
-  triMesh.m_vertices[2].color = {0.f, 1.f, 0.0f};  //pure green
+  //the normal is shown as vertex color, all green
+  triMesh.m_vertices[0].normal = {0.f, 1.f, 0.0f};  //pure green
+  triMesh.m_vertices[1].normal = {0.f, 1.f, 0.0f};  //pure green
+  triMesh.m_vertices[2].normal = {0.f, 1.f, 0.0f};  //pure green
+
+  triMesh.m_indices = {0, 1, 2};
 
   Mesh smoothVaseMesh{};
   smoothVaseMesh.LoadFromObj("../assets/smooth_vase.obj");
@@ -602,14 +850,20 @@ void EGEngine::LoadMeshes() {
 
 void EGEngine::LoadImages() {
   Texture board;
-  LoadImageFromFile(*this, "../assets/missing.png", board.image);
+  LoadImageFromFile(*this, "../assets/missing.png", board.image, board.uploadTicket);
 
   VkImageViewCreateInfo imageViewInfo = vkh::init::ImageViewCreateInfo(
       VK_FORMAT_R8G8B8A8_SRGB, board.image.m_image, VK_IMAGE_ASPECT_COLOR_BIT);
 
   m_dispatchTable.createImageView(&imageViewInfo, nullptr, &board.imageView);
 
+  VkSamplerCreateInfo sampleInfo = vkh::init::SamplerCreateInfo(VK_FILTER_NEAREST);
+  VkSampler basicSampler;
+  m_dispatchTable.createSampler(&sampleInfo, nullptr, &basicSampler);
+  board.bindlessIndex = m_materialSystem.AddTexture(board.imageView, basicSampler);
+
   m_mainDestructionQueue.PushFunction([=]() {
+    m_dispatchTable.destroySampler(basicSampler, nullptr);
     m_dispatchTable.destroyImageView(board.imageView, nullptr);
   });
 
@@ -617,73 +871,26 @@ void EGEngine::LoadImages() {
 }
 
 void EGEngine::UploadMesh(Mesh& mesh) {
-  const size_t bufferSize = mesh.m_vertices.size() * sizeof(Vertex);
-
-  //  VkBufferCreateInfo stagingBufferInfo{};
-  //  stagingBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-  //  stagingBufferInfo.pNext = nullptr;
-  //  stagingBufferInfo.size  = bufferSize;
-  //  stagingBufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-  //
-  //  VmaAllocationCreateInfo vmaAllocationInfo{};
-  //  vmaAllocationInfo.usage = VMA_MEMORY_USAGE_AUTO;
-  //  vmaAllocationInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
-
-  //  AllocatedBuffer stagingBuffer;
-  AllocatedBuffer stagingBuffer =
-      CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_AUTO,
-                   VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT);
-  //  vkh::VkCheck(vmaCreateBuffer(m_allocator, &stagingBufferInfo, &vmaAllocationInfo,
-  //                               &stagingBuffer.m_buffer, &stagingBuffer.m_allocation, nullptr),
-  //               "vma create staging buffer");
-
-  //copy vertex data
-  void* data;
-  vmaMapMemory(m_allocator, stagingBuffer.m_allocation, &data);
-
-  memcpy(data, mesh.m_vertices.data(), bufferSize);
-
-  vmaUnmapMemory(m_allocator, stagingBuffer.m_allocation);
-  //  // allocate vertex buffer
-  //  VkBufferCreateInfo vertexBufferInfo{};
-  //  vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-  //  vertexBufferInfo.pNext = nullptr;
-  //  // size in bytes
-  //  vertexBufferInfo.size  = bufferSize;
-  //  vertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-  //  // let the VMA library know that this data should be gpu native
-  //  vmaAllocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
-
-  // allocate vertex buffer
-  mesh.m_vertexBuffer =
-      CreateBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                   VMA_MEMORY_USAGE_AUTO, VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
-  //  vkh::VkCheck(
-  //      vmaCreateBuffer(m_allocator, &vertexBufferInfo, &vmaAllocationInfo,
-  //                      &mesh.m_vertexBuffer.m_buffer, &mesh.m_vertexBuffer.m_allocation, nullptr),
-  //      "vma create buffer");
-
-  m_mainDestructionQueue.PushFunction([=]() {
-    vmaDestroyBuffer(m_allocator, mesh.m_vertexBuffer.m_buffer, mesh.m_vertexBuffer.m_allocation);
-  });
-
-  ImmediateSubmit([=](VkCommandBuffer cmd) {
-    VkBufferCopy copy;
-    copy.dstOffset = 0;
-    copy.srcOffset = 0;
-    copy.size      = bufferSize;
-    m_dispatchTable.cmdCopyBuffer(cmd, stagingBuffer.m_buffer, mesh.m_vertexBuffer.m_buffer, 1,
-                                  &copy);
-  });
-  vmaDestroyBuffer(m_allocator, stagingBuffer.m_buffer, stagingBuffer.m_allocation);
+  EZG_PROFILE_FUNCTION();
+  mesh.ComputeBounds();
+  // suballocated from the shared buffers, the culled draws of all meshes go through them
+  if (!m_geometryPool.Add(mesh)) {
+    // never complete, the mesh isn't drawn
+    mesh.m_uploadTicket = std::numeric_limits<UploadTicket>::max();
+  }
 }
 
 void EGEngine::Draw() {
+  EZG_PROFILE_FUNCTION();
   if (SDL_GetWindowFlags(m_window) & SDL_WINDOW_MINIMIZED) {
     return;
   }
-  vkh::VkCheck(m_dispatchTable.waitForFences(1, &GetCurrentFrame().renderFence, true, TIME_OUT),
-               "Wait for fences");
+  {
+    EZG_PROFILE_ZONE("Wait For Fences");
+    vkh::VkCheck(m_dispatchTable.waitForFences(1, &GetCurrentFrame().renderFence, true, TIME_OUT),
+                 "Wait for fences");
+  }
+  ReadCullTimings();
   vkh::VkCheck(m_dispatchTable.resetFences(1, &GetCurrentFrame().renderFence), "Reset fences");
   vkh::VkCheck(m_dispatchTable.resetCommandBuffer(GetCurrentFrame().cmdBuffer, 0),
                "Reset command buffer");
@@ -699,6 +906,10 @@ void EGEngine::Draw() {
 
   vkh::VkCheck(m_dispatchTable.beginCommandBuffer(GetCurrentFrame().cmdBuffer, &cmdBeginInfo),
                "begin command buffer");
+  const auto recordStart = std::chrono::high_resolution_clock::now();
+
+  // compute work can't run inside the render pass
+  CullScene();
 
   VkClearValue clearValue;
   clearValue.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
@@ -714,12 +925,17 @@ void EGEngine::Draw() {
   rpInfo.clearValueCount = 2;
   rpInfo.pClearValues    = &clearValues[0];
 
-  m_dispatchTable.cmdBeginRenderPass(GetCurrentFrame().cmdBuffer, &rpInfo,
-                                     VK_SUBPASS_CONTENTS_INLINE);
-
-  RenderScene();
+  RenderScene(rpInfo);
 
-  m_dispatchTable.cmdEndRenderPass(GetCurrentFrame().cmdBuffer);
+  if (GetCurrentFrame().timestampPool != VK_NULL_HANDLE) {
+    m_dispatchTable.cmdWriteTimestamp(GetCurrentFrame().cmdBuffer,
+                                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                      GetCurrentFrame().timestampPool, 2);
+    GetCurrentFrame().timestampsWritten = true;
+  }
+  m_cullTimings.cpuRecordMs += std::chrono::duration<double, std::chrono::milliseconds::period>(
+                                   std::chrono::high_resolution_clock::now() - recordStart)
+                                   .count();
 
   vkh::VkCheck(m_dispatchTable.endCommandBuffer(GetCurrentFrame().cmdBuffer), "end command buffer");
 
@@ -778,7 +994,13 @@ void EGEngine::Run() {
         std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
     currentTime = newTime;
     m_camera.Update(frameTime);
+    if (m_stressScene) {
+      UpdateStressScene(frameTime);
+    }
+    m_uploads.Update();
     Draw();
+    util::JobSystem::Get().RunMainThreadJobs();
+    EZG_PROFILE_FRAME();
   }
 }
 
@@ -836,10 +1058,12 @@ AllocatedBuffer EGEngine::CreateBuffer(size_t bufferSize, VkBufferUsageFlags usa
   vmaAllocInfo.flags = vmaFlags;
 
   AllocatedBuffer buffer{};
+  VmaAllocationInfo allocationInfo{};
   vkh::VkCheck(vmaCreateBuffer(m_allocator, &bufferInfo, &vmaAllocInfo, &buffer.m_buffer,
-                               &buffer.m_allocation, nullptr),
+                               &buffer.m_allocation, &allocationInfo),
                "create buffer using vma");
-  buffer.m_size = bufferSize;
+  buffer.m_size   = bufferSize;
+  buffer.m_mapped = allocationInfo.pMappedData;
 
   return buffer;
 }
@@ -854,29 +1078,4 @@ size_t EGEngine::PadUniformBufferSize(size_t originalSize) {
   return alignedSize;
 }
 
-void EGEngine::ImmediateSubmit(std::function<void(VkCommandBuffer cmdBuffer)>&& function) {
-  VkCommandBuffer cmdBuffer;
-  VkCommandBufferAllocateInfo cmdBufferAllocInfo =
-      vkh::init::CommandBufferAllocateInfo(m_uploadContext.cmdPool, 1);
-  vkh::VkCheck(m_dispatchTable.allocateCommandBuffers(&cmdBufferAllocInfo, &cmdBuffer),
-               "allocate immediate submit cmd buffer");
-
-  VkCommandBufferBeginInfo cmdBeginInfo =
-      vkh::init::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-  vkh::VkCheck(m_dispatchTable.beginCommandBuffer(cmdBuffer, &cmdBeginInfo),
-               "begin one time submit command buffer");
-  function(cmdBuffer);
-  vkh::VkCheck(m_dispatchTable.endCommandBuffer(cmdBuffer), "end one time submit command buffer");
-
-  VkSubmitInfo submitInfo = vkh::init::SubmitInfo(&cmdBuffer);
-  vkh::VkCheck(m_dispatchTable.queueSubmit(m_queueFamilies.graphics, 1, &submitInfo,
-                                           m_uploadContext.uploadFence),
-               "submit command buffer");
-
-  m_dispatchTable.waitForFences(1, &m_uploadContext.uploadFence, true, TIME_OUT);
-  m_dispatchTable.resetFences(1, &m_uploadContext.uploadFence);
-
-  m_dispatchTable.resetCommandPool(m_uploadContext.cmdPool, 0);
-}
-
 }  // namespace ezg
@@ -8,18 +8,31 @@
 #include <memory>
 
 #include "camera.hpp"
+#include "draw_batches.hpp"
+#include "geometry_pool.hpp"
+#include "ezg_util/stress_scene.hpp"
 #include "material_system.hpp"
 #include "mesh.hpp"
+#include "pipeline_registry.hpp"
 #include "scene_system.hpp"
+#include "upload_manager.hpp"
 #include "vulkan_helper/vk_descriptors.hpp"
 #include "vulkan_helper/vk_device.hpp"
 #include "vulkan_helper/vk_dispatch.hpp"
 #include "vulkan_helper/vk_pipeline.hpp"
+#include "vulkan_helper/vk_pipeline_cache.hpp"
 
 #define MAX_OBJECTS 10000
 namespace ezg {
 //number of frames to overlap when rendering
 constexpr unsigned int FRAME_OVERLAP = 2;
+// pipeline cache file, relative to the working directory like the shader paths
+constexpr const char* PIPELINE_CACHE_FILE = "pipeline_cache.bin";
+// frames averaged per culling timing log
+constexpr uint32_t CullTimingLogInterval = 500;
+// draw groups worth a secondary command buffer, a group records a handful of commands so
+// smaller tasks cost more in pool resets and vkCmdExecuteCommands than they save
+constexpr uint32_t MinGroupsPerRecordTask = 32;
 
 struct DestructionQueue {
   std::deque<std::function<void()>> destructors;
@@ -50,6 +63,14 @@ public:
 
   void DisplayInfo();
 
+  /// @brief Replace the default scene with a generated one for scaling tests, call before Init.
+  void SetStressScene(const util::StressSceneConfig& config);
+
+  /// @brief Threads recording the draws into secondary command buffers, call before Init.
+  /// Defaults to 1, inline recording. Frames with fewer than 2 * MinGroupsPerRecordTask draw
+  /// groups are recorded inline either way.
+  void SetRecordThreads(uint32_t numThreads);
+
   //  const uint64_t TIME_OUT = std::numeric_limits<uint64_t>::max();
   const uint64_t TIME_OUT = 1000000000;
 
@@ -72,8 +93,16 @@ private:
 
   void InitPipelines();
 
+  void InitCulling();
+
   void InitScene();
 
+  void AddDefaultObjects();
+
+  void AddStressObjects();
+
+  void UpdateStressScene(float frameTime);
+
   // load spir-v shader file
   bool LoadShaderModule(const char* shaderPath, VkShaderModule* outShaderModule);
 
@@ -83,7 +112,25 @@ private:
 
   void UploadMesh(Mesh& mesh);
 
-  void RenderScene();
+  // split the scene draw order into instanced batches and draw groups, when it changed
+  void BuildDrawBatches();
+
+  // record the culling passes, before the render pass begins
+  void CullScene();
+
+  // add the GPU timings of the frame whose fence was just waited on, logged every
+  // CullTimingLogInterval frames
+  void ReadCullTimings();
+
+  // upload the frame data and record the render pass
+  void RenderScene(const VkRenderPassBeginInfo& rpInfo);
+
+  // copy the objects added or moved since this frame's object buffer was last written
+  void UploadDirtyObjects();
+
+  // draw groups [firstGroup, endGroup), inside the render pass
+  void RecordDrawGroups(VkCommandBuffer cmd, uint32_t firstGroup, uint32_t endGroup,
+                        uint32_t uniformOffset);
 
   void Draw();
 
@@ -92,8 +139,6 @@ private:
   AllocatedBuffer CreateBuffer(size_t bufferSize, VkBufferUsageFlags usage,
                                VmaMemoryUsage memoryUsage, VmaAllocationCreateFlags vmaFlags);
 
-  void ImmediateSubmit(std::function<void(VkCommandBuffer cmd)>&& function);
-
   FrameData& GetCurrentFrame() { return m_frames[m_frameNumber % FRAME_OVERLAP]; }
 
   bool m_initialized{false};
@@ -149,6 +194,12 @@ private:
 
   SceneSystem m_sceneSystem;
 
+  std::unique_ptr<util::StressSceneGenerator> m_stressScene;
+  float m_stressTime{0.0f};
+  // capacity of the per frame object buffers
+  uint32_t m_maxObjects{MAX_OBJECTS};
+  uint32_t m_numRecordThreads{1};
+
   Camera m_camera{glm::vec3(0.0f, -1.0f, -2.0f),
                   glm::vec3(0.0f, -1.0f, 0.0f),
                   90.0f,
@@ -163,18 +214,56 @@ private:
 
   VkDescriptorSetLayout m_globalSetLayout;
   VkDescriptorSetLayout m_objectSetLayout;
-  VkDescriptorSetLayout m_singleTextureSetLayout;
+  // global, object and bindless set, shared by every material
+  VkPipelineLayout m_meshPipelineLayout;
+  // GPUMaterialData of every material, read through the bindless set
+  AllocatedBuffer m_materialBuffer;
 
   GPUSceneData m_sceneParameters;
   AllocatedBuffer m_sceneParameterBuffer;
 
-  UploadContext m_uploadContext;
+  UploadManager m_uploads;
+  GeometryPool m_geometryPool;
+
+  VkDescriptorSetLayout m_cullSetLayout;
+  VkPipelineLayout m_cullPipelineLayout;
+  VkPipeline m_cullPipeline{VK_NULL_HANDLE};
+  VkPipeline m_compactPipeline{VK_NULL_HANDLE};
+  std::vector<DrawBatch> m_drawBatches;
+  std::vector<DrawGroup> m_drawGroups;
+  // batch of every scene object
+  std::vector<uint32_t> m_objectBatches;
+  size_t m_numBatchedObjects{0};
+  // SceneSystem draw order the batches were built from
+  uint32_t m_batchedDrawOrder{0};
+  // bumped by BuildDrawBatches, the frames re-upload their batches when theirs is older
+  uint32_t m_batchVersion{0};
+
+  bool m_supportsDrawIndirectCount{false};
+  PFN_vkCmdDrawIndexedIndirectCountKHR fp_vkCmdDrawIndexedIndirectCountKHR = nullptr;
+
+  // sums since the last log
+  struct {
+    double cpuRecordMs{0.0};
+    double gpuCullMs{0.0};
+    double gpuDrawMs{0.0};
+    size_t objectBytesWritten{0};
+    // vkCmdBindDescriptorSets calls of the scene draws
+    uint32_t descriptorBinds{0};
+    uint32_t numFrames{0};
+    // frames with GPU timestamps, the GPU sums are averaged over these
+    uint32_t numGpuFrames{0};
+  } m_cullTimings;
+
+  vkh::PipelineCache m_pipelineCache;
+  PipelineRegistry m_pipelineRegistry;
 
   std::unordered_map<std::string, Texture> m_loadedTextures;
 
-  friend bool LoadImageFromFile(EGEngine& engine, const char* file, AllocatedImage& outImage);
+  friend bool LoadImageFromFile(EGEngine& engine, const char* file, AllocatedImage& outImage,
+                                UploadTicket& outTicket);
   friend AllocatedImage UploadImage(int texWidth, int texHeight, VkFormat image_format,
-                                    EGEngine& engine, AllocatedBuffer& stagingBuffer);
+                                    EGEngine& engine, const void* pixels, UploadTicket& outTicket);
 };
 }  // namespace ezg
 
@@ -1,82 +1,347 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <glm/gtc/matrix_transform.hpp>
+#include <string>
 #include "engine.hpp"
+#include "ezg_util/job_system.hpp"
+#include "ezg_util/profiler.hpp"
+#include "vulkan_helper/vk_init.hpp"
 
 namespace ezg {
-void EGEngine::RenderScene() {
+namespace {
+// local sizes of shaders/cull.comp and shaders/compact_draws.comp
+constexpr uint32_t CullGroupSize    = 256;
+constexpr uint32_t CompactGroupSize = 64;
+
+// planes of the view frustum of a Vulkan projection, normals point inside. The near plane is
+// the OpenGL one (-w <= z), a little behind the real one, which only keeps a few more objects
+void ExtractFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6]) {
+  const glm::mat4 m = glm::transpose(viewProj);
+  planes[0]         = m[3] + m[0];
+  planes[1]         = m[3] - m[0];
+  planes[2]         = m[3] + m[1];
+  planes[3]         = m[3] - m[1];
+  planes[4]         = m[3] + m[2];
+  planes[5]         = m[3] - m[2];
+  for (int i = 0; i < 6; i++) {
+    planes[i] /= glm::length(glm::vec3(planes[i]));
+  }
+}
+}  // namespace
+
+void EGEngine::RenderScene(const VkRenderPassBeginInfo& rpInfo) {
+  EZG_PROFILE_FUNCTION();
   GPUCameraData camData;
   camData.proj     = m_camera.GetProjectionMatrix();
   camData.view     = m_camera.GetViewMatrix();
   camData.viewProj = camData.proj * camData.view;
 
-  void* data;
-  vmaMapMemory(m_allocator, GetCurrentFrame().cameraBuffer.m_allocation, &data);
-
-  memcpy(data, &camData, sizeof(GPUCameraData));
-
-  vmaUnmapMemory(m_allocator, GetCurrentFrame().cameraBuffer.m_allocation);
+  // the frame data buffers stay mapped, flushing is a no-op on coherent memory
+  memcpy(GetCurrentFrame().cameraBuffer.m_mapped, &camData, sizeof(GPUCameraData));
+  vmaFlushAllocation(m_allocator, GetCurrentFrame().cameraBuffer.m_allocation, 0,
+                     sizeof(GPUCameraData));
 
   float framed = (m_frameNumber / 120.f);
 
   m_sceneParameters.ambientColor = {sin(framed), 0, cos(framed), 1};
 
-  char* sceneData;
-  vmaMapMemory(m_allocator, m_sceneParameterBuffer.m_allocation, (void**)&sceneData);
   int frameIndex = m_frameNumber % FRAME_OVERLAP;
 
   uint32_t uniformOffset = PadUniformBufferSize(sizeof(GPUSceneData)) * frameIndex;
-  sceneData += uniformOffset;
-  memcpy(sceneData, &m_sceneParameters, sizeof(GPUSceneData));
-  vmaUnmapMemory(m_allocator, m_sceneParameterBuffer.m_allocation);
+  memcpy(static_cast<char*>(m_sceneParameterBuffer.m_mapped) + uniformOffset, &m_sceneParameters,
+         sizeof(GPUSceneData));
+  vmaFlushAllocation(m_allocator, m_sceneParameterBuffer.m_allocation, uniformOffset,
+                     sizeof(GPUSceneData));
 
-  void* objectData;
-  vmaMapMemory(m_allocator, GetCurrentFrame().objectBuffer.m_allocation, &objectData);
+  UploadDirtyObjects();
 
-  GPUObjectData* objectSSBO = (GPUObjectData*)objectData;
+  FrameData& frame     = GetCurrentFrame();
+  const auto numGroups = static_cast<uint32_t>(m_drawGroups.size());
+  if (m_numRecordThreads <= 1 || numGroups < 2 * MinGroupsPerRecordTask) {
+    m_dispatchTable.cmdBeginRenderPass(frame.cmdBuffer, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+    RecordDrawGroups(frame.cmdBuffer, 0, numGroups, uniformOffset);
+    m_dispatchTable.cmdEndRenderPass(frame.cmdBuffer);
+    m_cullTimings.descriptorBinds++;
+    return;
+  }
+
+  // contiguous ranges of draw groups, each recorded into its own secondary command buffer
+  const uint32_t groupsPerTask = std::max(
+      (numGroups + m_numRecordThreads - 1) / m_numRecordThreads, MinGroupsPerRecordTask);
+  const uint32_t numTasks = (numGroups + groupsPerTask - 1) / groupsPerTask;
+
+  VkCommandBufferInheritanceInfo inheritanceInfo{};
+  inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritanceInfo.renderPass  = rpInfo.renderPass;
+  inheritanceInfo.subpass     = 0;
+  inheritanceInfo.framebuffer = rpInfo.framebuffer;
+  util::ParallelFor(0, numTasks, 1, [&](size_t begin, size_t end) {
+    for (auto task = begin; task < end; task++) {
+      EZG_PROFILE_ZONE("Record Secondary");
+      VkCommandBuffer secondary = frame.secondaryCmdBuffers[task];
+      vkh::VkCheck(m_dispatchTable.resetCommandPool(frame.secondaryPools[task], 0),
+                   "reset secondary command pool");
+      VkCommandBufferBeginInfo beginInfo =
+          vkh::init::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                                            VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT);
+      beginInfo.pInheritanceInfo = &inheritanceInfo;
+      vkh::VkCheck(m_dispatchTable.beginCommandBuffer(secondary, &beginInfo),
+                   "begin secondary command buffer");
+      const auto firstGroup = static_cast<uint32_t>(task) * groupsPerTask;
+      RecordDrawGroups(secondary, firstGroup, std::min(firstGroup + groupsPerTask, numGroups),
+                       uniformOffset);
+      vkh::VkCheck(m_dispatchTable.endCommandBuffer(secondary), "end secondary command buffer");
+    }
+  });
+
+  m_dispatchTable.cmdBeginRenderPass(frame.cmdBuffer, &rpInfo,
+                                     VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+  m_dispatchTable.cmdExecuteCommands(frame.cmdBuffer, numTasks, frame.secondaryCmdBuffers.data());
+  m_dispatchTable.cmdEndRenderPass(frame.cmdBuffer);
+  // secondaries don't inherit bound sets, each binds them once
+  m_cullTimings.descriptorBinds += numTasks;
+}
 
-  for (int i = 0; i < m_sceneSystem.m_sceneObjs.size(); i++) {
-    auto& object              = m_sceneSystem.m_sceneObjs[i];
-    objectSSBO[i].modelMatrix = object.transformMatrix;
+void EGEngine::UploadDirtyObjects() {
+  EZG_PROFILE_FUNCTION();
+  // an object changed since the last frame is dirty for every frame in flight, each frame
+  // clears its own bits once its object buffer caught up
+  std::vector<uint64_t> changed;
+  m_sceneSystem.CollectDirty(changed);
+  for (auto& frame : m_frames) {
+    frame.dirtyObjects.resize(changed.size(), 0);
+    for (size_t i = 0; i < changed.size(); i++) {
+      frame.dirtyObjects[i] |= changed[i];
+    }
   }
 
-  vmaUnmapMemory(m_allocator, GetCurrentFrame().objectBuffer.m_allocation);
-  Mesh* lastMesh         = nullptr;
-  Material* lastMaterial = nullptr;
+  FrameData& frame    = GetCurrentFrame();
+  auto* objectSSBO    = static_cast<GPUObjectData*>(frame.objectBuffer.m_mapped);
+  const auto& objects = m_sceneSystem.m_sceneObjs;
+  size_t bytesWritten = 0;
+  size_t flushBegin   = SIZE_MAX;
+  size_t flushEnd     = 0;
+  // runs of dirty slots, one copy per run
+  size_t id = 0;
+  while (id < objects.size()) {
+    const auto word = frame.dirtyObjects[id / 64] >> (id % 64);
+    if (word == 0) {
+      id = (id / 64 + 1) * 64;
+      continue;
+    }
+    id += std::countr_zero(word);
+    auto end = id;
+    while (end < objects.size() && (frame.dirtyObjects[end / 64] >> (end % 64)) & 1) {
+      objectSSBO[end].modelMatrix   = objects[end].transformMatrix;
+      objectSSBO[end].materialIndex = m_sceneSystem.m_materials[objects[end].materialId]->index;
+      end++;
+    }
+    bytesWritten += (end - id) * sizeof(GPUObjectData);
+    flushBegin    = std::min(flushBegin, id);
+    flushEnd      = end;
+    id            = end;
+  }
+  std::fill(frame.dirtyObjects.begin(), frame.dirtyObjects.end(), 0);
+  if (bytesWritten > 0) {
+    vmaFlushAllocation(m_allocator, frame.objectBuffer.m_allocation,
+                       flushBegin * sizeof(GPUObjectData),
+                       (flushEnd - flushBegin) * sizeof(GPUObjectData));
+  }
+  m_cullTimings.objectBytesWritten += bytesWritten;
+}
 
-  for (int i = 0; i < m_sceneSystem.m_sceneObjs.size(); i++) {
-    const auto& sceneObj = m_sceneSystem.m_sceneObjs[i];
-    Material* material   = m_sceneSystem.m_materials[sceneObj.materialId];
-    Mesh* mesh           = m_sceneSystem.m_meshes[sceneObj.meshId];
+void EGEngine::RecordDrawGroups(VkCommandBuffer cmd, uint32_t firstGroup, uint32_t endGroup,
+                                uint32_t uniformOffset) {
+  // the culling pass wrote the draws, one multi draw per group of batches
+  VkBuffer vertexBuffer     = m_geometryPool.GetVertexBuffer();
+  VkDeviceSize vertexOffset = 0;
+  m_dispatchTable.cmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer, &vertexOffset);
+
+  // the materials share the layout, a material change only binds its pipeline
+  const VkDescriptorSet sets[] = {GetCurrentFrame().globalDescriptor,
+                                  GetCurrentFrame().objectDescriptor,
+                                  m_materialSystem.GetBindlessSet()};
+  m_dispatchTable.cmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_meshPipelineLayout,
+                                        0, 3, sets, 1, &uniformOffset);
+
+  constexpr uint32_t drawStride = sizeof(VkDrawIndexedIndirectCommand);
+  Material* lastMaterial        = nullptr;
+  for (uint32_t i = firstGroup; i < endGroup; i++) {
+    const auto& group  = m_drawGroups[i];
+    Material* material = group.material;
     if (material != lastMaterial) {
-      m_dispatchTable.cmdBindPipeline(GetCurrentFrame().cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                      material->pipeline);
-      m_dispatchTable.cmdBindDescriptorSets(
-          GetCurrentFrame().cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material->pipelineLayout, 0,
-          1, &GetCurrentFrame().globalDescriptor, 1, &uniformOffset);
-
-      m_dispatchTable.cmdBindDescriptorSets(
-          GetCurrentFrame().cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material->pipelineLayout, 1,
-          1, &GetCurrentFrame().objectDescriptor, 0, nullptr);
-
-      if (material->textureSet != VK_NULL_HANDLE) {
-        m_dispatchTable.cmdBindDescriptorSets(
-            GetCurrentFrame().cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material->pipelineLayout,
-            2, 1, &material->textureSet, 0, nullptr);
-      }
+      m_dispatchTable.cmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, material->pipeline);
       lastMaterial = material;
     }
+    m_dispatchTable.cmdBindIndexBuffer(cmd, m_geometryPool.GetIndexBuffer(group.indexType), 0,
+                                       group.indexType);
+    if (m_supportsDrawIndirectCount) {
+      fp_vkCmdDrawIndexedIndirectCountKHR(cmd, GetCurrentFrame().compactDrawBuffer.m_buffer,
+                                          group.firstBatch * drawStride,
+                                          GetCurrentFrame().drawCountBuffer.m_buffer,
+                                          i * sizeof(uint32_t), group.batchCount, drawStride);
+    } else {
+      // every batch command is drawn, the culled ones with zero instances
+      m_dispatchTable.cmdDrawIndexedIndirect(cmd, GetCurrentFrame().drawCommandBuffer.m_buffer,
+                                             group.firstBatch * drawStride, group.batchCount,
+                                             drawStride);
+    }
+  }
+}
+
+void EGEngine::BuildDrawBatches() {
+  EZG_PROFILE_FUNCTION();
+  // the shaders find the material of every instance in the object data, only a pipeline change
+  // ends a draw group
+  const auto& drawOrder = m_sceneSystem.GetDrawOrder();
+  BuildDrawGroups(m_sceneSystem, DrawGroupSplit::Pipeline, m_drawBatches, m_drawGroups,
+                  m_objectBatches);
+  m_numBatchedObjects = m_sceneSystem.GetNumSlots();
+  m_batchedDrawOrder  = m_sceneSystem.GetDrawOrderVersion();
+  m_batchVersion++;
+  vkh::Log("Instancing: " + std::to_string(drawOrder.size()) + " objects in " +
+           std::to_string(m_drawBatches.size()) + " instanced batches, " +
+           std::to_string(m_drawGroups.size()) + " draw groups");
+}
+
+void EGEngine::CullScene() {
+  EZG_PROFILE_FUNCTION();
+  FrameData& frame    = GetCurrentFrame();
+  VkCommandBuffer cmd = frame.cmdBuffer;
+  if (m_batchedDrawOrder != m_sceneSystem.GetDrawOrderVersion()) {
+    BuildDrawBatches();
+  }
+  if (frame.timestampPool != VK_NULL_HANDLE) {
+    m_dispatchTable.cmdResetQueryPool(cmd, frame.timestampPool, 0, 3);
+    m_dispatchTable.cmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.timestampPool,
+                                      0);
+  }
 
-    MeshPushConstants pushConstants{};
-    pushConstants.renderMatrix = sceneObj.transformMatrix;
-    m_dispatchTable.cmdPushConstants(GetCurrentFrame().cmdBuffer, material->pipelineLayout,
-                                     VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants),
-                                     &pushConstants);
-    if (mesh != lastMesh) {
-      VkDeviceSize offset = 0;
-      m_dispatchTable.cmdBindVertexBuffers(GetCurrentFrame().cmdBuffer, 0, 1,
-                                           &mesh->m_vertexBuffer.m_buffer, &offset);
-      lastMesh = mesh;
+  const auto numObjects = static_cast<uint32_t>(m_numBatchedObjects);
+  const auto numBatches = static_cast<uint32_t>(m_drawBatches.size());
+  if (frame.batchVersion != m_batchVersion) {
+    memcpy(frame.cullObjectBuffer.m_mapped, m_objectBatches.data(),
+           m_objectBatches.size() * sizeof(uint32_t));
+    vmaFlushAllocation(m_allocator, frame.cullObjectBuffer.m_allocation, 0,
+                       m_objectBatches.size() * sizeof(uint32_t));
+
+    auto* gpuBatches = static_cast<GPUDrawBatch*>(frame.drawBatchBuffer.m_mapped);
+    for (uint32_t i = 0; i < m_drawGroups.size(); i++) {
+      const auto& group = m_drawGroups[i];
+      for (uint32_t b = group.firstBatch; b < group.firstBatch + group.batchCount; b++) {
+        const auto& batch = m_drawBatches[b];
+        GPUDrawBatch gpuBatch{};
+        gpuBatch.boundingSphere = batch.mesh->m_bounds;
+        gpuBatch.indexCount     = static_cast<uint32_t>(batch.mesh->m_indices.size());
+        gpuBatch.firstIndex     = batch.mesh->m_firstIndex;
+        gpuBatch.vertexOffset   = batch.mesh->m_vertexOffset;
+        gpuBatch.firstInstance  = batch.firstInstance;
+        gpuBatch.drawGroup      = i;
+        gpuBatch.groupFirstDraw = group.firstBatch;
+        gpuBatches[b]           = gpuBatch;
+      }
     }
-    m_dispatchTable.cmdDraw(GetCurrentFrame().cmdBuffer, mesh->m_vertices.size(), 1, 0, i);
+    vmaFlushAllocation(m_allocator, frame.drawBatchBuffer.m_allocation, 0,
+                       m_drawBatches.size() * sizeof(GPUDrawBatch));
+    frame.batchVersion = m_batchVersion;
+  }
+
+  // fresh templates every frame, the cull pass counts the visible instances into them
+  auto* commands = static_cast<VkDrawIndexedIndirectCommand*>(frame.drawCommandBuffer.m_mapped);
+  for (uint32_t b = 0; b < numBatches; b++) {
+    const auto& batch = m_drawBatches[b];
+    // still streaming in, drawn from the frame its upload completes
+    const bool ready = m_uploads.IsComplete(batch.mesh->m_uploadTicket) &&
+                       m_uploads.IsComplete(batch.material->uploadTicket);
+    VkDrawIndexedIndirectCommand command{};
+    command.indexCount    = ready ? static_cast<uint32_t>(batch.mesh->m_indices.size()) : 0;
+    command.instanceCount = 0;
+    command.firstIndex    = batch.mesh->m_firstIndex;
+    command.vertexOffset  = batch.mesh->m_vertexOffset;
+    command.firstInstance = batch.firstInstance;
+    commands[b]           = command;
+  }
+  vmaFlushAllocation(m_allocator, frame.drawCommandBuffer.m_allocation, 0,
+                     numBatches * sizeof(VkDrawIndexedIndirectCommand));
+
+  memset(frame.drawCountBuffer.m_mapped, 0, m_drawGroups.size() * sizeof(uint32_t));
+  vmaFlushAllocation(m_allocator, frame.drawCountBuffer.m_allocation, 0,
+                     m_drawGroups.size() * sizeof(uint32_t));
+
+  if (numObjects == 0) {
+    return;
+  }
+  GPUCullConstants cullConstants{};
+  ExtractFrustumPlanes(m_camera.GetProjectionMatrix() * m_camera.GetViewMatrix(),
+                       cullConstants.frustumPlanes);
+  cullConstants.objectCount = numObjects;
+  cullConstants.batchCount  = numBatches;
+
+  m_dispatchTable.cmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout,
+                                        0, 1, &frame.cullDescriptor, 0, nullptr);
+  m_dispatchTable.cmdPushConstants(cmd, m_cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                                   sizeof(GPUCullConstants), &cullConstants);
+  m_dispatchTable.cmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline);
+  m_dispatchTable.cmdDispatch(cmd, (numObjects + CullGroupSize - 1) / CullGroupSize, 1, 1);
+
+  // the instance counts are complete before they are compacted
+  VkMemoryBarrier barrier{};
+  barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  m_dispatchTable.cmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0,
+                                     nullptr, 0, nullptr);
+
+  m_dispatchTable.cmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_compactPipeline);
+  m_dispatchTable.cmdDispatch(cmd, (numBatches + CompactGroupSize - 1) / CompactGroupSize, 1, 1);
+
+  // draws read the commands and counts, the vertex shader the visible instances
+  barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+  m_dispatchTable.cmdPipelineBarrier(
+      cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &barrier, 0,
+      nullptr, 0, nullptr);
+
+  if (frame.timestampPool != VK_NULL_HANDLE) {
+    m_dispatchTable.cmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                      frame.timestampPool, 1);
+  }
+}
+
+void EGEngine::ReadCullTimings() {
+  // the CPU side is logged on devices without timestamps as well
+  FrameData& frame = GetCurrentFrame();
+  uint64_t timestamps[3];
+  if (frame.timestampPool != VK_NULL_HANDLE && frame.timestampsWritten &&
+      m_dispatchTable.getQueryPoolResults(frame.timestampPool, 0, 3, sizeof(timestamps),
+                                          timestamps, sizeof(uint64_t),
+                                          VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+    const double period = m_gpuProperties.limits.timestampPeriod * 1e-6;
+    m_cullTimings.gpuCullMs += static_cast<double>(timestamps[1] - timestamps[0]) * period;
+    m_cullTimings.gpuDrawMs += static_cast<double>(timestamps[2] - timestamps[1]) * period;
+    m_cullTimings.numGpuFrames++;
+  }
+  if (++m_cullTimings.numFrames < CullTimingLogInterval) {
+    return;
   }
+  const double numFrames = m_cullTimings.numFrames;
+  const std::string gpuTimings =
+      m_cullTimings.numGpuFrames == 0
+          ? "no GPU timestamps"
+          : "GPU cull " + std::to_string(m_cullTimings.gpuCullMs / m_cullTimings.numGpuFrames) +
+                " ms, GPU draw " +
+                std::to_string(m_cullTimings.gpuDrawMs / m_cullTimings.numGpuFrames) + " ms";
+  vkh::Log(std::to_string(m_sceneSystem.GetDrawOrder().size()) + " objects in " +
+           std::to_string(m_drawBatches.size()) + " batches, " +
+           std::to_string(m_drawGroups.size()) + " draws: CPU record " +
+           std::to_string(m_cullTimings.cpuRecordMs / numFrames) + " ms on " +
+           std::to_string(m_numRecordThreads) + " threads, " +
+           std::to_string(m_cullTimings.descriptorBinds / numFrames) + " descriptor binds, " +
+           std::to_string(m_cullTimings.objectBytesWritten / numFrames / 1024.0) +
+           " KiB object data written, " + gpuTimings);
+  m_cullTimings = {};
 }
-}  // namespace ezg
\ No newline at end of file
+}  // namespace ezg
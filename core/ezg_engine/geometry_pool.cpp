@@ -0,0 +1,83 @@
+#include "geometry_pool.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "vulkan_helper/vk_tools.hpp"
+
+namespace ezg {
+void GeometryPool::Init(VmaAllocator allocator, UploadManager* uploads,
+                        VkDeviceSize vertexCapacity, VkDeviceSize indexCapacity) {
+  m_allocator = allocator;
+  m_uploads   = uploads;
+
+  m_vertexBuffer  = CreateBuffer(vertexCapacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+  m_indexBuffer16 = CreateBuffer(indexCapacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+  m_indexBuffer32 = CreateBuffer(indexCapacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+}
+
+void GeometryPool::Cleanup() {
+  for (auto* buffer : {&m_vertexBuffer, &m_indexBuffer16, &m_indexBuffer32}) {
+    vmaDestroyBuffer(m_allocator, buffer->m_buffer, buffer->m_allocation);
+  }
+}
+
+AllocatedBuffer GeometryPool::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage) {
+  VkBufferCreateInfo bufferInfo{};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size  = size;
+  bufferInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+  VmaAllocationCreateInfo allocInfo{};
+  allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+  AllocatedBuffer buffer{};
+  vkh::VkCheck(vmaCreateBuffer(m_allocator, &bufferInfo, &allocInfo, &buffer.m_buffer,
+                               &buffer.m_allocation, nullptr),
+               "create geometry pool buffer");
+  buffer.m_size = size;
+  return buffer;
+}
+
+bool GeometryPool::Add(Mesh& mesh) {
+  const auto numVertices = static_cast<uint32_t>(mesh.m_vertices.size());
+  const auto numIndices  = static_cast<uint32_t>(mesh.m_indices.size());
+  // 16 bit indices halve the index data whenever every vertex is addressable with them, they
+  // are relative to the mesh, vertexOffset moves them into the shared vertex buffer
+  const bool shortIndices            = numVertices <= UINT16_MAX + 1;
+  const VkDeviceSize indexSize       = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+  uint32_t& usedIndices              = shortIndices ? m_numIndices16 : m_numIndices32;
+  const AllocatedBuffer& indexBuffer = shortIndices ? m_indexBuffer16 : m_indexBuffer32;
+
+  if ((m_numVertices + numVertices) * sizeof(Vertex) > m_vertexBuffer.m_size ||
+      (usedIndices + numIndices) * indexSize > indexBuffer.m_size) {
+    vkh::Log("Geometry pool is full, mesh with " + std::to_string(numVertices) +
+             " vertices not added");
+    return false;
+  }
+
+  mesh.m_indexType    = shortIndices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+  mesh.m_firstIndex   = usedIndices;
+  mesh.m_vertexOffset = static_cast<int32_t>(m_numVertices);
+
+  std::vector<uint16_t> packedIndices;
+  const void* indexData = mesh.m_indices.data();
+  if (shortIndices) {
+    packedIndices.assign(mesh.m_indices.begin(), mesh.m_indices.end());
+    indexData = packedIndices.data();
+  }
+
+  // the data is staged right away, the copies run with the next flush
+  const UploadTicket vertexTicket = m_uploads->CopyToBuffer(
+      m_vertexBuffer.m_buffer, mesh.m_vertices.data(), numVertices * sizeof(Vertex),
+      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+      m_numVertices * sizeof(Vertex));
+  const UploadTicket indexTicket = m_uploads->CopyToBuffer(
+      indexBuffer.m_buffer, indexData, numIndices * indexSize, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+      VK_ACCESS_INDEX_READ_BIT, usedIndices * indexSize);
+  mesh.m_uploadTicket = std::max(vertexTicket, indexTicket);
+
+  m_numVertices += numVertices;
+  usedIndices += numIndices;
+  return true;
+}
+}  // namespace ezg
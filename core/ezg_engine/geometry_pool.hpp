@@ -0,0 +1,52 @@
+#ifndef GEOMETRY_POOL_HPP
+#define GEOMETRY_POOL_HPP
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+
+#include "mesh.hpp"
+#include "types.hpp"
+#include "upload_manager.hpp"
+
+namespace ezg {
+/// @brief Vertex and index buffers shared by every mesh.
+///
+/// Meshes are suballocated back to back, so draws of different meshes only differ in their
+/// firstIndex / vertexOffset and can be merged into one indirect draw. 16 and 32 bit indices
+/// live in separate buffers, an indirect draw only reads one index type.
+class GeometryPool {
+public:
+  void Init(VmaAllocator allocator, UploadManager* uploads,
+            VkDeviceSize vertexCapacity = DefaultVertexCapacity,
+            VkDeviceSize indexCapacity  = DefaultIndexCapacity);
+
+  void Cleanup();
+
+  /// @brief Stage the mesh vertices and indices, sets its index type, firstIndex, vertexOffset
+  /// and upload ticket. False if the pool is full.
+  bool Add(Mesh& mesh);
+
+  [[nodiscard]] VkBuffer GetVertexBuffer() const { return m_vertexBuffer.m_buffer; }
+  [[nodiscard]] VkBuffer GetIndexBuffer(VkIndexType indexType) const {
+    return indexType == VK_INDEX_TYPE_UINT16 ? m_indexBuffer16.m_buffer : m_indexBuffer32.m_buffer;
+  }
+
+  static constexpr VkDeviceSize DefaultVertexCapacity = 64 * 1024 * 1024;
+  // per index type
+  static constexpr VkDeviceSize DefaultIndexCapacity = 32 * 1024 * 1024;
+
+private:
+  AllocatedBuffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage);
+
+  VmaAllocator m_allocator{VK_NULL_HANDLE};
+  UploadManager* m_uploads{nullptr};
+
+  AllocatedBuffer m_vertexBuffer;
+  AllocatedBuffer m_indexBuffer16;
+  AllocatedBuffer m_indexBuffer32;
+  // in elements
+  uint32_t m_numVertices{0};
+  uint32_t m_numIndices16{0};
+  uint32_t m_numIndices32{0};
+};
+}  // namespace ezg
+#endif  //GEOMETRY_POOL_HPP
@@ -1,7 +1,87 @@
 #include "material_system.hpp"
+#include <cstring>
+#include "vulkan_helper/vk_tools.hpp"
 
 namespace ezg {
-void MaterialSystem::Init() {}
+void MaterialSystem::Init(const vkh::DispatchTable* dispatchTable, VmaAllocator allocator,
+                          const AllocatedBuffer& materialBuffer) {
+  m_dispatchTable  = dispatchTable;
+  m_allocator      = allocator;
+  m_materialBuffer = materialBuffer;
+
+  VkDescriptorSetLayoutBinding bindings[2]{};
+  bindings[0].binding         = 0;
+  bindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  bindings[0].descriptorCount = MaxBindlessTextures;
+  bindings[0].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+  bindings[1].binding         = 1;
+  bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  bindings[1].descriptorCount = 1;
+  bindings[1].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+  // elements past the loaded textures are never written, textures are added while the set is
+  // bound by frames in flight that don't sample them
+  const VkDescriptorBindingFlagsEXT bindingFlags[2] = {
+      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+          VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+          VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT,
+      0};
+  VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+  bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+  bindingFlagsInfo.bindingCount  = 2;
+  bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+  // not from the layout cache, it keys on the bindings only and would drop the flags
+  VkDescriptorSetLayoutCreateInfo layoutInfo{};
+  layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.pNext        = &bindingFlagsInfo;
+  layoutInfo.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+  layoutInfo.bindingCount = 2;
+  layoutInfo.pBindings    = bindings;
+  vkh::VkCheck(m_dispatchTable->createDescriptorSetLayout(&layoutInfo, nullptr, &m_bindlessLayout),
+               "create bindless descriptor set layout");
+
+  const VkDescriptorPoolSize poolSizes[2] = {
+      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MaxBindlessTextures},
+      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}};
+  VkDescriptorPoolCreateInfo poolInfo{};
+  poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+  poolInfo.maxSets       = 1;
+  poolInfo.poolSizeCount = 2;
+  poolInfo.pPoolSizes    = poolSizes;
+  vkh::VkCheck(m_dispatchTable->createDescriptorPool(&poolInfo, nullptr, &m_bindlessPool),
+               "create bindless descriptor pool");
+
+  VkDescriptorSetAllocateInfo allocInfo{};
+  allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool     = m_bindlessPool;
+  allocInfo.descriptorSetCount = 1;
+  allocInfo.pSetLayouts        = &m_bindlessLayout;
+  vkh::VkCheck(m_dispatchTable->allocateDescriptorSets(&allocInfo, &m_bindlessSet),
+               "allocate bindless descriptor set");
+
+  VkDescriptorBufferInfo materialBufferInfo = m_materialBuffer.GetDescriptorBufferInfo();
+  VkWriteDescriptorSet write{};
+  write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.dstSet          = m_bindlessSet;
+  write.dstBinding      = 1;
+  write.descriptorCount = 1;
+  write.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  write.pBufferInfo     = &materialBufferInfo;
+  m_dispatchTable->updateDescriptorSets(1, &write, 0, nullptr);
+}
+
+void MaterialSystem::Cleanup() {
+  // the set is freed with its pool
+  m_dispatchTable->destroyDescriptorPool(m_bindlessPool, nullptr);
+  m_dispatchTable->destroyDescriptorSetLayout(m_bindlessLayout, nullptr);
+  for (auto& [name, material] : m_materials) {
+    delete material;
+  }
+  m_materials.clear();
+  m_numTextures = 0;
+}
 
 Material* MaterialSystem::GetMaterial(const std::string& name) {
   auto it = m_materials.find(name);
@@ -13,15 +93,46 @@ Material* MaterialSystem::GetMaterial(const std::string& name) {
 }
 
 void MaterialSystem::CreateMaterial(const std::string& name, VkPipeline pipeline,
-                                    VkPipelineLayout pipelineLayout) {
+                                    VkPipelineLayout pipelineLayout, const GPUMaterialData& data) {
   if (m_materials.find(name) != m_materials.end()) {
     return;
-  } else {
-    auto* material           = new Material();
-    material->name           = name;
-    material->pipeline       = pipeline;
-    material->pipelineLayout = pipelineLayout;
-    m_materials[name]        = material;
   }
+  if (m_materials.size() >= MaxMaterials) {
+    vkh::Log("Material buffer full, material " + name + " not created");
+    return;
+  }
+  auto* material           = new Material();
+  material->name           = name;
+  material->pipeline       = pipeline;
+  material->pipelineLayout = pipelineLayout;
+  material->index          = static_cast<uint32_t>(m_materials.size());
+  m_materials[name]        = material;
+
+  // frames only read the materials of objects added after this
+  const VkDeviceSize offset = material->index * sizeof(GPUMaterialData);
+  memcpy(static_cast<char*>(m_materialBuffer.m_mapped) + offset, &data, sizeof(GPUMaterialData));
+  vmaFlushAllocation(m_allocator, m_materialBuffer.m_allocation, offset, sizeof(GPUMaterialData));
+}
+
+uint32_t MaterialSystem::AddTexture(VkImageView imageView, VkSampler sampler) {
+  if (m_numTextures >= MaxBindlessTextures) {
+    vkh::Log("Bindless texture array full");
+    return NoTexture;
+  }
+  VkDescriptorImageInfo imageInfo{};
+  imageInfo.sampler     = sampler;
+  imageInfo.imageView   = imageView;
+  imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+  VkWriteDescriptorSet write{};
+  write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  write.dstSet          = m_bindlessSet;
+  write.dstBinding      = 0;
+  write.dstArrayElement = m_numTextures;
+  write.descriptorCount = 1;
+  write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  write.pImageInfo      = &imageInfo;
+  m_dispatchTable->updateDescriptorSets(1, &write, 0, nullptr);
+  return m_numTextures++;
 }
-}  // namespace ezg
\ No newline at end of file
+}  // namespace ezg
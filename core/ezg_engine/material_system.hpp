@@ -3,25 +3,62 @@
 #include <vulkan/vulkan.h>
 #include <string>
 #include <unordered_map>
+#include "types.hpp"
+#include "vulkan_helper/vk_dispatch.hpp"
 
 namespace ezg {
+// elements of the bindless texture array and of the material buffer
+constexpr uint32_t MaxBindlessTextures = 1024;
+constexpr uint32_t MaxMaterials        = 256;
+
 struct MaterialInfo {};
 struct Material {
   std::string name;
   VkPipeline pipeline;
   VkPipelineLayout pipelineLayout;
-  VkDescriptorSet textureSet{VK_NULL_HANDLE};
+  // element of the material buffer, the objects reference the material by it
+  uint32_t index{0};
+  // upload of the textures the material samples
+  UploadTicket uploadTicket{0};
 };
+
+/// @brief Owns the materials and the bindless set they are drawn with.
+///
+/// The set holds every texture in one partially bound, update after bind sampler array
+/// (binding 0) and the GPUMaterialData of every material (binding 1). A frame binds it once,
+/// shaders pick the material with the index from the object data and the texture with the
+/// index from the material.
 class MaterialSystem {
 public:
-  void Init();
+  /// @brief Requires the descriptor indexing features the engine enables in InitVulkan. The
+  /// material buffer must be host mapped and hold MaxMaterials materials.
+  void Init(const vkh::DispatchTable* dispatchTable, VmaAllocator allocator,
+            const AllocatedBuffer& materialBuffer);
+
+  void Cleanup();
 
   Material* GetMaterial(const std::string& name);
 
   void CreateMaterial(const std::string& name, VkPipeline pipeline,
-                      VkPipelineLayout pipelineLayout);
+                      VkPipelineLayout pipelineLayout, const GPUMaterialData& data = {});
+
+  /// @brief Write the texture into the next free element of the array, it can be added while
+  /// frames using the set are in flight. Returns NoTexture when the array is full.
+  uint32_t AddTexture(VkImageView imageView, VkSampler sampler);
+
+  [[nodiscard]] VkDescriptorSetLayout GetBindlessSetLayout() const { return m_bindlessLayout; }
+  [[nodiscard]] VkDescriptorSet GetBindlessSet() const { return m_bindlessSet; }
 
 private:
+  const vkh::DispatchTable* m_dispatchTable{nullptr};
+  VmaAllocator m_allocator{VK_NULL_HANDLE};
+  AllocatedBuffer m_materialBuffer;
+
+  VkDescriptorSetLayout m_bindlessLayout{VK_NULL_HANDLE};
+  VkDescriptorPool m_bindlessPool{VK_NULL_HANDLE};
+  VkDescriptorSet m_bindlessSet{VK_NULL_HANDLE};
+  uint32_t m_numTextures{0};
+
   std::unordered_map<std::string, Material*> m_materials;
 };
 }  // namespace ezg
@@ -1,6 +1,8 @@
 #include "mesh.hpp"
-#include <tiny_obj_loader.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include "ezg_util/obj_loader.hpp"
 
 namespace ezg {
 VertexInputDescription Vertex::GetVertexDescription() {
@@ -28,13 +30,6 @@ VertexInputDescription Vertex::GetVertexDescription() {
   normalAttribute.format   = VK_FORMAT_R32G32B32_SFLOAT;
   normalAttribute.offset   = offsetof(Vertex, normal);
 
-  //Position will be stored at Location 2
-  VkVertexInputAttributeDescription colorAttribute{};
-  colorAttribute.binding  = 0;
-  colorAttribute.location = 2;
-  colorAttribute.format   = VK_FORMAT_R32G32B32_SFLOAT;
-  colorAttribute.offset   = offsetof(Vertex, color);
-
   //UV will be stored at Location 3
   VkVertexInputAttributeDescription uvAttribute{};
   uvAttribute.binding  = 0;
@@ -44,85 +39,64 @@ VertexInputDescription Vertex::GetVertexDescription() {
 
   description.attributes.push_back(positionAttribute);
   description.attributes.push_back(normalAttribute);
-  description.attributes.push_back(colorAttribute);
   description.attributes.push_back(uvAttribute);
   return description;
 }
 
 bool Mesh::LoadFromObj(const char* filename) {
-  //attrib will contain the vertex arrays of the file
-  tinyobj::attrib_t attrib;
-  //shapes contains the info for each separate object in the file
-  std::vector<tinyobj::shape_t> shapes;
-  //materials contains the information about the material of each shape, but we wont use it.
-  std::vector<tinyobj::material_t> materials;
-
-  //error and warning output from the load function
-  std::string warn;
-  std::string err;
-
-  //load the OBJ file
-  tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, nullptr);
-  //make sure to output the warnings to the console, in case there are issues with the file
-  if (!warn.empty()) {
-    std::cout << "WARN: " << warn << std::endl;
-  }
-  //if we have any error, print it to the console, and break the mesh loading.
-  //This happens if the file cant be found or is malformed
-  if (!err.empty()) {
-    std::cerr << err << std::endl;
+  util::ObjModel obj;
+  std::string error;
+  if (!util::LoadObj(filename, obj, error)) {
+    std::cerr << filename << ": " << error << std::endl;
     return false;
   }
+  //make sure to output the warnings to the console, in case there are issues with the file
+  if (!obj.warnings.empty()) {
+    std::cout << "WARN: " << obj.warnings << std::endl;
+  }
 
-  // Loop over shapes
-  for (size_t s = 0; s < shapes.size(); s++) {
-    // Loop over faces(polygon)
-    size_t index_offset = 0;
-    for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-
-      //hardcode loading to triangles
-      int fv = 3;
-
-      // Loop over vertices in the face.
-      for (size_t v = 0; v < fv; v++) {
-        // access to vertex
-        tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-        //vertex position
-        tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
-        tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
-        tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
-        //vertex normal
-        tinyobj::real_t nx = attrib.normals[3 * idx.normal_index + 0];
-        tinyobj::real_t ny = attrib.normals[3 * idx.normal_index + 1];
-        tinyobj::real_t nz = attrib.normals[3 * idx.normal_index + 2];
-
-        //vertex uv
-        tinyobj::real_t ux = attrib.texcoords[2 * idx.texcoord_index + 0];
-        tinyobj::real_t uy = attrib.texcoords[2 * idx.texcoord_index + 1];
-
-        //copy it into our vertex
-        Vertex new_vert;
-        new_vert.position.x = vx;
-        new_vert.position.y = vy;
-        new_vert.position.z = vz;
-
-        new_vert.normal.x = nx;
-        new_vert.normal.y = ny;
-        new_vert.normal.z = nz;
-
-        new_vert.uv.x = ux;
-        new_vert.uv.y = 1 - uy;
+  // the face corners come welded, append them behind the existing vertices
+  const auto baseVertex = static_cast<uint32_t>(m_vertices.size());
+  m_vertices.reserve(m_vertices.size() + obj.vertices.size());
+  for (const auto& objVertex : obj.vertices) {
+    Vertex vertex;
+    vertex.position = objVertex.position;
+    vertex.normal   = objVertex.normal;
+    vertex.uv       = {objVertex.uv.x, 1.0f - objVertex.uv.y};
+    m_vertices.push_back(vertex);
+  }
+  m_indices.reserve(m_indices.size() + obj.indices.size());
+  for (uint32_t index : obj.indices) {
+    m_indices.push_back(baseVertex + index);
+  }
 
-        //we are setting the vertex color as the vertex normal. This is just for display purposes
-        new_vert.color = new_vert.normal;
+  // 44 byte vertices per corner before, now welded 32 byte vertices plus the indices
+  const size_t indexSize     = m_vertices.size() <= UINT16_MAX + 1 ? 2 : 4;
+  const size_t unweldedBytes = obj.indices.size() * 44;
+  const size_t indexedBytes  = m_vertices.size() * sizeof(Vertex) + m_indices.size() * indexSize;
+  std::cout << filename << " vertex count: " << m_vertices.size() << " (" << obj.indices.size()
+            << " unwelded), index count: " << m_indices.size() << ", " << indexedBytes / 1024
+            << " KiB instead of " << unweldedBytes / 1024 << " KiB" << std::endl;
+  return true;
+}
 
-        m_vertices.push_back(new_vert);
-      }
-      index_offset += fv;
-    }
+void Mesh::ComputeBounds() {
+  if (m_vertices.empty()) {
+    m_bounds = glm::vec4{0.0f};
+    return;
   }
-  std::cout << filename << " vertex count: " << m_vertices.size() << std::endl;
-  return true;
+  glm::vec3 minPos = m_vertices[0].position;
+  glm::vec3 maxPos = m_vertices[0].position;
+  for (const auto& vertex : m_vertices) {
+    minPos = glm::min(minPos, vertex.position);
+    maxPos = glm::max(maxPos, vertex.position);
+  }
+  const glm::vec3 center = (minPos + maxPos) * 0.5f;
+  float radius2          = 0.0f;
+  for (const auto& vertex : m_vertices) {
+    const glm::vec3 d = vertex.position - center;
+    radius2           = std::max(radius2, glm::dot(d, d));
+  }
+  m_bounds = glm::vec4{center, std::sqrt(radius2)};
 }
-}  // namespace ezg
\ No newline at end of file
+}  // namespace ezg
@@ -12,10 +12,10 @@ struct VertexInputDescription {
 
   VkPipelineVertexInputStateCreateFlags flags = 0;
 };
+// the shaders show the normal as vertex color, location 2 (the old color attribute) is unused
 struct Vertex {
   glm::vec3 position;
   glm::vec3 normal;
-  glm::vec3 color;
   glm::vec2 uv;
 
   static VertexInputDescription GetVertexDescription();
@@ -23,10 +23,24 @@ struct Vertex {
 
 struct Mesh {
   std::vector<Vertex> m_vertices;
+  // triangle list into m_vertices, stored as 16 bit on the GPU when the vertex count allows it
+  std::vector<uint32_t> m_indices;
 
-  AllocatedBuffer m_vertexBuffer;
+  // location in the GeometryPool buffers, set when the mesh is added to it
+  VkIndexType m_indexType{VK_INDEX_TYPE_UINT32};
+  uint32_t m_firstIndex{0};
+  int32_t m_vertexOffset{0};
+  // model space bounding sphere, xyz center, w radius
+  glm::vec4 m_bounds{0.0f};
+  // the mesh can't be drawn before this upload is complete
+  UploadTicket m_uploadTicket{0};
 
+  /// @brief Load an OBJ through util::LoadObj, face corners with the same position, uv and
+  /// normal share one indexed vertex.
   bool LoadFromObj(const char* filename);
+
+  /// @brief Fit m_bounds around m_vertices, centered on their bounding box.
+  void ComputeBounds();
 };
 }  // namespace ezg
 #endif  //MESH_HPP
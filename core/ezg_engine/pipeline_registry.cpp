@@ -0,0 +1,200 @@
+#include "pipeline_registry.hpp"
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ezg {
+namespace {
+// builder copy that owns the arrays the builder only points to, it outlives the Request call
+struct CompileJob {
+  explicit CompileJob(const vkh::PipelineBuilder& builder_) : builder(builder_) {
+    const auto& vertexInput = builder.m_vertexInputInfo;
+    bindings.assign(vertexInput.pVertexBindingDescriptions,
+                    vertexInput.pVertexBindingDescriptions +
+                        vertexInput.vertexBindingDescriptionCount);
+    attributes.assign(vertexInput.pVertexAttributeDescriptions,
+                      vertexInput.pVertexAttributeDescriptions +
+                          vertexInput.vertexAttributeDescriptionCount);
+    builder.m_vertexInputInfo.pVertexBindingDescriptions   = bindings.data();
+    builder.m_vertexInputInfo.pVertexAttributeDescriptions = attributes.data();
+
+    for (const auto& stage : builder.m_shaderStages) {
+      entryPoints.emplace_back(stage.pName);
+    }
+    for (size_t i = 0; i < builder.m_shaderStages.size(); i++) {
+      builder.m_shaderStages[i].pName = entryPoints[i].c_str();
+    }
+  }
+
+  vkh::PipelineBuilder builder;
+  std::vector<VkVertexInputBindingDescription> bindings;
+  std::vector<VkVertexInputAttributeDescription> attributes;
+  std::vector<std::string> entryPoints;
+  VkRenderPass pass{VK_NULL_HANDLE};
+  std::promise<VkPipeline> promise;
+};
+
+template <typename T>
+void Append(std::string& key, const T& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void Append(std::string& key, const T* values, uint32_t count) {
+  Append(key, count);
+  for (uint32_t i = 0; i < count; i++) {
+    Append(key, values[i]);
+  }
+}
+}  // namespace
+
+bool PipelineHandle::IsReady() const {
+  return m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+VkPipeline PipelineHandle::Get() const {
+  // the compile job may still be queued, help instead of blocking a thread the workers need
+  while (!IsReady()) {
+    if (!util::JobSystem::Get().TryRunJob()) {
+      std::this_thread::yield();
+    }
+  }
+  return m_future.get();
+}
+
+void PipelineRegistry::Init(const vkh::DispatchTable* dispatchTable,
+                            vkh::PipelineCache* pipelineCache) {
+  m_dispatchTable = dispatchTable;
+  m_pipelineCache = pipelineCache;
+}
+
+void PipelineRegistry::Cleanup() {
+  MergeWorkerCaches();
+  std::lock_guard lock(m_mutex);
+  for (const auto& [key, handle] : m_pipelines) {
+    if (VkPipeline pipeline = handle.Get(); pipeline != VK_NULL_HANDLE) {
+      m_dispatchTable->destroyPipeline(pipeline, nullptr);
+    }
+  }
+  m_pipelines.clear();
+}
+
+std::string PipelineRegistry::MakeKey(const vkh::PipelineBuilder& builder, VkRenderPass pass) {
+  // only the fields that end up in VkGraphicsPipelineCreateInfo, the Vulkan structs appended
+  // whole are plain 32 bit members without padding
+  std::string key;
+  key.reserve(512);
+  Append(key, static_cast<uint32_t>(builder.m_shaderStages.size()));
+  for (const auto& stage : builder.m_shaderStages) {
+    Append(key, stage.flags);
+    Append(key, stage.stage);
+    Append(key, stage.module);
+    key.append(stage.pName);
+    key.push_back('\0');
+  }
+
+  const auto& vertexInput = builder.m_vertexInputInfo;
+  Append(key, vertexInput.pVertexBindingDescriptions, vertexInput.vertexBindingDescriptionCount);
+  Append(key, vertexInput.pVertexAttributeDescriptions,
+         vertexInput.vertexAttributeDescriptionCount);
+
+  Append(key, builder.m_inputAssembly.topology);
+  Append(key, builder.m_inputAssembly.primitiveRestartEnable);
+
+  Append(key, builder.m_viewport);
+  Append(key, builder.m_scissor);
+
+  const auto& rasterizer = builder.m_rasterizer;
+  Append(key, rasterizer.depthClampEnable);
+  Append(key, rasterizer.rasterizerDiscardEnable);
+  Append(key, rasterizer.polygonMode);
+  Append(key, rasterizer.cullMode);
+  Append(key, rasterizer.frontFace);
+  Append(key, rasterizer.depthBiasEnable);
+  Append(key, rasterizer.depthBiasConstantFactor);
+  Append(key, rasterizer.depthBiasClamp);
+  Append(key, rasterizer.depthBiasSlopeFactor);
+  Append(key, rasterizer.lineWidth);
+
+  Append(key, builder.m_colorBlendAttachment);
+
+  const auto& multisampling = builder.m_multisampling;
+  Append(key, multisampling.rasterizationSamples);
+  Append(key, multisampling.sampleShadingEnable);
+  Append(key, multisampling.minSampleShading);
+  Append(key, multisampling.alphaToCoverageEnable);
+  Append(key, multisampling.alphaToOneEnable);
+
+  const auto& depthStencil = builder.m_depthStencil;
+  Append(key, depthStencil.depthTestEnable);
+  Append(key, depthStencil.depthWriteEnable);
+  Append(key, depthStencil.depthCompareOp);
+  Append(key, depthStencil.depthBoundsTestEnable);
+  Append(key, depthStencil.stencilTestEnable);
+  Append(key, depthStencil.front);
+  Append(key, depthStencil.back);
+  Append(key, depthStencil.minDepthBounds);
+  Append(key, depthStencil.maxDepthBounds);
+
+  Append(key, builder.m_pipelineLayout);
+  Append(key, pass);
+  return key;
+}
+
+PipelineHandle PipelineRegistry::Request(const vkh::PipelineBuilder& builder, VkRenderPass pass) {
+  auto key = MakeKey(builder, pass);
+
+  std::unique_lock lock(m_mutex);
+  if (auto it = m_pipelines.find(key); it != m_pipelines.end()) {
+    m_numDeduplicated++;
+    return it->second;
+  }
+
+  auto job  = std::make_shared<CompileJob>(builder);
+  job->pass = pass;
+  PipelineHandle handle{job->promise.get_future().share()};
+  m_pipelines.emplace(std::move(key), handle);
+  lock.unlock();
+
+  m_pending.Add();
+  util::JobSystem::Get().Submit([this, job] {
+    VkPipeline pipeline = job->builder.Build(m_dispatchTable->device, job->pass, GetWorkerCache());
+    job->promise.set_value(pipeline);
+    m_pending.Decrement();
+  });
+  return handle;
+}
+
+VkPipelineCache PipelineRegistry::GetWorkerCache() {
+  // one cache per compiling thread, they don't contend on the main cache
+  std::lock_guard lock(m_mutex);
+  auto& cache = m_workerCaches[std::this_thread::get_id()];
+  if (cache == VK_NULL_HANDLE) {
+    cache = m_pipelineCache->CreateWorkerCache();
+  }
+  return cache;
+}
+
+void PipelineRegistry::WaitIdle() {
+  m_pending.Wait();
+}
+
+void PipelineRegistry::MergeWorkerCaches() {
+  WaitIdle();
+  std::lock_guard lock(m_mutex);
+  m_workerCaches.clear();
+  m_pipelineCache->MergeWorkerCaches();
+}
+
+uint32_t PipelineRegistry::GetNumPipelines() const {
+  std::lock_guard lock(m_mutex);
+  return static_cast<uint32_t>(m_pipelines.size());
+}
+
+uint32_t PipelineRegistry::GetNumDeduplicated() const {
+  std::lock_guard lock(m_mutex);
+  return m_numDeduplicated;
+}
+}  // namespace ezg
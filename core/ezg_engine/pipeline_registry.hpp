@@ -0,0 +1,80 @@
+#ifndef PIPELINE_REGISTRY_HPP
+#define PIPELINE_REGISTRY_HPP
+#include <vulkan/vulkan.h>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "ezg_util/job_system.hpp"
+#include "vulkan_helper/vk_dispatch.hpp"
+#include "vulkan_helper/vk_pipeline.hpp"
+#include "vulkan_helper/vk_pipeline_cache.hpp"
+
+namespace ezg {
+/// @brief A pipeline that may still be compiling, copies refer to the same pipeline.
+class PipelineHandle {
+public:
+  PipelineHandle() = default;
+
+  [[nodiscard]] bool IsValid() const { return m_future.valid(); }
+
+  /// @brief Non-blocking, true once the pipeline is compiled (or failed to).
+  [[nodiscard]] bool IsReady() const;
+
+  /// @brief Wait for the compilation, the calling thread runs queued jobs meanwhile.
+  /// VK_NULL_HANDLE if the pipeline failed to compile.
+  VkPipeline Get() const;
+
+private:
+  friend class PipelineRegistry;
+  explicit PipelineHandle(std::shared_future<VkPipeline> future) : m_future(std::move(future)) {}
+
+  std::shared_future<VkPipeline> m_future;
+};
+
+/// @brief Owns the graphics pipelines and hands out one pipeline per distinct state.
+///
+/// The key covers the shader stages, vertex input, input assembly, viewport, rasterizer, blend,
+/// multisample and depth stencil state, the layout and the render pass. pNext chains and
+/// specialization constants are not part of it and must be null. A state requested before
+/// returns the existing handle, a new one is compiled on the job system with a pipeline cache
+/// per thread, merged into the main cache by MergeWorkerCaches / Cleanup.
+class PipelineRegistry {
+public:
+  void Init(const vkh::DispatchTable* dispatchTable, vkh::PipelineCache* pipelineCache);
+
+  /// @brief Wait for pending compilations, destroy all pipelines and merge the worker caches.
+  void Cleanup();
+
+  /// @brief The builder state is copied, its shader modules and layout must stay alive until the
+  /// handle is ready.
+  PipelineHandle Request(const vkh::PipelineBuilder& builder, VkRenderPass pass);
+
+  /// @brief Block until every requested pipeline is compiled.
+  void WaitIdle();
+
+  /// @brief Waits for pending compilations, don't call it while other threads request pipelines.
+  void MergeWorkerCaches();
+
+  [[nodiscard]] uint32_t GetNumPipelines() const;
+  /// @brief Requests answered with an existing pipeline.
+  [[nodiscard]] uint32_t GetNumDeduplicated() const;
+
+private:
+  static std::string MakeKey(const vkh::PipelineBuilder& builder, VkRenderPass pass);
+  VkPipelineCache GetWorkerCache();
+
+  const vkh::DispatchTable* m_dispatchTable{nullptr};
+  vkh::PipelineCache* m_pipelineCache{nullptr};
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<std::string, PipelineHandle> m_pipelines;
+  std::unordered_map<std::thread::id, VkPipelineCache> m_workerCaches;
+  uint32_t m_numDeduplicated{0};
+
+  util::JobCounter m_pending;
+};
+}  // namespace ezg
+#endif  //PIPELINE_REGISTRY_HPP
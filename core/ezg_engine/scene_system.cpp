@@ -1,4 +1,6 @@
 #include "scene_system.hpp"
+#include <algorithm>
+#include <atomic>
 #include <glm/ext/matrix_transform.hpp>
 #include "engine.hpp"
 #include "mesh.hpp"
@@ -34,19 +36,84 @@ void SceneSystem::Init() {}
 //
 //}
 
-void SceneSystem::AddObject(SceneObjectInfo* info) {
-  SceneObject newObj;
-  newObj.transformMatrix = info->transformMatrix;
-  newObj.materialId      = GetMaterialId(info->material);
-  newObj.meshId          = GetMeshId(info->mesh);
-  m_sceneObjs.push_back(newObj);
+ID_TYPE SceneSystem::AddObject(SceneObjectInfo* info) {
+  const ID_TYPE id = m_freeSlots.empty() ? static_cast<ID_TYPE>(m_sceneObjs.size())
+                                         : m_freeSlots.back();
+  AddObjectBatch(info, 1);
+  return id;
 }
 
 void SceneSystem::AddObjectBatch(SceneObjectInfo* first, uint32_t count) {
-  m_sceneObjs.reserve(count);
+  std::vector<ID_TYPE> newIds(count);
   for (uint32_t i = 0; i < count; i++) {
-    AddObject(&first[i]);
+    SceneObject newObj;
+    newObj.transformMatrix = first[i].transformMatrix;
+    newObj.materialId      = GetMaterialId(first[i].material);
+    newObj.meshId          = GetMeshId(first[i].mesh);
+    if (!m_freeSlots.empty()) {
+      newIds[i] = m_freeSlots.back();
+      m_freeSlots.pop_back();
+      m_sceneObjs[newIds[i]] = newObj;
+    } else {
+      newIds[i] = static_cast<ID_TYPE>(m_sceneObjs.size());
+      m_sceneObjs.push_back(newObj);
+    }
+  }
+  m_dirtyBits.resize((m_sceneObjs.size() + 63) / 64, 0);
+  for (ID_TYPE id : newIds) {
+    MarkDirty(id);
   }
+
+  // only the new ids are sorted, then merged with the sorted ones. Both steps are stable,
+  // objects with equal keys keep the order they were added in
+  const auto numSorted = static_cast<std::ptrdiff_t>(m_drawOrder.size());
+  m_drawOrder.insert(m_drawOrder.end(), newIds.begin(), newIds.end());
+  auto byDrawKey = [this](ID_TYPE a, ID_TYPE b) { return GetDrawKey(a) < GetDrawKey(b); };
+  std::stable_sort(m_drawOrder.begin() + numSorted, m_drawOrder.end(), byDrawKey);
+  std::inplace_merge(m_drawOrder.begin(), m_drawOrder.begin() + numSorted, m_drawOrder.end(),
+                     byDrawKey);
+  m_drawOrderVersion++;
+}
+
+void SceneSystem::RemoveObject(ID_TYPE objectId) {
+  if (objectId >= m_sceneObjs.size() || !m_sceneObjs[objectId].alive) {
+    return;
+  }
+  // the objects with the same key are one sorted run, the id is somewhere in it
+  auto byDrawKey = [this](ID_TYPE a, ID_TYPE b) { return GetDrawKey(a) < GetDrawKey(b); };
+
+  const auto [lo, hi] =
+      std::equal_range(m_drawOrder.begin(), m_drawOrder.end(), objectId, byDrawKey);
+  m_drawOrder.erase(std::find(lo, hi, objectId));
+  m_drawOrderVersion++;
+
+  m_sceneObjs[objectId].alive = false;
+  m_freeSlots.push_back(objectId);
+}
+
+void SceneSystem::SetTransform(ID_TYPE objectId, const glm::mat4& transformMatrix) {
+  m_sceneObjs[objectId].transformMatrix = transformMatrix;
+  MarkDirty(objectId);
+}
+
+void SceneSystem::MarkDirty(ID_TYPE objectId) {
+  std::atomic_ref<uint64_t>(m_dirtyBits[objectId / 64])
+      .fetch_or(uint64_t{1} << (objectId % 64), std::memory_order_relaxed);
+}
+
+void SceneSystem::CollectDirty(std::vector<uint64_t>& dirtyBits) {
+  dirtyBits.resize(m_dirtyBits.size(), 0);
+  for (size_t i = 0; i < m_dirtyBits.size(); i++) {
+    dirtyBits[i] |= m_dirtyBits[i];
+    m_dirtyBits[i] = 0;
+  }
+}
+
+uint64_t SceneSystem::GetDrawKey(ID_TYPE objectId) const {
+  // a draw group needs one material and index type, a batch additionally one mesh
+  const auto& object    = m_sceneObjs[objectId];
+  const uint64_t wide32 = m_meshes[object.meshId]->m_indexType == VK_INDEX_TYPE_UINT32;
+  return (static_cast<uint64_t>(object.materialId) << 33) | (wide32 << 32) | object.meshId;
 }
 
 ID_TYPE SceneSystem::GetMeshId(Mesh* mesh) {
@@ -21,21 +21,54 @@ struct SceneObject {
   ID_TYPE meshId{};
   ID_TYPE materialId{};
   glm::mat4 transformMatrix{1.0f};
+  // false for removed objects until their slot is reused
+  bool alive{true};
 };
 class SceneSystem {
 public:
   friend class EGEngine;
   void Init();
 
-  void AddObject(SceneObjectInfo* info);
+  /// @brief Returns the object id, the slot of a removed object is reused when there is one.
+  ID_TYPE AddObject(SceneObjectInfo* info);
 
   void AddObjectBatch(SceneObjectInfo* first, uint32_t count);
 
+  void RemoveObject(ID_TYPE objectId);
+
+  /// @brief Safe to call from several threads at once for different objects.
+  void SetTransform(ID_TYPE objectId, const glm::mat4& transformMatrix);
+
+  /// @brief OR the objects added or moved since the last call into dirtyBits, one bit per slot,
+  /// and clear them. dirtyBits grows to cover every slot.
+  void CollectDirty(std::vector<uint64_t>& dirtyBits);
+
+  /// @brief Live and removed objects, indexed by object id.
+  [[nodiscard]] const std::vector<SceneObject>& GetObjects() const { return m_sceneObjs; }
+  [[nodiscard]] Mesh* GetMesh(ID_TYPE meshId) const { return m_meshes[meshId]; }
+  [[nodiscard]] Material* GetMaterial(ID_TYPE materialId) const { return m_materials[materialId]; }
+
+  /// @brief Live and removed objects, ids are below this.
+  [[nodiscard]] uint32_t GetNumSlots() const { return static_cast<uint32_t>(m_sceneObjs.size()); }
+
+  /// @brief Object ids sorted by material, index type and mesh, so objects that can share an
+  /// instanced draw are adjacent. Added objects are merged in, the scene is never re-sorted.
+  [[nodiscard]] const std::vector<ID_TYPE>& GetDrawOrder() const { return m_drawOrder; }
+  /// @brief Changes whenever GetDrawOrder() does.
+  [[nodiscard]] uint32_t GetDrawOrderVersion() const { return m_drawOrderVersion; }
+
 private:
   ID_TYPE GetMeshId(Mesh* mesh);
   ID_TYPE GetMaterialId(Material* material);
+  [[nodiscard]] uint64_t GetDrawKey(ID_TYPE objectId) const;
+  void MarkDirty(ID_TYPE objectId);
 
   std::vector<SceneObject> m_sceneObjs;
+  std::vector<ID_TYPE> m_freeSlots;
+  // one bit per slot, set atomically, SetTransform runs on the workers
+  std::vector<uint64_t> m_dirtyBits;
+  std::vector<ID_TYPE> m_drawOrder;
+  uint32_t m_drawOrderVersion{0};
 
   std::vector<Mesh*> m_meshes;
   std::vector<Material*> m_materials;
@@ -6,9 +6,10 @@
 
 namespace ezg {
 
-bool LoadImageFromFile(EGEngine& engine, const char* file, AllocatedImage& outImage);
+bool LoadImageFromFile(EGEngine& engine, const char* file, AllocatedImage& outImage,
+                       UploadTicket& outTicket);
 
 AllocatedImage UploadImage(int texWidth, int texHeight, VkFormat image_format, EGEngine& engine,
-                           AllocatedBuffer& stagingBuffer);
+                           const void* pixels, UploadTicket& outTicket);
 }  // namespace ezg
 #endif  //TEXTURE_HPP
@@ -3,15 +3,20 @@
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
+#include <vector>
 #include "vulkan_helper/vk_descriptors.hpp"
 
 namespace ezg {
 using ID_TYPE = uint32_t;
+// timeline value of an UploadManager batch, 0 is always complete
+using UploadTicket = uint64_t;
 
 struct AllocatedBuffer {
   VkBuffer m_buffer{};
   VmaAllocation m_allocation{};
   VkDeviceSize m_size{0};
+  // set for buffers created with VMA_ALLOCATION_CREATE_MAPPED_BIT, mapped until destroyed
+  void* m_mapped{nullptr};
 
   VkDescriptorBufferInfo GetDescriptorBufferInfo(VkDeviceSize offset = 0) const;
 };
@@ -42,12 +47,34 @@ struct FrameData {
   VkFence renderFence;
   VkCommandPool cmdPool;
   VkCommandBuffer cmdBuffer;
+  // one per recording thread, reset every frame
+  std::vector<VkCommandPool> secondaryPools;
+  std::vector<VkCommandBuffer> secondaryCmdBuffers;
 
   AllocatedBuffer cameraBuffer;
   VkDescriptorSet globalDescriptor;
 
   AllocatedBuffer objectBuffer;
   VkDescriptorSet objectDescriptor;
+  // one bit per scene object slot whose data in objectBuffer is out of date
+  std::vector<uint64_t> dirtyObjects;
+
+  // GPU culling input, rewritten when the batches changed since this frame last used them
+  AllocatedBuffer cullObjectBuffer;
+  AllocatedBuffer drawBatchBuffer;
+  uint32_t batchVersion{0};
+  // one command per batch, the cull pass counts the visible instances into it
+  AllocatedBuffer drawCommandBuffer;
+  // the non empty commands packed per draw group, and their number per group
+  AllocatedBuffer compactDrawBuffer;
+  AllocatedBuffer drawCountBuffer;
+  // object index of every drawn instance
+  AllocatedBuffer visibleInstanceBuffer;
+  VkDescriptorSet cullDescriptor;
+
+  // cull start, cull end, draw end
+  VkQueryPool timestampPool{VK_NULL_HANDLE};
+  bool timestampsWritten{false};
 
   vkh::DescriptorAllocator* descriptorAllocator;
 };
@@ -68,16 +95,56 @@ struct GPUSceneData {
 
 struct GPUObjectData {
   glm::mat4 modelMatrix;
+  // index into the material buffer of MaterialSystem
+  uint32_t materialIndex;
+  uint32_t pad0;
+  uint32_t pad1;
+  uint32_t pad2;
 };
 
-struct UploadContext {
-  VkFence uploadFence;
-  VkCommandPool cmdPool;
+// bindless texture index of materials without a texture
+constexpr uint32_t NoTexture = UINT32_MAX;
+
+// std430, matches the material buffer of shaders/default_lit.frag and shaders/textured_lit.frag
+struct GPUMaterialData {
+  glm::vec4 baseColor{1.0f};
+  // element of the bindless texture array, NoTexture for untextured materials
+  uint32_t albedoTexture{NoTexture};
+  uint32_t pad0{0};
+  uint32_t pad1{0};
+  uint32_t pad2{0};
+};
+
+// objects with the same mesh and material, drawn by one indirect command. std430, matches
+// shaders/cull.comp
+struct GPUDrawBatch {
+  // model space bounding sphere of the mesh
+  glm::vec4 boundingSphere;
+  uint32_t indexCount;
+  uint32_t firstIndex;
+  int32_t vertexOffset;
+  // the batch instances are written to visible instances [firstInstance, firstInstance + count)
+  uint32_t firstInstance;
+  uint32_t drawGroup;
+  // where the compacted commands of the draw group start
+  uint32_t groupFirstDraw;
+  uint32_t pad0;
+  uint32_t pad1;
+};
+
+struct GPUCullConstants {
+  // xyz normal pointing inside, w distance
+  glm::vec4 frustumPlanes[6];
+  uint32_t objectCount;
+  uint32_t batchCount;
 };
 
 struct Texture {
   AllocatedImage image;
   VkImageView imageView;
+  UploadTicket uploadTicket{0};
+  // element of the bindless texture array
+  uint32_t bindlessIndex{NoTexture};
 };
 
 }  // namespace ezg
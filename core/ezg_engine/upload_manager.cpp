@@ -0,0 +1,363 @@
+#include "upload_manager.hpp"
+#include <algorithm>
+#include <cstring>
+#include "ezg_util/profiler.hpp"
+#include "vulkan_helper/vk_init.hpp"
+#include "vulkan_helper/vk_tools.hpp"
+
+namespace ezg {
+// staging offsets stay aligned for buffer-to-image copies of any common texel size
+constexpr VkDeviceSize StagingAlignment = 16;
+
+static AllocatedBuffer CreateStagingBuffer(VmaAllocator allocator, VkDeviceSize size,
+                                           void** mapped) {
+  VkBufferCreateInfo bufferInfo{};
+  bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size  = size;
+  bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+  VmaAllocationCreateInfo vmaAllocInfo{};
+  vmaAllocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+  vmaAllocInfo.flags =
+      VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+  AllocatedBuffer buffer{};
+  VmaAllocationInfo allocationInfo{};
+  vkh::VkCheck(vmaCreateBuffer(allocator, &bufferInfo, &vmaAllocInfo, &buffer.m_buffer,
+                               &buffer.m_allocation, &allocationInfo),
+               "create staging buffer");
+  buffer.m_size = size;
+  *mapped       = allocationInfo.pMappedData;
+  return buffer;
+}
+
+void UploadManager::Init(const vkh::DispatchTable* dispatchTable, VmaAllocator allocator,
+                         const UploadQueues& queues, VkDeviceSize stagingSize) {
+  m_dispatchTable = dispatchTable;
+  m_allocator     = allocator;
+  m_queues        = queues;
+
+  VkCommandPoolCreateInfo transferPoolInfo = vkh::init::CommandPoolCreateInfo(
+      m_queues.transferFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+  vkh::VkCheck(m_dispatchTable->createCommandPool(&transferPoolInfo, nullptr, &m_transferPool),
+               "create upload transfer command pool");
+
+  VkSemaphoreTypeCreateInfoKHR timelineInfo{};
+  timelineInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+  timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+  timelineInfo.initialValue  = 0;
+  VkSemaphoreCreateInfo semaphoreInfo = vkh::init::SemaphoreCreateInfo(0);
+  semaphoreInfo.pNext                 = &timelineInfo;
+  vkh::VkCheck(m_dispatchTable->createSemaphore(&semaphoreInfo, nullptr, &m_readyTimeline),
+               "create upload timeline semaphore");
+
+  if (NeedsOwnershipTransfer()) {
+    VkCommandPoolCreateInfo graphicsPoolInfo = vkh::init::CommandPoolCreateInfo(
+        m_queues.graphicsFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    vkh::VkCheck(m_dispatchTable->createCommandPool(&graphicsPoolInfo, nullptr, &m_graphicsPool),
+                 "create upload acquire command pool");
+    vkh::VkCheck(m_dispatchTable->createSemaphore(&semaphoreInfo, nullptr, &m_transferTimeline),
+                 "create transfer timeline semaphore");
+  }
+
+  m_staging = CreateStagingBuffer(m_allocator, stagingSize, &m_stagingMapped);
+}
+
+void UploadManager::Cleanup() {
+  // the device is idle, nothing in flight can still read the staging memory
+  const auto destroyBatch = [this](UploadBatch& batch) {
+    for (const auto& buffer : batch.dedicatedStaging) {
+      vmaDestroyBuffer(m_allocator, buffer.m_buffer, buffer.m_allocation);
+    }
+    batch.dedicatedStaging.clear();
+  };
+  if (m_batchOpen) {
+    destroyBatch(m_openBatch);
+    m_batchOpen = false;
+  }
+  for (auto& batch : m_inFlight) {
+    destroyBatch(batch);
+  }
+  m_inFlight.clear();
+  m_freeBatches.clear();
+
+  vmaDestroyBuffer(m_allocator, m_staging.m_buffer, m_staging.m_allocation);
+  m_dispatchTable->destroySemaphore(m_readyTimeline, nullptr);
+  m_dispatchTable->destroyCommandPool(m_transferPool, nullptr);
+  if (NeedsOwnershipTransfer()) {
+    m_dispatchTable->destroySemaphore(m_transferTimeline, nullptr);
+    m_dispatchTable->destroyCommandPool(m_graphicsPool, nullptr);
+  }
+}
+
+UploadManager::StagingRegion UploadManager::AllocateStaging(VkDeviceSize size) {
+  const auto capacity = m_staging.m_size;
+  size                = (size + StagingAlignment - 1) & ~(StagingAlignment - 1);
+  if (size > capacity) {
+    void* mapped;
+    const auto buffer = CreateStagingBuffer(m_allocator, size, &mapped);
+    GetOpenBatch().dedicatedStaging.push_back(buffer);
+    return {buffer.m_buffer, buffer.m_allocation, 0, mapped};
+  }
+  while (true) {
+    if (m_stagingHead == m_stagingTail) {
+      // empty ring, start at the beginning so a region never has to wrap
+      m_stagingHead = (m_stagingHead + capacity - 1) / capacity * capacity;
+      m_stagingTail = m_stagingHead;
+    }
+    // a region doesn't wrap around the end of the buffer, skip the rest of it instead
+    const auto offset  = m_stagingHead % capacity;
+    const auto padding = offset + size > capacity ? capacity - offset : 0;
+    if (m_stagingHead + padding + size - m_stagingTail <= capacity) {
+      m_stagingHead += padding;
+      const auto regionOffset = m_stagingHead % capacity;
+      m_stagingHead += size;
+      return {m_staging.m_buffer, m_staging.m_allocation, regionOffset,
+              static_cast<char*>(m_stagingMapped) + regionOffset};
+    }
+    // the ring is full, submit what is recorded and wait for the oldest batch to free space
+    EZG_PROFILE_ZONE("Staging Ring Full");
+    Flush();
+    Wait(m_inFlight.front().ticket);
+  }
+}
+
+UploadManager::UploadBatch& UploadManager::GetOpenBatch() {
+  if (m_batchOpen) {
+    return m_openBatch;
+  }
+  if (!m_freeBatches.empty()) {
+    m_openBatch = std::move(m_freeBatches.back());
+    m_freeBatches.pop_back();
+  } else {
+    m_openBatch = {};
+    VkCommandBufferAllocateInfo transferCmdInfo =
+        vkh::init::CommandBufferAllocateInfo(m_transferPool, 1);
+    vkh::VkCheck(
+        m_dispatchTable->allocateCommandBuffers(&transferCmdInfo, &m_openBatch.transferCmd),
+        "allocate upload command buffer");
+    if (NeedsOwnershipTransfer()) {
+      VkCommandBufferAllocateInfo graphicsCmdInfo =
+          vkh::init::CommandBufferAllocateInfo(m_graphicsPool, 1);
+      vkh::VkCheck(
+          m_dispatchTable->allocateCommandBuffers(&graphicsCmdInfo, &m_openBatch.graphicsCmd),
+          "allocate upload acquire command buffer");
+    }
+  }
+  VkCommandBufferBeginInfo beginInfo =
+      vkh::init::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+  vkh::VkCheck(m_dispatchTable->beginCommandBuffer(m_openBatch.transferCmd, &beginInfo),
+               "begin upload command buffer");
+  if (NeedsOwnershipTransfer()) {
+    vkh::VkCheck(m_dispatchTable->beginCommandBuffer(m_openBatch.graphicsCmd, &beginInfo),
+                 "begin upload acquire command buffer");
+  }
+  m_openBatch.ticket = m_nextTicket;
+  m_batchOpen        = true;
+  return m_openBatch;
+}
+
+UploadTicket UploadManager::CopyToBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size,
+                                         VkPipelineStageFlags dstStage, VkAccessFlags dstAccess,
+                                         VkDeviceSize dstOffset) {
+  // may flush the open batch if the ring is full, so before recording into it
+  const auto staging = AllocateStaging(size);
+  memcpy(staging.mapped, data, size);
+  vmaFlushAllocation(m_allocator, staging.allocation, staging.offset, size);
+
+  auto& batch = GetOpenBatch();
+  VkBufferCopy copy{};
+  copy.srcOffset = staging.offset;
+  copy.dstOffset = dstOffset;
+  copy.size      = size;
+  m_dispatchTable->cmdCopyBuffer(batch.transferCmd, staging.buffer, dstBuffer, 1, &copy);
+
+  VkBufferMemoryBarrier barrier{};
+  barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask       = dstAccess;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.buffer              = dstBuffer;
+  barrier.offset              = dstOffset;
+  barrier.size                = size;
+  if (!NeedsOwnershipTransfer()) {
+    m_dispatchTable->cmdPipelineBarrier(batch.transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage,
+                                        0, 0, nullptr, 1, &barrier, 0, nullptr);
+    return batch.ticket;
+  }
+  barrier.srcQueueFamilyIndex = m_queues.transferFamily;
+  barrier.dstQueueFamilyIndex = m_queues.graphicsFamily;
+  // release on the transfer queue, its destination access is ignored
+  VkBufferMemoryBarrier release = barrier;
+  release.dstAccessMask         = 0;
+  m_dispatchTable->cmdPipelineBarrier(batch.transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1,
+                                      &release, 0, nullptr);
+  // matching acquire on the graphics queue, its source access is ignored
+  VkBufferMemoryBarrier acquire = barrier;
+  acquire.srcAccessMask         = 0;
+  m_dispatchTable->cmdPipelineBarrier(batch.graphicsCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      dstStage, 0, 0, nullptr, 1, &acquire, 0, nullptr);
+  return batch.ticket;
+}
+
+UploadTicket UploadManager::CopyToImage(VkImage dstImage, VkExtent3D extent, const void* data,
+                                        VkDeviceSize size) {
+  const auto staging = AllocateStaging(size);
+  memcpy(staging.mapped, data, size);
+  vmaFlushAllocation(m_allocator, staging.allocation, staging.offset, size);
+
+  auto& batch = GetOpenBatch();
+  VkImageSubresourceRange range;
+  range.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+  range.baseMipLevel   = 0;
+  range.levelCount     = 1;
+  range.baseArrayLayer = 0;
+  range.layerCount     = 1;
+
+  VkImageMemoryBarrier toTransfer{};
+  toTransfer.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  toTransfer.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+  toTransfer.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  toTransfer.srcAccessMask       = 0;
+  toTransfer.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+  toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  toTransfer.image               = dstImage;
+  toTransfer.subresourceRange    = range;
+  m_dispatchTable->cmdPipelineBarrier(batch.transferCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                                      &toTransfer);
+
+  VkBufferImageCopy copyRegion{};
+  copyRegion.bufferOffset                    = staging.offset;
+  copyRegion.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+  copyRegion.imageSubresource.mipLevel       = 0;
+  copyRegion.imageSubresource.baseArrayLayer = 0;
+  copyRegion.imageSubresource.layerCount     = 1;
+  copyRegion.imageExtent                     = extent;
+  m_dispatchTable->cmdCopyBufferToImage(batch.transferCmd, staging.buffer, dstImage,
+                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+  VkImageMemoryBarrier toReadable = toTransfer;
+  toReadable.oldLayout            = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  toReadable.newLayout            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  toReadable.srcAccessMask        = VK_ACCESS_TRANSFER_WRITE_BIT;
+  toReadable.dstAccessMask        = VK_ACCESS_SHADER_READ_BIT;
+  if (!NeedsOwnershipTransfer()) {
+    m_dispatchTable->cmdPipelineBarrier(batch.transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0,
+                                        nullptr, 1, &toReadable);
+    return batch.ticket;
+  }
+  // the layout transition is part of the release / acquire pair, both name the same layouts
+  toReadable.srcQueueFamilyIndex = m_queues.transferFamily;
+  toReadable.dstQueueFamilyIndex = m_queues.graphicsFamily;
+  VkImageMemoryBarrier release   = toReadable;
+  release.dstAccessMask          = 0;
+  m_dispatchTable->cmdPipelineBarrier(batch.transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0,
+                                      nullptr, 1, &release);
+  VkImageMemoryBarrier acquire = toReadable;
+  acquire.srcAccessMask        = 0;
+  m_dispatchTable->cmdPipelineBarrier(batch.graphicsCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0,
+                                      nullptr, 1, &acquire);
+  return batch.ticket;
+}
+
+void UploadManager::Flush() {
+  if (!m_batchOpen) {
+    return;
+  }
+  EZG_PROFILE_FUNCTION();
+  UploadBatch batch = std::move(m_openBatch);
+  m_batchOpen       = false;
+  batch.stagingEnd  = m_stagingHead;
+
+  const uint64_t ticket = batch.ticket;
+  vkh::VkCheck(m_dispatchTable->endCommandBuffer(batch.transferCmd), "end upload command buffer");
+  VkTimelineSemaphoreSubmitInfoKHR transferTimelineInfo{};
+  transferTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+  transferTimelineInfo.signalSemaphoreValueCount = 1;
+  transferTimelineInfo.pSignalSemaphoreValues    = &ticket;
+
+  VkSubmitInfo transferSubmit         = vkh::init::SubmitInfo(&batch.transferCmd);
+  transferSubmit.pNext                = &transferTimelineInfo;
+  transferSubmit.signalSemaphoreCount = 1;
+  transferSubmit.pSignalSemaphores =
+      NeedsOwnershipTransfer() ? &m_transferTimeline : &m_readyTimeline;
+  vkh::VkCheck(m_dispatchTable->queueSubmit(m_queues.transfer, 1, &transferSubmit, VK_NULL_HANDLE),
+               "submit to transfer queue");
+
+  if (NeedsOwnershipTransfer()) {
+    vkh::VkCheck(m_dispatchTable->endCommandBuffer(batch.graphicsCmd),
+                 "end upload acquire command buffer");
+    VkTimelineSemaphoreSubmitInfoKHR acquireTimelineInfo{};
+    acquireTimelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    acquireTimelineInfo.waitSemaphoreValueCount   = 1;
+    acquireTimelineInfo.pWaitSemaphoreValues      = &ticket;
+    acquireTimelineInfo.signalSemaphoreValueCount = 1;
+    acquireTimelineInfo.pSignalSemaphoreValues    = &ticket;
+
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    VkSubmitInfo acquireSubmit           = vkh::init::SubmitInfo(&batch.graphicsCmd);
+    acquireSubmit.pNext                  = &acquireTimelineInfo;
+    acquireSubmit.waitSemaphoreCount     = 1;
+    acquireSubmit.pWaitSemaphores        = &m_transferTimeline;
+    acquireSubmit.pWaitDstStageMask      = &waitStage;
+    acquireSubmit.signalSemaphoreCount   = 1;
+    acquireSubmit.pSignalSemaphores      = &m_readyTimeline;
+    vkh::VkCheck(
+        m_dispatchTable->queueSubmit(m_queues.graphics, 1, &acquireSubmit, VK_NULL_HANDLE),
+        "submit upload acquire to graphics queue");
+  }
+  m_nextTicket++;
+  m_inFlight.push_back(std::move(batch));
+}
+
+void UploadManager::Update() {
+  EZG_PROFILE_FUNCTION();
+  Flush();
+  if (m_inFlight.empty()) {
+    return;
+  }
+  uint64_t completed;
+  vkh::VkCheck(m_dispatchTable->getSemaphoreCounterValueKHR(m_readyTimeline, &completed),
+               "get upload timeline value");
+  Retire(completed);
+}
+
+void UploadManager::Wait(UploadTicket ticket) {
+  if (IsComplete(ticket)) {
+    return;
+  }
+  if (m_batchOpen && ticket >= m_openBatch.ticket) {
+    Flush();
+  }
+  EZG_PROFILE_FUNCTION();
+  VkSemaphoreWaitInfoKHR waitInfo{};
+  waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+  waitInfo.semaphoreCount = 1;
+  waitInfo.pSemaphores    = &m_readyTimeline;
+  waitInfo.pValues        = &ticket;
+  vkh::VkCheck(m_dispatchTable->waitSemaphoresKHR(&waitInfo, UINT64_MAX), "wait for upload");
+  Retire(ticket);
+}
+
+void UploadManager::Retire(uint64_t completed) {
+  m_completedTicket = std::max(m_completedTicket, completed);
+  while (!m_inFlight.empty() && m_inFlight.front().ticket <= m_completedTicket) {
+    auto& batch   = m_inFlight.front();
+    m_stagingTail = std::max(m_stagingTail, batch.stagingEnd);
+    for (const auto& buffer : batch.dedicatedStaging) {
+      vmaDestroyBuffer(m_allocator, buffer.m_buffer, buffer.m_allocation);
+    }
+    batch.dedicatedStaging.clear();
+    // command buffers are reset by the next begin, the pools allow it
+    m_freeBatches.push_back(std::move(batch));
+    m_inFlight.pop_front();
+  }
+}
+}  // namespace ezg
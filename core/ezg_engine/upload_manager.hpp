@@ -0,0 +1,109 @@
+#ifndef UPLOAD_MANAGER_HPP
+#define UPLOAD_MANAGER_HPP
+#include <vk_mem_alloc.h>
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <vector>
+
+#include "types.hpp"
+#include "vulkan_helper/vk_dispatch.hpp"
+
+namespace ezg {
+struct UploadQueues {
+  uint32_t transferFamily;
+  VkQueue transfer;
+  uint32_t graphicsFamily;
+  VkQueue graphics;
+};
+
+/// @brief Streams buffer and image data to the GPU without blocking the frame loop.
+///
+/// Data is copied into a persistently mapped staging ring right away, the copies of a frame are
+/// recorded into one command buffer and submitted together to the transfer queue by Flush /
+/// Update. When the transfer family differs from the graphics family the resources are released
+/// on the transfer queue and acquired on the graphics queue. Every copy returns a ticket, a value
+/// of a timeline semaphore, the resource may be used once IsComplete(ticket) is true.
+class UploadManager {
+public:
+  void Init(const vkh::DispatchTable* dispatchTable, VmaAllocator allocator,
+            const UploadQueues& queues, VkDeviceSize stagingSize = DefaultStagingSize);
+
+  void Cleanup();
+
+  /// @brief Copy size bytes into dstBuffer, dstStage / dstAccess describe the first use on the
+  /// graphics queue (e.g. vertex input / vertex attribute read).
+  UploadTicket CopyToBuffer(VkBuffer dstBuffer, const void* data, VkDeviceSize size,
+                            VkPipelineStageFlags dstStage, VkAccessFlags dstAccess,
+                            VkDeviceSize dstOffset = 0);
+
+  /// @brief Copy tightly packed pixels into mip 0 of a color image created in the undefined
+  /// layout, it ends up shader read only.
+  UploadTicket CopyToImage(VkImage dstImage, VkExtent3D extent, const void* data,
+                           VkDeviceSize size);
+
+  /// @brief Submit the copies recorded so far, does nothing if there are none.
+  void Flush();
+
+  /// @brief Flush and retire finished batches, call once per frame.
+  void Update();
+
+  /// @brief Non-blocking, as of the last Update / Wait.
+  [[nodiscard]] bool IsComplete(UploadTicket ticket) const { return ticket <= m_completedTicket; }
+
+  /// @brief Block until the ticket is complete, for loads that can't continue without the data.
+  void Wait(UploadTicket ticket);
+
+  static constexpr VkDeviceSize DefaultStagingSize = 64 * 1024 * 1024;
+
+private:
+  struct UploadBatch {
+    VkCommandBuffer transferCmd{VK_NULL_HANDLE};
+    VkCommandBuffer graphicsCmd{VK_NULL_HANDLE};
+    UploadTicket ticket{0};
+    // ring position up to which the staging memory is freed once the batch completed
+    uint64_t stagingEnd{0};
+    // uploads larger than the whole ring get their own staging buffer
+    std::vector<AllocatedBuffer> dedicatedStaging;
+  };
+
+  struct StagingRegion {
+    VkBuffer buffer;
+    VmaAllocation allocation;
+    VkDeviceSize offset;
+    void* mapped;
+  };
+
+  StagingRegion AllocateStaging(VkDeviceSize size);
+  UploadBatch& GetOpenBatch();
+  void Retire(uint64_t completed);
+  [[nodiscard]] bool NeedsOwnershipTransfer() const {
+    return m_queues.transferFamily != m_queues.graphicsFamily;
+  }
+
+  const vkh::DispatchTable* m_dispatchTable{nullptr};
+  VmaAllocator m_allocator{VK_NULL_HANDLE};
+  UploadQueues m_queues{};
+
+  VkCommandPool m_transferPool{VK_NULL_HANDLE};
+  VkCommandPool m_graphicsPool{VK_NULL_HANDLE};
+  // signaled by the copies on the transfer queue
+  VkSemaphore m_transferTimeline{VK_NULL_HANDLE};
+  // signaled once the graphics queue acquired the resources, tickets are values of this one
+  VkSemaphore m_readyTimeline{VK_NULL_HANDLE};
+
+  AllocatedBuffer m_staging;
+  void* m_stagingMapped{nullptr};
+  // monotonic ring positions, the offset in the buffer is position % size
+  uint64_t m_stagingHead{0};
+  uint64_t m_stagingTail{0};
+
+  bool m_batchOpen{false};
+  UploadBatch m_openBatch;
+  std::deque<UploadBatch> m_inFlight;
+  std::vector<UploadBatch> m_freeBatches;
+
+  UploadTicket m_nextTicket{1};
+  UploadTicket m_completedTicket{0};
+};
+}  // namespace ezg
+#endif  //UPLOAD_MANAGER_HPP
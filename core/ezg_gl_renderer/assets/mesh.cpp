@@ -4,10 +4,12 @@ namespace ezg::gl {
 Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
     : num_vertices(vertices.size()), num_indices(indices.size()) {
   setup(vertices, indices);
+  compute_bounds(vertices);
 }
 
 Mesh::Mesh(const std::vector<Vertex>& vertices) : num_vertices(vertices.size()), num_indices(0) {
   setup(vertices);
+  compute_bounds(vertices);
 }
 
 void Mesh::setup(const std::vector<Vertex>& vertices) {
@@ -38,4 +40,17 @@ void Mesh::setup(const std::vector<Vertex>& vertices, const std::vector<uint32_t
   vao->attach_index_buffer(ibo);
 }
 
+void Mesh::compute_bounds(const std::vector<Vertex>& vertices) {
+  if (vertices.empty()) {
+    return;
+  }
+  glm::vec3 bbx_min = vertices[0].position;
+  glm::vec3 bbx_max = vertices[0].position;
+  for (const auto& vertex : vertices) {
+    bbx_min = glm::min(bbx_min, vertex.position);
+    bbx_max = glm::max(bbx_max, vertex.position);
+  }
+  bounds = AABB(bbx_min, bbx_max);
+}
+
 }  // namespace ezg::gl
\ No newline at end of file
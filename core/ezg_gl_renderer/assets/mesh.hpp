@@ -5,6 +5,7 @@
 #include "glm/ext/matrix_float4x4.hpp"
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
+#include "aabb.hpp"
 #include "material.hpp"
 #include "graphics/vertex_array.hpp"
 
@@ -40,8 +41,11 @@ struct Mesh {
   Ref<VertexArray> vao;
   glm::mat4 model_matrix{1.0f};
   PBRMaterial material;
+  // object space bounds of the vertices, used for culling
+  AABB bounds{};
 
 private:
+  void compute_bounds(const std::vector<Vertex>& vertices);
   void setup(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
   void setup(const std::vector<Vertex>& vertices);
 
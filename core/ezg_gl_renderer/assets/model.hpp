@@ -23,6 +23,12 @@ public:
     m_meshes.push_back(mesh);
   }
 
+  void reserve_meshes(size_t count) { m_meshes.reserve(count); }
+
+  void set_mesh_matrix(size_t index, const glm::mat4& matrix) {
+    m_meshes[index].model_matrix = matrix;
+  }
+
   void set_aabb(const AABB& aabb) {
     m_aabb = aabb;
   }
@@ -1,7 +1,9 @@
 #include "skybox.hpp"
 #include "graphics/framebuffer.hpp"
 #include "managers/resource_manager.hpp"
+#include "renderer/memory_tracker.hpp"
 #include "renderer/render_api.hpp"
+#include "renderer/render_stats.hpp"
 
 namespace ezg::gl {
 const float CUBE_VERTICES[] = {
@@ -128,6 +130,7 @@ void Skybox::setup_cube_quads() {
 }
 
 Skybox::Skybox(const std::vector<std::string>& face_paths) {
+  MemoryOwnerScope owner{"Skybox"};
   m_type = SkyboxType::Cubemap;
   setup_shaders();
   setup_cube_quads();
@@ -136,6 +139,7 @@ Skybox::Skybox(const std::vector<std::string>& face_paths) {
 }
 
 Skybox::Skybox(const std::string& hdr_path, int resolution) : m_resolution(resolution) {
+  MemoryOwnerScope owner{"Skybox"};
   m_type = SkyboxType::Equirectangular;
   setup_shaders();
   setup_cube_quads();
@@ -269,7 +273,7 @@ void Skybox::unbind_prefilter_data() {
   glBindTextureUnit(5, 0);
 }
 
-void Skybox::draw(const Ref<system::Camera>& camera, bool blur) {
+void Skybox::draw(const glm::mat4& view, const glm::mat4& projection, bool blur) {
   auto& skybox_shader = m_shader_cache.at("skybox");
   skybox_shader->use();
   if (m_type == SkyboxType::Cubemap) {
@@ -278,14 +282,16 @@ void Skybox::draw(const Ref<system::Camera>& camera, bool blur) {
     blur ? m_env_fbo->bind_for_reading("prefilter_diffuse", 0)
          : m_env_fbo->bind_for_reading("base_color", 0);
   }
-  auto view = glm::mat4(glm::mat3(camera->get_view_matrix()));
-  skybox_shader->set_uniform("uProjView", camera->get_projection_matrix() * view);
+  // drop the translation, the skybox stays centered on the camera
+  const auto rotation = glm::mat4(glm::mat3(view));
+  skybox_shader->set_uniform("uProjView", projection * rotation);
   draw_cube();
 }
 
 void Skybox::draw_quad() {
   m_quad_vao->bind();
   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  RenderStats::count_draw(2);
   m_quad_vao->unbind();
 }
 
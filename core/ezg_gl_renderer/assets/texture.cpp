@@ -1,5 +1,7 @@
 #include "texture.hpp"
 #include "log.hpp"
+#include "renderer/memory_tracker.hpp"
+#include "renderer/render_stats.hpp"
 #include <stb_image.h>
 
 namespace ezg::gl {
@@ -13,6 +15,9 @@ Texture2D::Texture2D(const std::string& path) {
   spdlog::trace("Loading texture at path {}", path);
   data = stbi_load(path.c_str(), &width, &height, &channels, 0);
   if (data) {
+    auto& memory_tracker = MemoryTracker::GetInstance();
+    memory_tracker.track(MemoryCategory::HostImage, reinterpret_cast<uintptr_t>(data),
+                         static_cast<uint64_t>(width) * height * channels);
     m_width  = width;
     m_height = height;
     if (channels == 4) {
@@ -24,6 +29,9 @@ Texture2D::Texture2D(const std::string& path) {
     }
     glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
     glTextureStorage2D(m_id, 1, m_internal_format, m_width, m_height);
+    RenderStats::count_texture_created();
+    memory_tracker.track(MemoryCategory::Texture, m_id,
+                         MemoryTracker::calc_texture_bytes(m_internal_format, m_width, m_height));
 
     glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -33,6 +41,7 @@ Texture2D::Texture2D(const std::string& path) {
     glTextureSubImage2D(m_id, 0, 0, 0, m_width, m_height, m_data_format, GL_UNSIGNED_BYTE, data);
     //    glGenerateTextureMipmap(m_id);
 
+    memory_tracker.untrack(MemoryCategory::HostImage, reinterpret_cast<uintptr_t>(data));
     stbi_image_free(data);
   } else {
     spdlog::error("Failed to load texture {}", path);
@@ -47,6 +56,10 @@ Texture2D::Texture2D(const TextureInfo& info, const void* data) {
 
   glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
   glTextureStorage2D(m_id, 1, m_internal_format, m_width, m_height);
+  RenderStats::count_texture_created();
+  MemoryTracker::GetInstance().track(
+      MemoryCategory::Texture, m_id,
+      MemoryTracker::calc_texture_bytes(m_internal_format, m_width, m_height));
 
   glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, info.wrap_s);
   glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, info.wrap_t);
@@ -64,6 +77,7 @@ Texture2D::Texture2D(const TextureInfo& info, const void* data) {
 }
 
 Ref<Texture2D> Texture2D::CreateDefaultWhite() {
+  MemoryOwnerScope owner{"DefaultWhite"};
   return std::make_shared<Texture2D>("../resources/textures/white.png");
 }
 
@@ -73,11 +87,13 @@ Texture2D::~Texture2D() {
     m_handle = 0;
   }
   if (m_id != 0) {
+    MemoryTracker::GetInstance().untrack(MemoryCategory::Texture, m_id);
     glDeleteTextures(1, &m_id);
   }
 }
 void Texture2D::bind(GLenum slot) const {
   glBindTextureUnit(slot, m_id);
+  RenderStats::count_texture_bind();
 }
 
 Ref<TextureCubeMap> TextureCubeMap::Create(const TextureInfo& info, std::array<unsigned char*, 6> face_data) {
@@ -86,10 +102,14 @@ Ref<TextureCubeMap> TextureCubeMap::Create(const TextureInfo& info, std::array<u
 
 TextureCubeMap::TextureCubeMap(const TextureInfo& info, const std::array<unsigned char*, 6>& face_data) {
   glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_id);
+  RenderStats::count_texture_created();
   glTextureStorage2D(m_id,
                      1,                     // one level, no mipmaps
                      info.internal_format,  // internal format
                      info.width, info.height);
+  MemoryTracker::GetInstance().track(
+      MemoryCategory::Cubemap, m_id,
+      MemoryTracker::calc_texture_bytes(info.internal_format, info.width, info.height, 1, 6));
 
   glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, info.wrap_s);
   glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, info.wrap_t);
@@ -120,10 +140,12 @@ TextureCubeMap::TextureCubeMap(const TextureInfo& info, const std::array<unsigne
 
 void TextureCubeMap::bind(GLenum slot) const {
   glBindTextureUnit(slot, m_id);
+  RenderStats::count_texture_bind();
 }
 
 TextureCubeMap::~TextureCubeMap() {
   if (m_id != 0) {
+    MemoryTracker::GetInstance().untrack(MemoryCategory::Cubemap, m_id);
     glDeleteTextures(1, &m_id);
   }
 }
@@ -0,0 +1,198 @@
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <glm/glm.hpp>
+#include "log.hpp"
+
+namespace ezg::gl {
+// histogram bucket upper bounds in ms, fixed so runs of different builds line up
+static constexpr std::array<float, 13> HistogramBounds = {
+    1.0f, 2.0f, 4.0f, 8.0f, 12.0f, 16.7f, 25.0f, 33.3f, 50.0f, 100.0f, 250.0f, 500.0f, 1000.0f};
+
+static void write_json_string(std::ofstream& file, const std::string& str) {
+  file << '"';
+  for (const char c : str) {
+    if (c == '"' || c == '\\') {
+      file << '\\' << c;
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      file << c;
+    }
+  }
+  file << '"';
+}
+
+static void write_summary(std::ofstream& file, const FrameTimeSummary& summary) {
+  file << "{\"frames\":" << summary.count << ",\"mean_ms\":" << summary.mean_ms
+       << ",\"p50_ms\":" << summary.p50_ms << ",\"p95_ms\":" << summary.p95_ms
+       << ",\"p99_ms\":" << summary.p99_ms << ",\"max_ms\":" << summary.max_ms << "}";
+}
+
+static void write_histogram(std::ofstream& file, const std::vector<float>& times) {
+  std::array<uint32_t, HistogramBounds.size() + 1> counts{};
+  for (const auto ms : times) {
+    const auto it = std::lower_bound(HistogramBounds.begin(), HistogramBounds.end(), ms);
+    counts[std::distance(HistogramBounds.begin(), it)]++;
+  }
+  file << "[";
+  for (size_t i = 0; i < counts.size(); i++) {
+    file << (i == 0 ? "" : ",") << "{\"le_ms\":";
+    if (i < HistogramBounds.size()) {
+      file << HistogramBounds[i];
+    } else {
+      file << "null";
+    }
+    file << ",\"count\":" << counts[i] << "}";
+  }
+  file << "]";
+}
+
+static void write_values(std::ofstream& file, const std::vector<float>& times) {
+  file << "[";
+  for (size_t i = 0; i < times.size(); i++) {
+    file << (i == 0 ? "" : ",") << times[i];
+  }
+  file << "]";
+}
+
+system::CameraPose CameraPath::sample(float time) const {
+  if (m_keys.empty()) {
+    return {};
+  }
+  if (time <= m_keys.front().time) {
+    return m_keys.front().pose;
+  }
+  if (time >= m_keys.back().time) {
+    return m_keys.back().pose;
+  }
+  const auto next = std::upper_bound(m_keys.begin(), m_keys.end(), time,
+                                     [](float t, const CameraKey& key) { return t < key.time; });
+  const auto& b   = *next;
+  const auto& a   = *(next - 1);
+  const auto span = b.time - a.time;
+  const float t   = span > 0.0f ? (time - a.time) / span : 1.0f;
+  // yaw wraps around, interpolate along the shorter arc
+  const float yaw_delta = std::fmod(b.pose.yaw - a.pose.yaw + 540.0f, 360.0f) - 180.0f;
+
+  system::CameraPose pose{};
+  pose.position = glm::mix(a.pose.position, b.pose.position, t);
+  pose.yaw      = a.pose.yaw + yaw_delta * t;
+  pose.pitch    = glm::mix(a.pose.pitch, b.pose.pitch, t);
+  return pose;
+}
+
+bool CameraPath::save(const std::string& path) const {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    spd::error("Failed to open {} for writing the camera path", path);
+    return false;
+  }
+  file.precision(9);
+  for (const auto& key : m_keys) {
+    file << key.time << " " << key.pose.position.x << " " << key.pose.position.y << " "
+         << key.pose.position.z << " " << key.pose.yaw << " " << key.pose.pitch << "\n";
+  }
+  spd::info("Camera path with {} keys written to {}", m_keys.size(), path);
+  return true;
+}
+
+bool CameraPath::load(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    spd::error("Failed to open camera path {}", path);
+    return false;
+  }
+  m_keys.clear();
+  CameraKey key{};
+  while (file >> key.time >> key.pose.position.x >> key.pose.position.y >> key.pose.position.z >>
+         key.pose.yaw >> key.pose.pitch) {
+    if (!m_keys.empty() && key.time < m_keys.back().time) {
+      spd::error("Camera path {} is not sorted by time", path);
+      m_keys.clear();
+      return false;
+    }
+    m_keys.push_back(key);
+  }
+  spd::info("Loaded camera path {}: {} keys, {:.2f} s", path, m_keys.size(), get_duration());
+  return !m_keys.empty();
+}
+
+void FrameTimeRecorder::add_cpu_time(uint64_t frame_index, float ms) {
+  if (frame_index >= m_warmup_frames) {
+    m_cpu_ms.push_back(ms);
+  }
+}
+
+void FrameTimeRecorder::add_gpu_time(uint64_t frame_index, float ms) {
+  if (frame_index >= m_warmup_frames) {
+    m_gpu_ms.push_back(ms);
+  }
+}
+
+FrameTimeSummary FrameTimeRecorder::Summarize(std::vector<float> times) {
+  FrameTimeSummary summary{};
+  if (times.empty()) {
+    return summary;
+  }
+  std::sort(times.begin(), times.end());
+  // nearest rank percentile
+  const auto percentile = [&](float p) {
+    const auto rank = static_cast<size_t>(std::ceil(p * static_cast<float>(times.size())));
+    return times[std::clamp<size_t>(rank, 1, times.size()) - 1];
+  };
+  double sum = 0.0;
+  for (const auto ms : times) {
+    sum += ms;
+  }
+  summary.count   = static_cast<uint32_t>(times.size());
+  summary.mean_ms = static_cast<float>(sum / static_cast<double>(times.size()));
+  summary.p50_ms  = percentile(0.50f);
+  summary.p95_ms  = percentile(0.95f);
+  summary.p99_ms  = percentile(0.99f);
+  summary.max_ms  = times.back();
+  return summary;
+}
+
+bool FrameTimeRecorder::write_json(
+    const std::string& path,
+    const std::vector<std::pair<std::string, std::string>>& metadata) const {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    spd::error("Failed to open {} for writing benchmark results", path);
+    return false;
+  }
+  file.precision(4);
+  file << std::fixed;
+  file << "{\n\"metadata\":{";
+  for (size_t i = 0; i < metadata.size(); i++) {
+    file << (i == 0 ? "" : ",");
+    write_json_string(file, metadata[i].first);
+    file << ":";
+    write_json_string(file, metadata[i].second);
+  }
+  file << "},\n\"warmup_frames\":" << m_warmup_frames << ",\n\"cpu\":";
+  write_summary(file, get_cpu_summary());
+  file << ",\n\"gpu\":";
+  write_summary(file, get_gpu_summary());
+  file << ",\n\"cpu_histogram\":";
+  write_histogram(file, m_cpu_ms);
+  file << ",\n\"gpu_histogram\":";
+  write_histogram(file, m_gpu_ms);
+  file << ",\n\"cpu_frame_ms\":";
+  write_values(file, m_cpu_ms);
+  file << ",\n\"gpu_frame_ms\":";
+  write_values(file, m_gpu_ms);
+  file << "\n}\n";
+
+  const auto cpu = get_cpu_summary();
+  const auto gpu = get_gpu_summary();
+  spd::info("CPU frame: p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms", cpu.p50_ms,
+            cpu.p95_ms, cpu.p99_ms, cpu.max_ms);
+  spd::info("GPU frame: p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms", gpu.p50_ms,
+            gpu.p95_ms, gpu.p99_ms, gpu.max_ms);
+  spd::info("Benchmark results written to {}", path);
+  return true;
+}
+}  // namespace ezg::gl
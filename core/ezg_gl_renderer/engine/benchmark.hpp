@@ -0,0 +1,68 @@
+#ifndef EASYGRAPHICS_BENCHMARK_HPP
+#define EASYGRAPHICS_BENCHMARK_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "systems/camera_system.hpp"
+
+namespace ezg::gl {
+struct CameraKey {
+  float time{0.0f};
+  system::CameraPose pose{};
+};
+
+/// @brief Timed camera poses recorded from an interactive session and replayed by benchmarks.
+/// Stored as text, one "time x y z yaw pitch" line per key.
+class CameraPath {
+public:
+  void add(float time, const system::CameraPose& pose) { m_keys.push_back({time, pose}); }
+
+  /// @brief Pose at time, linearly interpolated between keys and clamped to the path ends.
+  [[nodiscard]] system::CameraPose sample(float time) const;
+
+  [[nodiscard]] float get_duration() const { return m_keys.empty() ? 0.0f : m_keys.back().time; }
+  [[nodiscard]] bool empty() const { return m_keys.empty(); }
+  [[nodiscard]] auto get_num_keys() const { return m_keys.size(); }
+
+  bool save(const std::string& path) const;
+  bool load(const std::string& path);
+
+private:
+  std::vector<CameraKey> m_keys;
+};
+
+struct FrameTimeSummary {
+  uint32_t count{0};
+  float mean_ms{0.0f};
+  float p50_ms{0.0f};
+  float p95_ms{0.0f};
+  float p99_ms{0.0f};
+  float max_ms{0.0f};
+};
+
+/// @brief Per frame CPU and GPU times of a benchmark run, frames before warmup_frames are ignored.
+class FrameTimeRecorder {
+public:
+  explicit FrameTimeRecorder(uint32_t warmup_frames) : m_warmup_frames(warmup_frames) {}
+
+  void add_cpu_time(uint64_t frame_index, float ms);
+  void add_gpu_time(uint64_t frame_index, float ms);
+
+  [[nodiscard]] FrameTimeSummary get_cpu_summary() const { return Summarize(m_cpu_ms); }
+  [[nodiscard]] FrameTimeSummary get_gpu_summary() const { return Summarize(m_gpu_ms); }
+
+  /// @brief Summaries, fixed bucket histograms and raw frame times, metadata is written as
+  /// string key / value pairs to tell runs apart.
+  bool write_json(const std::string& path,
+                  const std::vector<std::pair<std::string, std::string>>& metadata) const;
+
+  static FrameTimeSummary Summarize(std::vector<float> times);
+
+private:
+  uint32_t m_warmup_frames;
+  std::vector<float> m_cpu_ms;
+  std::vector<float> m_gpu_ms;
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_BENCHMARK_HPP
@@ -1,8 +1,21 @@
 #include "engine.hpp"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "benchmark.hpp"
+#include "ezg_util/job_system.hpp"
+#include "ezg_util/profiler.hpp"
+#include "ezg_util/timer.hpp"
 #include "log.hpp"
 #include "renderer/basic_renderer.hpp"
+#include "renderer/draw_list_builder.hpp"
+#include "renderer/gpu_profiler.hpp"
+#include "renderer/render_stats.hpp"
+#include "render_thread.hpp"
 #include "shadow_scene.hpp"
 #include "simple_scene.hpp"
+#include "stress_scene.hpp"
 #include "systems/gui_system.hpp"
 #include "systems/input_system.hpp"
 #include "systems/profile_system.hpp"
@@ -11,19 +24,53 @@
 using namespace ezg::system;
 
 namespace ezg::gl {
+// upper bound of the first time step after the loop slept on the event queue
+static constexpr float MaxResumeTimeStep = 1.0f / 30.0f;
+// frames presented after an event without a scene change, lets ImGui finish hover / click states
+static constexpr uint32_t PresentsAfterEvent = 3;
+
+struct IdleStats {
+  uint32_t rendered_frames{0};
+  uint32_t cached_frames{0};
+  // wall and process CPU time of loop iterations that did not render the scene
+  double wall_seconds{0.0};
+  double cpu_seconds{0.0};
+};
+
+const std::vector<std::string>& Engine::get_scene_names() {
+  static const std::vector<std::string> names{"SimpleScene", "ShadowScene", "StressScene"};
+  return names;
+}
+
+bool Engine::has_scene(const std::string& name) {
+  const auto& names = get_scene_names();
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+
 void Engine::initialize(const std::string& active_scene) {
+  EngineConfig config{};
+  config.scene = active_scene;
+  initialize(config);
+}
+
+void Engine::initialize(const EngineConfig& engine_config) {
+  m_config                 = engine_config;
+  const auto& active_scene = m_config.scene;
   // setup window
   WindowConfig config{};
-  config.width         = 900;
-  config.height        = 900;
+  config.width         = m_config.width;
+  config.height        = m_config.height;
   config.major_version = 4;
   config.minor_version = 5;
   config.resizable     = GL_TRUE;
   config.title         = "OpenGL Renderer";
+  config.headless      = m_config.headless;
   m_window             = CreateRef<Window>(config);
 
-  // setup GUI
-  m_gui     = GUISystem::Create(m_window->Handle());
+  // setup GUI, there is nothing to interact with in headless mode
+  if (!m_config.headless) {
+    m_gui = GUISystem::Create(m_window->Handle());
+  }
   m_options = CreateRef<RenderOptions>();
 
   // setup renderer
@@ -31,8 +78,17 @@ void Engine::initialize(const std::string& active_scene) {
   RendererConfig render_config{
       config.width,
       config.height,
+      m_config.headless,
   };
-  m_renderer = CreateRef<BasicRenderer>(render_config);
+  m_renderer      = CreateRef<BasicRenderer>(render_config);
+  // the context is current on this thread until the render thread takes it
+  RenderStats::GetInstance().init();
+  m_render_width  = config.width;
+  m_render_height = config.height;
+  m_packets[0]    = CreateRef<RenderPacket>();
+  m_packets[1]    = CreateRef<RenderPacket>();
+  m_draw_lists    = DrawListBuilder::Create(m_config.draw_list_threads);
+  spd::info("Draw lists are built on {} threads", m_draw_lists->get_num_threads());
 
   // setup scenes
   auto simple_scene = CreateRef<SimpleScene>("SimpleScene");
@@ -43,8 +99,21 @@ void Engine::initialize(const std::string& active_scene) {
 
   m_scene_cache.try_emplace(simple_scene->get_name(), std::move(simple_scene));
   m_scene_cache.try_emplace(shadow_scene->get_name(), std::move(shadow_scene));
-  spd::info("Activate scene: {}", active_scene);
-  m_scene = m_scene_cache.at(active_scene);
+  // generating large object counts is slow, only build it when asked for
+  if (active_scene == "StressScene") {
+    auto stress_scene = CreateRef<StressScene>("StressScene", m_config.stress);
+    stress_scene->init();
+    m_scene_cache.try_emplace(stress_scene->get_name(), std::move(stress_scene));
+  }
+  // callers validate with has_scene, fall back instead of throwing for those that don't
+  auto scene_it = m_scene_cache.find(active_scene);
+  if (scene_it == m_scene_cache.end()) {
+    spd::error("Unknown scene '{}', falling back to SimpleScene", active_scene);
+    scene_it       = m_scene_cache.find("SimpleScene");
+    m_config.scene = scene_it->first;
+  }
+  spd::info("Activate scene: {}", scene_it->first);
+  m_scene = scene_it->second;
   if (!m_scene->has_skybox()) {
     m_options->has_env_map = false;
   }
@@ -55,6 +124,54 @@ void Engine::initialize(const std::string& active_scene) {
 
   // timer
   m_stop_watch = CreateRef<StopWatch>();
+
+  // benchmark
+  if (!m_config.camera_path.empty()) {
+    m_camera_path = CreateRef<CameraPath>();
+    if (!m_camera_path->load(m_config.camera_path)) {
+      m_camera_path = nullptr;
+      if (m_config.headless && m_config.max_frames == 0) {
+        m_config.max_frames = 1;
+      }
+    } else {
+      if (m_config.fixed_time_step <= 0.0f) {
+        // wall clock steps would make the replay depend on the frame rate
+        m_config.fixed_time_step = 1.0f / 60.0f;
+        spd::info("Camera path playback uses a fixed time step of 1/60 s");
+      }
+      if (m_config.max_frames == 0) {
+        const auto path_frames = m_camera_path->get_duration() / m_config.fixed_time_step;
+        m_config.max_frames = m_config.warmup_frames + static_cast<uint32_t>(std::ceil(path_frames)) + 1;
+      }
+    }
+  }
+  if (!m_config.record_camera_path.empty()) {
+    m_camera_recording = CreateRef<CameraPath>();
+  }
+  if (!m_config.benchmark_output.empty()) {
+    m_frame_times        = CreateRef<FrameTimeRecorder>(m_config.warmup_frames);
+    const auto& profiler = m_renderer->get_gpu_profiler();
+    profiler->set_wait_for_results(true);
+    // called on the render thread, CPU times are only added by the main thread
+    profiler->set_frame_callback([frame_times = m_frame_times](uint64_t frame_index, float ms) {
+      frame_times->add_gpu_time(frame_index, ms);
+    });
+    m_window->set_vsync(false);
+  }
+  if (m_config.on_demand) {
+    // benchmarks and playback need every frame rendered, hidden windows get no events
+    if (m_config.headless || m_camera_path || m_frame_times) {
+      spd::warn("On-demand rendering is ignored for headless, camera path and benchmark runs");
+      m_config.on_demand = false;
+    } else {
+      m_renderer->set_cache_frames(true);
+    }
+  }
+#ifdef EZG_ENABLE_PROFILER
+  util::Profiler::Get().SetThreadName("Main Thread");
+  spd::info("CPU profiler zone overhead: {:.1f} ns",
+            util::Profiler::Get().MeasureZoneOverhead());
+#endif
 }
 
 void Engine::load_scene(uint32_t index) {
@@ -65,32 +182,217 @@ void Engine::load_scene(uint32_t index) {
   m_camera  = Camera::Create(aabb.bbx_min, aabb.bbx_max, m_window->get_aspect());
 }
 
+void Engine::render(RenderPacket& packet) {
+  EZG_PROFILE_FUNCTION();
+  if (packet.width != m_render_width || packet.height != m_render_height) {
+    m_render_width  = packet.width;
+    m_render_height = packet.height;
+    m_renderer->resize_fbos(m_render_width, m_render_height);
+  }
+  RenderStats::GetInstance().set_pipeline_statistics(packet.pipeline_statistics);
+  RenderStats::GetInstance().begin_frame();
+  if (packet.render_scene) {
+    m_renderer->render_frame(packet.frame);
+  } else {
+    m_renderer->present_cached_frame();
+  }
+  if (m_gui) {
+    EZG_PROFILE_ZONE("GUI Render");
+    // without a render thread ImGui's own draw lists are still valid, no copy was made
+    if (m_render_thread) {
+      packet.gui.render();
+    } else {
+      m_gui->render();
+    }
+  }
+  // GUI draws go through the ImGui backend and are not counted
+  RenderStats::GetInstance().end_frame();
+  {
+    EZG_PROFILE_ZONE("Swap Buffers");
+    m_window->swap_buffers();
+  }
+}
+
 void Engine::run() {
+  if (m_config.render_thread) {
+    m_render_thread =
+        RenderThread::Create(m_window->Handle(), [this](RenderPacket& packet) { render(packet); });
+    m_render_thread->start();
+  }
   m_options->num_models = m_scene->get_num_models();
   m_options->model_list = m_scene->get_model_data();
-  while (!m_window->should_close()) {
-    FrameInfo frame_info{m_scene, m_options, m_camera};
+  uint32_t frame_count  = 0;
+  float elapsed_time    = 0.0f;
+  // on-demand rendering: the scene is only rendered when something changed, otherwise the last
+  // image is presented again, or nothing happens and the loop sleeps on the event queue
+  const bool on_demand       = m_config.on_demand;
+  bool force_render          = true;
+  bool was_idle              = false;
+  uint32_t pending_presents  = 0;
+  RenderOptions last_options = *m_options;
+  IdleStats idle_stats{};
+  while (!m_window->should_close() &&
+         (m_config.max_frames == 0 || frame_count < m_config.max_frames)) {
+    EZG_PROFILE_ZONE("Frame");
+    const auto frame_begin = std::chrono::steady_clock::now();
+    const auto cpu_begin   = util::ProcessCpuTime();
+    bool scene_dirty       = !on_demand || force_render;
+    force_render           = false;
     if (m_window->should_resize()) {
+      // the renderer picks up the new size with the next packet
       m_window->resize();
-      m_renderer->resize_fbos(m_window->get_width(), m_window->get_height());
       float aspect = (float)m_window->get_width() / (float)m_window->get_height();
       m_camera->update_aspect(aspect);
+      scene_dirty = true;
     }
     float delta_time = m_stop_watch->time_step();
+    if (m_config.fixed_time_step > 0.0f) {
+      delta_time = m_config.fixed_time_step;
+    } else if (was_idle) {
+      // time spent waiting for events doesn't advance the simulation
+      delta_time = std::min(delta_time, MaxResumeTimeStep);
+    }
+    {
+      EZG_PROFILE_ZONE("Update");
+      const auto view = m_camera->get_view_matrix();
+      scene_dirty |= m_scene->update(m_options, delta_time);
+      if (m_camera_path) {
+        // playback starts after the warmup frames
+        const auto frame = frame_count > m_config.warmup_frames
+                               ? frame_count - m_config.warmup_frames
+                               : 0;
+        m_camera->set_pose(m_camera_path->sample(frame * m_config.fixed_time_step));
+      } else {
+        m_camera->update(delta_time, m_options->rotate_camera);
+      }
+      if (m_camera_recording) {
+        m_camera_recording->add(elapsed_time, m_camera->get_pose());
+      }
+      scene_dirty |= m_camera->get_view_matrix() != view;
+    }
+    elapsed_time += delta_time;
+    // the GUI changes options while the previous frame is drawn
+    scene_dirty |= *m_options != last_options;
+    if (m_window->consume_events() || scene_dirty) {
+      // ImGui needs a few frames to settle after input
+      pending_presents = PresentsAfterEvent;
+    }
 
-    m_scene->update(m_options, delta_time);
-
-    m_camera->update(delta_time, m_options->rotate_camera);
-
-    m_renderer->render_frame(frame_info);
+    const bool present = pending_presents > 0;
+    if (present) {
+      pending_presents--;
+      // the snapshot is taken while the render thread still draws the previous packet
+      auto& packet               = *m_packets[m_packet_index];
+      packet.render_scene        = scene_dirty;
+      packet.width               = m_window->get_width();
+      packet.height              = m_window->get_height();
+      packet.pipeline_statistics = m_options->pipeline_statistics;
+      if (scene_dirty) {
+        packet.frame.capture(m_scene, *m_options, *m_camera, *m_draw_lists);
+        idle_stats.rendered_frames++;
+      } else {
+        idle_stats.cached_frames++;
+      }
+      // the snapshot carries the request, dump the graph only once
+      m_options->dump_render_graph = false;
+      last_options                 = *m_options;
 
-    m_gui->draw(m_options);
+      // the GUI reads renderer statistics, build it while the render thread is idle
+      if (m_render_thread) {
+        m_render_thread->wait_idle();
+      }
+      if (m_gui) {
+        EZG_PROFILE_ZONE("GUI");
+        m_gui->build(m_options, m_renderer->get_gpu_profiler());
+        if (m_render_thread) {
+          packet.gui.capture(ImGui::GetDrawData());
+        }
+      }
+      if (m_render_thread) {
+        m_render_thread->submit(packet);
+        m_packet_index = 1 - m_packet_index;
+      } else {
+        render(packet);
+      }
+    }
 
     if (m_options->scene_changed) {
-      load_scene(m_options->selected_model);
+      EZG_PROFILE_ZONE("Load Scene");
+      // scene loads create GL resources and free the ones the last packet draws
+      if (m_render_thread) {
+        m_render_thread->execute([this] { load_scene(m_options->selected_model); });
+      } else {
+        load_scene(m_options->selected_model);
+      }
+      force_render = true;
     }
-    m_window->swap_buffers();
-    m_window->update();
+    // nothing to show until the next event
+    was_idle = on_demand && !scene_dirty && !force_render && pending_presents == 0;
+    {
+      EZG_PROFILE_ZONE("Wait Events");
+      m_window->update(was_idle ? m_config.idle_timeout : 0.0);
+    }
+    util::JobSystem::Get().RunMainThreadJobs();
+    if (m_frame_times) {
+      const std::chrono::duration<float, std::milli> cpu_time =
+          std::chrono::steady_clock::now() - frame_begin;
+      m_frame_times->add_cpu_time(frame_count, cpu_time.count());
+    }
+    if (on_demand && !scene_dirty) {
+      const std::chrono::duration<double> wall_time =
+          std::chrono::steady_clock::now() - frame_begin;
+      idle_stats.wall_seconds += wall_time.count();
+      idle_stats.cpu_seconds += util::ProcessCpuTime() - cpu_begin;
+    }
+    if (present) {
+      frame_count++;
+    }
+    EZG_PROFILE_FRAME();
+  }
+  if (m_render_thread) {
+    // the context comes back to this thread for the readbacks below
+    m_render_thread->stop();
+    m_render_thread = nullptr;
+  }
+  if (on_demand) {
+    // a value near 0 % means the idle loop really sleeps, 100 % is one core busy waiting
+    const auto idle_cpu_usage =
+        idle_stats.wall_seconds > 0.0 ? 100.0 * idle_stats.cpu_seconds / idle_stats.wall_seconds
+                                      : 0.0;
+    spd::info("On-demand rendering: {} frames rendered, {} re-presented, idle for {:.1f} s at "
+              "{:.1f} % CPU",
+              idle_stats.rendered_frames, idle_stats.cached_frames, idle_stats.wall_seconds,
+              idle_cpu_usage);
+  }
+  if (m_frame_times) {
+    m_renderer->get_gpu_profiler()->flush();
+    std::vector<std::pair<std::string, std::string>> metadata{
+        {"scene", m_config.scene},
+        {"resolution", std::to_string(m_config.width) + "x" + std::to_string(m_config.height)},
+        {"fixed_time_step", std::to_string(m_config.fixed_time_step)},
+        {"camera_path", m_config.camera_path},
+        {"gl_renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER))},
+        {"gl_version", reinterpret_cast<const char*>(glGetString(GL_VERSION))},
+    };
+    if (m_config.scene == "StressScene") {
+      const auto& stress = m_config.stress;
+      metadata.insert(metadata.end(),
+                      {
+                          {"stress_objects", std::to_string(stress.num_objects)},
+                          {"stress_meshes", std::to_string(stress.num_meshes)},
+                          {"stress_materials", std::to_string(stress.num_materials)},
+                          {"stress_animated_fraction", std::to_string(stress.animated_fraction)},
+                          {"stress_seed", std::to_string(stress.seed)},
+                      });
+    }
+    m_frame_times->write_json(m_config.benchmark_output, metadata);
+  }
+  if (m_camera_recording) {
+    m_camera_recording->save(m_config.record_camera_path);
+  }
+  if (!m_config.screenshot_path.empty()) {
+    m_renderer->save_screenshot(m_config.screenshot_path);
   }
+  spd::info("Rendered {} frames", frame_count);
 }
 }  // namespace ezg::gl
\ No newline at end of file
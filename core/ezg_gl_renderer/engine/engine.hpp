@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <vector>
 #include "base.hpp"
+#include "ezg_util/stress_scene.hpp"
 #include "render_option.hpp"
 
 namespace ezg::system {
@@ -16,17 +17,69 @@ class StopWatch;
 namespace ezg::gl {
 class BasicRenderer;
 class BaseScene;
+class CameraPath;
+class FrameTimeRecorder;
+class RenderThread;
+class DrawListBuilder;
+struct RenderPacket;
+
+struct EngineConfig {
+  std::string scene{"SimpleScene"};
+  uint32_t width{900};
+  uint32_t height{900};
+  // hidden window, no GUI, frames are presented into an offscreen render target
+  bool headless{false};
+  // stop after this many frames, 0 runs until the window is closed
+  uint32_t max_frames{0};
+  // save the last frame as PPM when run() returns
+  std::string screenshot_path;
+
+  // seconds per frame fed to scene and camera updates, 0 uses the wall clock
+  float fixed_time_step{0.0f};
+  // replay this camera path instead of the interactive camera
+  std::string camera_path;
+  // record the interactive camera into this file when run() returns
+  std::string record_camera_path;
+  // write CPU / GPU frame time percentiles and histograms to this JSON file
+  std::string benchmark_output;
+  // frames excluded from the benchmark results
+  uint32_t warmup_frames{0};
+
+  // only render when the camera, scene, options or window changed, sleep on events otherwise
+  bool on_demand{false};
+  // seconds an idle on-demand loop waits for events before checking again
+  double idle_timeout{0.5};
+
+  // draw on a dedicated thread owning the GL context while the next frame is simulated,
+  // false runs everything on the main thread for debugging
+  bool render_thread{true};
+  // mesh ranges culled in parallel on the job system, 0 matches the number of threads,
+  // 1 builds the draw lists serially
+  uint32_t draw_list_threads{0};
+
+  // layout of the procedural "StressScene"
+  util::StressSceneConfig stress{};
+};
 
 class Engine {
 public:
   Engine() = default;
 
   void initialize(const std::string& active_scene);
+  void initialize(const EngineConfig& config);
+
+  /// @brief Names EngineConfig::scene accepts.
+  static const std::vector<std::string>& get_scene_names();
+  static bool has_scene(const std::string& name);
 
   void run();
 
 private:
   void load_scene(uint32_t index);
+  // GL side of a frame, runs on the render thread if there is one
+  void render(RenderPacket& packet);
+
+  EngineConfig m_config{};
 
   Ref<system::StopWatch> m_stop_watch;
   Ref<system::Window> m_window;
@@ -39,6 +92,19 @@ private:
   Ref<BasicRenderer> m_renderer;
 
   Ref<RenderOptions> m_options;
+
+  Ref<CameraPath> m_camera_path;
+  Ref<CameraPath> m_camera_recording;
+  Ref<FrameTimeRecorder> m_frame_times;
+
+  Ref<DrawListBuilder> m_draw_lists;
+  Ref<RenderThread> m_render_thread;
+  // one packet is filled while the render thread draws the other
+  Ref<RenderPacket> m_packets[2];
+  uint32_t m_packet_index{0};
+  // framebuffer size the renderer was last resized to, only touched by render()
+  uint32_t m_render_width{0};
+  uint32_t m_render_height{0};
 };
 }  // namespace ezg::gl
 #endif  //EASYGRAPHICS_ENGINE_HPP
@@ -20,7 +20,11 @@ struct RenderOptions {
   bool blur{false};
   bool scene_changed{false};
   bool show_depth_debug{false};
+  bool dump_render_graph{false};
+  // GL_ARB_pipeline_statistics_query counters, the render thread creates the queries
+  bool pipeline_statistics{false};
   LightType light_type{LightType::Directional};
+  bool operator==(const RenderOptions&) const = default;
 };
 }  // namespace ezg::gl
 #endif  //RENDER_OPTION_HPP
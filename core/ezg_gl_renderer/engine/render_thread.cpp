@@ -0,0 +1,98 @@
+#include "render_thread.hpp"
+#include <GLFW/glfw3.h>
+#include "ezg_util/profiler.hpp"
+#include "log.hpp"
+
+namespace ezg::gl {
+Ref<RenderThread> RenderThread::Create(GLFWwindow* window, RenderFunc render_func) {
+  return CreateRef<RenderThread>(window, std::move(render_func));
+}
+
+RenderThread::RenderThread(GLFWwindow* window, RenderFunc render_func)
+    : m_window(window), m_render_func(std::move(render_func)) {}
+
+RenderThread::~RenderThread() {
+  stop();
+}
+
+void RenderThread::start() {
+  if (m_thread.joinable()) {
+    return;
+  }
+  m_stop = false;
+  // a context is current on at most one thread
+  glfwMakeContextCurrent(nullptr);
+  m_thread = std::thread(&RenderThread::thread_loop, this);
+  spd::info("Render thread started");
+}
+
+void RenderThread::stop() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_work_cv.notify_one();
+  m_thread.join();
+  glfwMakeContextCurrent(m_window);
+}
+
+void RenderThread::wait_idle() {
+  EZG_PROFILE_FUNCTION();
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_idle_cv.wait(lock, [this] { return !m_busy && m_packet == nullptr && !m_task; });
+}
+
+void RenderThread::submit(RenderPacket& packet) {
+  wait_idle();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_packet = &packet;
+  }
+  m_work_cv.notify_one();
+}
+
+void RenderThread::execute(const std::function<void()>& task) {
+  wait_idle();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_task = task;
+  }
+  m_work_cv.notify_one();
+  wait_idle();
+}
+
+void RenderThread::thread_loop() {
+  glfwMakeContextCurrent(m_window);
+#ifdef EZG_ENABLE_PROFILER
+  util::Profiler::Get().SetThreadName("Render Thread");
+#endif
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_work_cv.wait(lock, [this] { return m_stop || m_packet != nullptr || m_task; });
+    if (m_packet == nullptr && !m_task) {
+      break;
+    }
+    auto* packet = m_packet;
+    auto task    = std::move(m_task);
+    m_packet     = nullptr;
+    m_task       = nullptr;
+    m_busy       = true;
+    lock.unlock();
+    if (task) {
+      EZG_PROFILE_ZONE("Render Task");
+      task();
+    }
+    if (packet != nullptr) {
+      m_render_func(*packet);
+    }
+    lock.lock();
+    m_busy = false;
+    m_idle_cv.notify_all();
+  }
+  // hand the context back to whoever stops the thread
+  glfwMakeContextCurrent(nullptr);
+}
+}  // namespace ezg::gl
@@ -0,0 +1,73 @@
+#ifndef EASYGRAPHICS_RENDER_THREAD_HPP
+#define EASYGRAPHICS_RENDER_THREAD_HPP
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "base.hpp"
+#include "renderer/frame_info.hpp"
+#include "systems/gui_system.hpp"
+
+struct GLFWwindow;
+
+namespace ezg::gl {
+/// @brief Everything the render thread needs for one frame, owned by the simulation until
+/// it is submitted and read-only afterwards.
+struct RenderPacket {
+  FrameInfo frame;
+  system::GuiDrawData gui;
+  // false presents the cached image of the last rendered frame
+  bool render_scene{true};
+  // applied to RenderStats on the render thread, which owns the query objects
+  bool pipeline_statistics{false};
+  uint32_t width{0};
+  uint32_t height{0};
+};
+
+/// @brief Thread owning the GL context. At most one packet is in flight, so the simulation
+/// runs at most one frame ahead of the image being drawn.
+class RenderThread {
+public:
+  using RenderFunc = std::function<void(RenderPacket&)>;
+
+  static Ref<RenderThread> Create(GLFWwindow* window, RenderFunc render_func);
+  RenderThread(GLFWwindow* window, RenderFunc render_func);
+  ~RenderThread();
+
+  RenderThread(RenderThread&&)                 = delete;
+  RenderThread(const RenderThread&)            = delete;
+  RenderThread& operator=(RenderThread&&)      = delete;
+  RenderThread& operator=(const RenderThread&) = delete;
+
+  /// @brief Move the context of the calling thread to the render thread.
+  void start();
+  /// @brief Finish the pending work and make the context current on the calling thread again.
+  void stop();
+
+  /// @brief Block until the submitted packet and tasks are done.
+  void wait_idle();
+  /// @brief Hand a packet to the render thread, it must not be modified before the next
+  /// wait_idle returns.
+  void submit(RenderPacket& packet);
+  /// @brief Run GL work (resource loading, readbacks) on the render thread and wait for it.
+  void execute(const std::function<void()>& task);
+
+private:
+  void thread_loop();
+
+  GLFWwindow* m_window{nullptr};
+  RenderFunc m_render_func;
+  std::thread m_thread;
+
+  std::mutex m_mutex;
+  // signals new work to the render thread
+  std::condition_variable m_work_cv;
+  // signals the simulation that the render thread ran out of work
+  std::condition_variable m_idle_cv;
+  RenderPacket* m_packet{nullptr};
+  std::function<void()> m_task;
+  bool m_busy{false};
+  bool m_stop{false};
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_RENDER_THREAD_HPP
@@ -16,10 +16,12 @@ void BaseScene::add_model(const std::string& model_path) {
   m_models.push_back(ResourceManager::GetInstance().load_gltf_model(model_path));
 }
 
-void BaseScene::update(const Ref<RenderOptions>& options, float time) {
+bool BaseScene::update(const Ref<RenderOptions>& options, float time) {
+  bool changed = false;
   // turn on/off light
   if (system::KeyboardMouseInput::GetInstance().was_key_pressed_once(GLFW_KEY_L)) {
     switch_light();
+    changed = true;
   }
   float rotation_angle = time * 0.5f;
   if (options->rotate_model) {
@@ -31,6 +33,8 @@ void BaseScene::update(const Ref<RenderOptions>& options, float time) {
     const auto point = glm::vec3(0.0, m_light_model->get_aabb().get_center().y, 0.0f);
     m_light_model->rotate(rotation_angle, point);
   }
+  changed |= options->rotate_model || options->rotate_light;
+  return animate(time) || changed;
 }
 
 AABB BaseScene::get_aabb() const {
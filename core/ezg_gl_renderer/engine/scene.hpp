@@ -17,8 +17,7 @@ public:
 };
 class BaseScene {
 public:
-  friend class BasicRenderer;
-  friend class ShadowMap;
+  friend struct FrameInfo;
   explicit BaseScene(std::string_view name);
   // disable copying
   BaseScene& operator=(const BaseScene&) = delete;
@@ -31,7 +30,8 @@ public:
   void add_model(const Ref<Model>& model);
   virtual void load_new_model(uint32_t index) = 0;
 
-  void update(const Ref<RenderOptions>& options, float time = 0.0f);
+  /// @brief Returns whether anything visible changed, on-demand rendering skips frames otherwise.
+  bool update(const Ref<RenderOptions>& options, float time = 0.0f);
 
   [[nodiscard]] AABB get_aabb() const;
 
@@ -46,6 +46,10 @@ public:
   virtual const char** get_model_data() = 0;
 
 protected:
+  /// @brief Per frame transform updates of scenes with animated content, returns whether
+  /// anything moved.
+  virtual bool animate(float /*delta_time*/) { return false; }
+
   std::string m_name;
   std::vector<Ref<Model>> m_models;
   Ref<Model> m_floor;
@@ -0,0 +1,151 @@
+#include "stress_scene.hpp"
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include "log.hpp"
+#include "managers/resource_manager.hpp"
+
+namespace ezg::gl {
+// unit cube centered at the origin, one quad per face so normals stay flat
+static Mesh create_cube() {
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  for (int axis = 0; axis < 3; axis++) {
+    for (const float sign : {-1.0f, 1.0f}) {
+      glm::vec3 normal(0.0f);
+      normal[axis] = sign;
+      glm::vec3 u(0.0f);
+      u[(axis + 1) % 3] = 1.0f;
+      const auto v      = glm::cross(normal, u);
+
+      const auto base = static_cast<uint32_t>(vertices.size());
+      for (int corner = 0; corner < 4; corner++) {
+        const glm::vec2 uv(corner & 1, corner >> 1);
+        const auto position = 0.5f * (normal + (2.0f * uv.x - 1.0f) * u + (2.0f * uv.y - 1.0f) * v);
+        vertices.emplace_back(position, uv, normal);
+      }
+      indices.insert(indices.end(), {base, base + 1, base + 3, base, base + 3, base + 2});
+    }
+  }
+  return {vertices, indices};
+}
+
+// uv sphere with radius 0.5, the segment count varies the vertex load between prototypes
+static Mesh create_sphere(uint32_t segments) {
+  const uint32_t rings = segments / 2;
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+  for (uint32_t ring = 0; ring <= rings; ring++) {
+    const auto phi = glm::pi<float>() * static_cast<float>(ring) / static_cast<float>(rings);
+    for (uint32_t segment = 0; segment <= segments; segment++) {
+      const auto theta =
+          glm::two_pi<float>() * static_cast<float>(segment) / static_cast<float>(segments);
+      const glm::vec3 normal(std::sin(phi) * std::cos(theta), std::cos(phi),
+                             std::sin(phi) * std::sin(theta));
+      const glm::vec2 uv(static_cast<float>(segment) / static_cast<float>(segments),
+                         static_cast<float>(ring) / static_cast<float>(rings));
+      vertices.emplace_back(0.5f * normal, uv, normal);
+    }
+  }
+  for (uint32_t ring = 0; ring < rings; ring++) {
+    for (uint32_t segment = 0; segment < segments; segment++) {
+      const uint32_t i = ring * (segments + 1) + segment;
+      indices.insert(indices.end(),
+                     {i, i + 1, i + segments + 1, i + 1, i + segments + 2, i + segments + 1});
+    }
+  }
+  return {vertices, indices};
+}
+
+void StressScene::init() {
+  create_prototypes();
+  generate();
+  load_floor();
+  load_light_model();
+}
+
+void StressScene::load_new_model(uint32_t index) {
+  m_config.num_objects = ObjectCounts[index];
+  generate();
+}
+
+void StressScene::create_prototypes() {
+  for (uint32_t i = 0; i < std::max(m_config.num_meshes, 1u); i++) {
+    if (i % 2 == 0) {
+      m_prototypes.push_back(create_cube());
+    } else {
+      m_prototypes.push_back(create_sphere(8 + 4 * (i / 2)));
+    }
+  }
+  for (uint32_t i = 0; i < std::max(m_config.num_materials, 1u); i++) {
+    // spread base colors around the hue circle
+    const auto hue = glm::two_pi<float>() * static_cast<float>(i) /
+                     static_cast<float>(std::max(m_config.num_materials, 1u));
+    auto& material             = m_materials.emplace_back();
+    material.base_color_factor = glm::vec4(0.5f + 0.5f * std::cos(hue),
+                                           0.5f + 0.5f * std::cos(hue - 2.094f),
+                                           0.5f + 0.5f * std::cos(hue + 2.094f), 1.0f);
+    material.metallic_factor   = static_cast<float>(i % 2);
+    material.roughness_factor  = 0.2f + 0.6f * static_cast<float>(i % 3) / 2.0f;
+    material.name              = "stress_" + std::to_string(i);
+  }
+}
+
+void StressScene::generate() {
+  m_generator = CreateRef<util::StressSceneGenerator>(m_config);
+  m_time      = 0.0f;
+
+  const auto& instances = m_generator->GetInstances();
+  auto model            = Model::Create("StressScene");
+  model->reserve_meshes(instances.size());
+  for (uint32_t i = 0; i < instances.size(); i++) {
+    auto mesh         = m_prototypes[instances[i].mesh];
+    mesh.material     = m_materials[instances[i].material];
+    mesh.model_matrix = m_generator->ComputeTransform(i, 0.0f);
+    model->attach_mesh(mesh);
+  }
+  // room for the animated objects moving out of the generated volume
+  const auto margin = glm::vec3(3.0f * m_config.object_scale);
+  model->set_aabb(
+      AABB(m_generator->GetBoundsMin() - margin, m_generator->GetBoundsMax() + margin));
+
+  m_models.clear();
+  add_model(model);
+  spd::info("Generated stress scene: {} objects, {} meshes, {} materials, {} animated",
+            instances.size(), m_prototypes.size(), m_materials.size(),
+            m_generator->GetAnimated().size());
+}
+
+bool StressScene::animate(float delta_time) {
+  m_time += delta_time;
+  auto& model = m_models[0];
+  for (const auto index : m_generator->GetAnimated()) {
+    model->set_mesh_matrix(index, m_generator->ComputeTransform(index, m_time));
+  }
+  return !m_generator->GetAnimated().empty();
+}
+
+void StressScene::load_light_model() {
+  m_light_model = ResourceManager::GetInstance().load_gltf_model(LightModelPath);
+
+  const auto aabb         = get_aabb();
+  const auto scene_size   = glm::length(aabb.diag);
+  const auto light_size   = glm::length(m_light_model->get_aabb().diag);
+  const auto scale_factor = 0.1f * scene_size / light_size;
+
+  m_light_model->scale(scale_factor);
+  m_light_model->translate(aabb.bbx_max * 1.5f);
+  ResourceManager::GetInstance().delete_model(m_light_model->get_name());
+}
+
+void StressScene::load_floor() {
+  m_floor = ResourceManager::GetInstance().load_gltf_model(FloorPath);
+
+  const auto aabb         = get_aabb();
+  const auto scene_size   = glm::length(aabb.diag);
+  const auto floor_size   = glm::length(m_floor->get_aabb().diag);
+  const auto scale_factor = 1.5f * scene_size / floor_size;
+  m_floor->scale(scale_factor);
+  m_floor->translate(glm::vec3(0.0, aabb.bbx_min.y, 0.0));
+  ResourceManager::GetInstance().delete_model(m_floor->get_name());
+}
+}  // namespace ezg::gl
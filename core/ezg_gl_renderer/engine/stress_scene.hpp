@@ -0,0 +1,44 @@
+#ifndef EASYGRAPHICS_STRESS_SCENE_HPP
+#define EASYGRAPHICS_STRESS_SCENE_HPP
+
+#include "ezg_util/stress_scene.hpp"
+#include "scene.hpp"
+
+namespace ezg::gl {
+/// @brief Procedurally generated scene for scaling tests, every object is its own mesh entry
+/// sharing the vertex array of one of the prototype meshes.
+class StressScene : public BaseScene {
+public:
+  StressScene(std::string_view name, const util::StressSceneConfig& config)
+      : BaseScene(name), m_config(config) {}
+  // the model list selects the object count, the other settings are kept
+  void load_new_model(uint32_t index) override;
+  void load_floor() override;
+  void load_light_model() override;
+  void init() override;
+
+  int get_num_models() override { return ModelNames.size(); }
+  const char** get_model_data() override { return ModelNames.data(); }
+
+protected:
+  bool animate(float delta_time) override;
+
+private:
+  void create_prototypes();
+  void generate();
+
+  const char* FloorPath{"../resources/models/wood_floor/scene.gltf"};
+  const char* LightModelPath{"../resources/models/sun/scene.gltf"};
+  std::vector<const char*> ModelNames{"1k objects", "10k objects", "100k objects",
+                                      "1M objects"};
+  std::vector<uint32_t> ObjectCounts{1'000, 10'000, 100'000, 1'000'000};
+
+  util::StressSceneConfig m_config;
+  Ref<util::StressSceneGenerator> m_generator;
+  std::vector<Mesh> m_prototypes;
+  std::vector<PBRMaterial> m_materials;
+  float m_time{0.0f};
+};
+}  // namespace ezg::gl
+
+#endif  //EASYGRAPHICS_STRESS_SCENE_HPP
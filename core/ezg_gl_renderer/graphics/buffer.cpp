@@ -1,6 +1,8 @@
 #include "buffer.hpp"
 
 #include <glad/glad.h>
+#include "renderer/memory_tracker.hpp"
+#include "renderer/render_stats.hpp"
 
 namespace ezg::gl {
 void BufferView::calc_stride_and_offset() {
@@ -15,15 +17,20 @@ VertexBuffer::VertexBuffer(uint32_t size) {
   glCreateBuffers(1, &m_id);
   glBindBuffer(GL_ARRAY_BUFFER, m_id);
   glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STATIC_DRAW);
+  RenderStats::count_buffer_created(0);
+  MemoryTracker::GetInstance().track(MemoryCategory::VertexBuffer, m_id, size);
 }
 VertexBuffer::VertexBuffer(uint32_t size, const void* data) {
   glCreateBuffers(1, &m_id);
 //  glBindBuffer(GL_ARRAY_BUFFER, m_id);
   glNamedBufferData(m_id, size, data, GL_STATIC_DRAW);
+  RenderStats::count_buffer_created(size);
+  MemoryTracker::GetInstance().track(MemoryCategory::VertexBuffer, m_id, size);
 //  glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
 }
 
 VertexBuffer::~VertexBuffer() {
+  MemoryTracker::GetInstance().untrack(MemoryCategory::VertexBuffer, m_id);
   glDeleteBuffers(1, &m_id);
 }
 
@@ -37,6 +44,7 @@ void VertexBuffer::unbind() const {
 
 void VertexBuffer::set_data(uint32_t size, const void* data) {
   glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+  RenderStats::count_upload(size);
 }
 
 IndexBuffer::IndexBuffer(uint32_t count, const void* data) : m_count(count){
@@ -44,9 +52,12 @@ IndexBuffer::IndexBuffer(uint32_t count, const void* data) : m_count(count){
 
   glBindBuffer(GL_ARRAY_BUFFER, m_id);
   glBufferData(GL_ARRAY_BUFFER, count * sizeof(uint32_t), data, GL_STATIC_DRAW);
+  RenderStats::count_buffer_created(count * sizeof(uint32_t));
+  MemoryTracker::GetInstance().track(MemoryCategory::IndexBuffer, m_id, count * sizeof(uint32_t));
 }
 
 IndexBuffer::~IndexBuffer() {
+  MemoryTracker::GetInstance().untrack(MemoryCategory::IndexBuffer, m_id);
   glDeleteBuffers(1, &m_id);
 }
 
@@ -1,5 +1,7 @@
 #include "framebuffer.hpp"
 #include "log.hpp"
+#include "renderer/memory_tracker.hpp"
+#include "renderer/render_stats.hpp"
 
 namespace ezg::gl {
 AttachmentInfo AttachmentInfo::Color(std::string name_, AttachmentBinding binding_, int w, int h) {
@@ -34,11 +36,15 @@ Attachment::Attachment(const AttachmentInfo& info)
     : m_type(info.type), m_binding(info.binding), m_name(info.name) {
   if (m_type == AttachmentType::TEXTURE_2D) {
     glCreateTextures(GL_TEXTURE_2D, 1, &m_id);
+    RenderStats::count_texture_created();
     glTextureParameteri(m_id, GL_TEXTURE_MIN_FILTER, info.min_filter);
     glTextureParameteri(m_id, GL_TEXTURE_MAG_FILTER, info.mag_filter);
     glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, info.wrap);
     glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, info.wrap);
     glTextureStorage2D(m_id, 1, info.internal_format, info.width, info.height);
+    MemoryTracker::GetInstance().track(
+        MemoryCategory::RenderTarget, m_id,
+        MemoryTracker::calc_texture_bytes(info.internal_format, info.width, info.height));
     if (info.generate_mipmap) {
       glGenerateTextureMipmap(m_id);
     }
@@ -49,10 +55,15 @@ Attachment::Attachment(const AttachmentInfo& info)
   } else if (m_type == AttachmentType::TEXTURE_CUBEMAP) {
 
     glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_id);
+    RenderStats::count_texture_created();
     glTextureStorage2D(m_id,
                        info.level,            //level: number of  mipmaps
                        info.internal_format,  // internal format
                        info.width, info.height);
+    MemoryTracker::GetInstance().track(
+        MemoryCategory::RenderTarget, m_id,
+        MemoryTracker::calc_texture_bytes(info.internal_format, info.width, info.height,
+                                          info.level, 6));
 
     glTextureParameteri(m_id, GL_TEXTURE_WRAP_S, info.wrap);
     glTextureParameteri(m_id, GL_TEXTURE_WRAP_T, info.wrap);
@@ -68,6 +79,9 @@ Attachment::Attachment(const AttachmentInfo& info)
 void Framebuffer::setup_depth_rbo() {
   glCreateRenderbuffers(1, &m_depth_rbo);
   glNamedRenderbufferStorage(m_depth_rbo, GL_DEPTH24_STENCIL8, m_width, m_height);
+  MemoryTracker::GetInstance().track(
+      MemoryCategory::Renderbuffer, m_depth_rbo,
+      MemoryTracker::calc_texture_bytes(GL_DEPTH24_STENCIL8, m_width, m_height));
   glNamedFramebufferRenderbuffer(m_id, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth_rbo);
 }
 
@@ -81,11 +95,21 @@ Framebuffer::Framebuffer(const FramebufferCreatInfo& info)
 }
 
 Framebuffer::~Framebuffer() {
+  release_memory();
   glDeleteFramebuffers(1, &m_id);
   glDeleteTextures(m_attachment_ids.size(), m_attachment_ids.data());
+  glDeleteRenderbuffers(1, &m_depth_rbo);
   m_attachments.clear();
   m_attachment_ids.clear();
 }
+void Framebuffer::release_memory() {
+  auto& memory_tracker = MemoryTracker::GetInstance();
+  for (const auto id : m_attachment_ids) {
+    memory_tracker.untrack(MemoryCategory::RenderTarget, id);
+  }
+  memory_tracker.untrack(MemoryCategory::Renderbuffer, m_depth_rbo);
+}
+
 void Framebuffer::setup_attachments() {
   std::vector<GLenum> buffers;
   for (auto& attachment_info : m_attachments_infos) {
@@ -114,6 +138,7 @@ void Framebuffer::setup_attachments() {
 
 void Framebuffer::invalidate() {
   if (m_id != 0) {
+    release_memory();
     glDeleteFramebuffers(1, &m_id);
     glDeleteTextures(m_attachment_ids.size(), m_attachment_ids.data());
     m_attachments.clear();
@@ -149,6 +174,9 @@ void Framebuffer::resize_attachment(const std::string& name, int width, int heig
 
 void Framebuffer::resize_depth_renderbuffer(int width, int height) {
   glNamedRenderbufferStorage(m_depth_rbo, GL_DEPTH24_STENCIL8, width, height);
+  MemoryTracker::GetInstance().track(
+      MemoryCategory::Renderbuffer, m_depth_rbo,
+      MemoryTracker::calc_texture_bytes(GL_DEPTH24_STENCIL8, width, height));
   glNamedFramebufferRenderbuffer(m_id, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth_rbo);
 }
 
@@ -162,10 +190,12 @@ void Framebuffer::add_attachment(const AttachmentInfo& attachment_info) {
 
 void Framebuffer::unbind() const {
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  RenderStats::count_framebuffer_bind();
 }
 
 void Framebuffer::bind_for_writing(bool set_view_port) const {
   glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+  RenderStats::count_framebuffer_bind();
   if (set_view_port) {
     glViewport(0, 0, m_width, m_height);
   }
@@ -174,6 +204,7 @@ void Framebuffer::bind_for_writing(bool set_view_port) const {
 void Framebuffer::bind_for_reading(const std::string& name, int slot) const {
   const auto& attachment = m_attachments.at(name);
   glBindTextureUnit(slot, attachment->get_id());
+  RenderStats::count_texture_bind();
 }
 
 void Framebuffer::clear() {
@@ -89,6 +89,7 @@ private:
   void setup_depth_rbo();
   void setup_attachments();
   void invalidate();
+  void release_memory();
 
   uint32_t m_id{0};
   int m_width;
@@ -1,6 +1,8 @@
 #include "render_target.hpp"
 
 #include "log.hpp"
+#include "renderer/memory_tracker.hpp"
+#include "renderer/render_stats.hpp"
 #include <utility>
 
 namespace ezg::gl {
@@ -21,21 +23,33 @@ RenderTarget::RenderTarget(const RenderTargetInfo& rt_info) : m_info(rt_info) {
 }
 
 RenderTarget::~RenderTarget() {
+  release_memory();
   glDeleteFramebuffers(1, &m_id);
   glDeleteTextures(m_color_attachments.size(), m_color_attachments.data());
   glDeleteTextures(1, &m_depth_attachment);
 }
 
+void RenderTarget::release_memory() {
+  auto& memory_tracker = MemoryTracker::GetInstance();
+  for (const auto id : m_color_attachments) {
+    memory_tracker.untrack(MemoryCategory::RenderTarget, id);
+  }
+  memory_tracker.untrack(MemoryCategory::RenderTarget, m_depth_attachment);
+}
+
 void RenderTarget::bind() const {
   glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+  RenderStats::count_framebuffer_bind();
   for (size_t i = 0; i < m_color_attachments.size(); i++) {
     glBindTextureUnit(i, m_color_attachments[i]);
+    RenderStats::count_texture_bind();
   }
   glViewport(0, 0, m_info.width, m_info.height);
 }
 
 void RenderTarget::unbind() {
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  RenderStats::count_framebuffer_bind();
 }
 
 void RenderTarget::resize(int width, int height) {
@@ -57,10 +71,12 @@ void RenderTarget::attach_color_texture(GLuint id, GLint internal_format, GLenum
     glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTextureStorage2D(id, 1, internal_format, m_info.width, m_info.height);
-    glTextureSubImage2D(m_id, 0, 0, 0, m_info.width, m_info.height, format, GL_UNSIGNED_BYTE,
-                        nullptr);
   }
   glNamedFramebufferTexture(m_id, index, id, 0);
+  MemoryTracker::GetInstance().track(
+      MemoryCategory::RenderTarget, id,
+      MemoryTracker::calc_texture_bytes(internal_format, m_info.width, m_info.height, 1, 1,
+                                        m_info.samples));
 }
 
 void RenderTarget::attach_depth_texture(uint32_t id, GLint format) const {
@@ -76,10 +92,15 @@ void RenderTarget::attach_depth_texture(uint32_t id, GLint format) const {
     glTextureStorage2D(id, 1, format, m_info.width, m_info.height);
   }
   glNamedFramebufferTexture(m_id, GL_DEPTH_STENCIL_ATTACHMENT, id, 0);
+  MemoryTracker::GetInstance().track(
+      MemoryCategory::RenderTarget, id,
+      MemoryTracker::calc_texture_bytes(format, m_info.width, m_info.height, 1, 1,
+                                        m_info.samples));
 }
 
 void RenderTarget::invalidate() {
   if (m_id != 0) {
+    release_memory();
     glDeleteFramebuffers(1, &m_id);
     glDeleteTextures(m_color_attachments.size(), m_color_attachments.data());
     glDeleteTextures(1, &m_depth_attachment);
@@ -98,18 +119,20 @@ void RenderTarget::invalidate() {
       m_name2index.try_emplace(m_info.color_attachment_infos[i].name, i);
       attach_color_texture(m_color_attachments[i], GL_SRGB8_ALPHA8, GL_RGBA, GL_COLOR_ATTACHMENT0 + i);
       buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+      RenderStats::count_texture_created();
     }
   }
 
   if (m_info.has_depth) {
     glCreateTextures(m_texture_target, 1, &m_depth_attachment);
+    RenderStats::count_texture_created();
     attach_depth_texture(m_depth_attachment, GL_DEPTH24_STENCIL8);
   }
 
   if (m_color_attachments.empty()) {
-    glDrawBuffer(GL_NONE);
+    glNamedFramebufferDrawBuffer(m_id, GL_NONE);
   } else {
-    glDrawBuffers(buffers.size(), buffers.data());
+    glNamedFramebufferDrawBuffers(m_id, buffers.size(), buffers.data());
   }
   auto status = glCheckNamedFramebufferStatus(m_id, GL_FRAMEBUFFER);
   if (status != GL_FRAMEBUFFER_COMPLETE) {
@@ -120,5 +143,6 @@ void RenderTarget::invalidate() {
 void RenderTarget::bind_texture(std::string_view name) {
   const auto slot = m_name2index[name];
   glBindTextureUnit(slot, m_color_attachments[slot]);
+  RenderStats::count_texture_bind();
 }
 }  // namespace ezg::gl
\ No newline at end of file
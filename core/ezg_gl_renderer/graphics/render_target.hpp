@@ -57,9 +57,14 @@ public:
 
   void bind_texture(std::string_view name);
 
+  [[nodiscard]] auto get_id() const { return m_id; }
+  [[nodiscard]] auto get_width() const { return m_info.width; }
+  [[nodiscard]] auto get_height() const { return m_info.height; }
+
 private:
   void attach_color_texture(GLuint id, GLint internal_format, GLenum format, int index) const;
   void attach_depth_texture(uint32_t id, GLint format) const;
+  void release_memory();
 
   GLuint m_id{0};
   RenderTargetInfo m_info;
@@ -2,6 +2,7 @@
 #include <utility>
 #include "log.hpp"
 #include "managers/resource_manager.hpp"
+#include "renderer/render_stats.hpp"
 
 namespace ezg::gl {
 
@@ -119,6 +120,7 @@ ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept {
 
 ShaderProgram& ShaderProgram::use() {
   glUseProgram(m_id);
+  RenderStats::count_program_bind();
   return *this;
 }
 
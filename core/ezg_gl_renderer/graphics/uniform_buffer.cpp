@@ -1,18 +1,24 @@
 #include "uniform_buffer.hpp"
 #include <glad/glad.h>
+#include "renderer/memory_tracker.hpp"
+#include "renderer/render_stats.hpp"
 namespace ezg::gl {
 
 UniformBuffer::UniformBuffer(uint32_t size, uint32_t binding) {
   glCreateBuffers(1, &m_id);
   glNamedBufferData(m_id, size, nullptr, GL_DYNAMIC_DRAW);
+  RenderStats::count_buffer_created(0);
+  MemoryTracker::GetInstance().track(MemoryCategory::UniformBuffer, m_id, size);
   glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_id);
 }
 
 UniformBuffer::~UniformBuffer() {
+  MemoryTracker::GetInstance().untrack(MemoryCategory::UniformBuffer, m_id);
   glDeleteBuffers(1, &m_id);
 }
 
 void UniformBuffer::set_data(const void* data, uint32_t size, uint32_t offset) const {
   glNamedBufferSubData(m_id, offset, size, data);
+  RenderStats::count_upload(size);
 }
 }  // namespace ezg::gl
\ No newline at end of file
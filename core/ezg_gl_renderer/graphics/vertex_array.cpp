@@ -1,5 +1,6 @@
 #include "vertex_array.hpp"
 #include "log.hpp"
+#include "renderer/render_stats.hpp"
 
 namespace ezg::gl {
 
@@ -13,6 +14,7 @@ VertexArray::~VertexArray() {
 
 void VertexArray::bind() const {
   glBindVertexArray(m_id);
+  RenderStats::count_vertex_array_bind();
 }
 
 void VertexArray::unbind() const {
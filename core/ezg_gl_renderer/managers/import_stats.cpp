@@ -0,0 +1,100 @@
+#include "import_stats.hpp"
+
+#include <glad/glad.h>
+#include <utility>
+
+namespace ezg::gl {
+static ImportStageTimer*& current_timer() {
+  thread_local ImportStageTimer* timer = nullptr;
+  return timer;
+}
+
+const char* ImportStats::get_stage_name(ImportStage stage) {
+  switch (stage) {
+    case ImportStage::FileIO:
+      return "file_io";
+    case ImportStage::Parse:
+      return "parse";
+    case ImportStage::Decode:
+      return "decode";
+    case ImportStage::ImageDecode:
+      return "image_decode";
+    case ImportStage::Upload:
+      return "upload";
+    default:
+      return "unknown";
+  }
+}
+
+void ImportStats::add_stage_time(ImportStage stage, double ms) {
+  if (m_current) {
+    m_current->stage_ms[static_cast<size_t>(stage)] += ms;
+  }
+}
+
+void ImportStats::add_file_bytes(uint64_t bytes) {
+  if (m_current) {
+    m_current->file_bytes += bytes;
+  }
+}
+
+std::vector<ImportRecord> ImportStats::take_records() {
+  return std::exchange(m_records, {});
+}
+
+ImportScope::ImportScope(const std::string& path, const char* type) {
+  auto& stats = ImportStats::GetInstance();
+  if (!stats.m_enabled || stats.m_current) {
+    return;
+  }
+  m_active        = true;
+  m_record.path   = path;
+  m_record.type   = type;
+  stats.m_current = &m_record;
+  m_start         = std::chrono::steady_clock::now();
+}
+
+ImportScope::~ImportScope() {
+  if (!m_active) {
+    return;
+  }
+  {
+    // uploads are asynchronous, wait for them so they are charged to this import
+    ImportStageTimer upload{ImportStage::Upload};
+    glFinish();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - m_start;
+  m_record.total_ms  = std::chrono::duration<double, std::milli>(elapsed).count();
+  auto& stats        = ImportStats::GetInstance();
+  stats.m_current    = nullptr;
+  stats.m_records.push_back(std::move(m_record));
+}
+
+ImportStageTimer::ImportStageTimer(ImportStage stage) : m_stage(stage) {
+  if (!ImportStats::GetInstance().is_enabled()) {
+    return;
+  }
+  m_active = true;
+  m_parent = current_timer();
+  m_start  = Clock::now();
+  if (m_parent) {
+    m_parent->m_elapsed_ms +=
+        std::chrono::duration<double, std::milli>(m_start - m_parent->m_start).count();
+  }
+  current_timer() = this;
+}
+
+ImportStageTimer::~ImportStageTimer() {
+  if (!m_active) {
+    return;
+  }
+  const auto now = Clock::now();
+  m_elapsed_ms += std::chrono::duration<double, std::milli>(now - m_start).count();
+  ImportStats::GetInstance().add_stage_time(m_stage, m_elapsed_ms);
+  current_timer() = m_parent;
+  if (m_parent) {
+    // resume the enclosing stage
+    m_parent->m_start = now;
+  }
+}
+}  // namespace ezg::gl
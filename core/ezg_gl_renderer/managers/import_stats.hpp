@@ -0,0 +1,96 @@
+#ifndef EASYGRAPHICS_IMPORT_STATS_HPP
+#define EASYGRAPHICS_IMPORT_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ezg::gl {
+enum class ImportStage : uint8_t {
+  FileIO,  // reading the file, mapped OBJ files are prefaulted in this stage
+  Parse,   // JSON / OBJ text
+  Decode,  // accessors, vertex assembly, bounds
+  ImageDecode,
+  Upload,  // GL object creation, includes a glFinish at the end of the import
+  Count
+};
+
+struct ImportRecord {
+  std::string path;
+  std::string type;
+  uint64_t file_bytes{0};
+  std::array<double, static_cast<size_t>(ImportStage::Count)> stage_ms{};
+  double total_ms{0.0};
+
+  [[nodiscard]] double get(ImportStage stage) const {
+    return stage_ms[static_cast<size_t>(stage)];
+  }
+};
+
+/// @brief Per stage timings of the imports done by ResourceManager, only collected while enabled.
+class ImportStats {
+public:
+  static ImportStats& GetInstance() {
+    static ImportStats stats;
+    return stats;
+  }
+  ImportStats(const ImportStats&)            = delete;
+  ImportStats& operator=(const ImportStats&) = delete;
+
+  static const char* get_stage_name(ImportStage stage);
+
+  void set_enabled(bool enabled) { m_enabled = enabled; }
+  [[nodiscard]] bool is_enabled() const { return m_enabled; }
+
+  void add_stage_time(ImportStage stage, double ms);
+  void add_file_bytes(uint64_t bytes);
+
+  /// @brief Finished imports since the last call, oldest first.
+  std::vector<ImportRecord> take_records();
+
+private:
+  friend class ImportScope;
+  ImportStats() = default;
+
+  bool m_enabled{false};
+  // imports run on the thread owning the GL context, one at a time
+  ImportRecord* m_current{nullptr};
+  std::vector<ImportRecord> m_records;
+};
+
+/// @brief Brackets one import, scopes opened inside an active one are merged into it.
+class ImportScope {
+public:
+  ImportScope(const std::string& path, const char* type);
+  ~ImportScope();
+  ImportScope(const ImportScope&)            = delete;
+  ImportScope& operator=(const ImportScope&) = delete;
+
+private:
+  bool m_active{false};
+  ImportRecord m_record;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+/// @brief Charges the time until destruction to a stage. Timers nest exclusively: an inner timer
+/// pauses the outer one, so image decodes inside the glTF parse are not counted twice.
+class ImportStageTimer {
+public:
+  explicit ImportStageTimer(ImportStage stage);
+  ~ImportStageTimer();
+  ImportStageTimer(const ImportStageTimer&)            = delete;
+  ImportStageTimer& operator=(const ImportStageTimer&) = delete;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  ImportStage m_stage;
+  bool m_active{false};
+  ImportStageTimer* m_parent{nullptr};
+  Clock::time_point m_start;
+  double m_elapsed_ms{0.0};
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_IMPORT_STATS_HPP
@@ -1,12 +1,47 @@
 #include "resource_manager.hpp"
 #include <stb_image.h>
 #include <tiny_gltf.h>
-#include <tiny_obj_loader.h>
 #include <fstream>
+#include "ezg_util/obj_loader.hpp"
+#include "import_stats.hpp"
 #include "log.hpp"
+#include "renderer/memory_tracker.hpp"
 #include "utils/gltf_utils.hpp"
 
 namespace ezg::gl {
+static bool read_file_bytes(const std::string& path, std::vector<unsigned char>& bytes) {
+  ImportStageTimer timer{ImportStage::FileIO};
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) {
+    return false;
+  }
+  bytes.resize(static_cast<size_t>(in.tellg()));
+  in.seekg(0);
+  in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  ImportStats::GetInstance().add_file_bytes(bytes.size());
+  return static_cast<bool>(in);
+}
+
+// tinygltf file system callback, routes .bin buffers and external images through read_file_bytes
+static bool read_gltf_file(std::vector<unsigned char>* out, std::string* err,
+                           const std::string& path, void*) {
+  if (!read_file_bytes(path, *out)) {
+    if (err) {
+      *err += "File read error : " + path + "\n";
+    }
+    return false;
+  }
+  return true;
+}
+
+static bool decode_gltf_image(tinygltf::Image* image, const int image_idx, std::string* err,
+                              std::string* warn, int req_width, int req_height,
+                              const unsigned char* bytes, int size, void* user_data) {
+  ImportStageTimer timer{ImportStage::ImageDecode};
+  return tinygltf::LoadImageData(image, image_idx, err, warn, req_width, req_height, bytes, size,
+                                 user_data);
+}
+
 std::string ResourceManager::load_shader_source(const std::filesystem::path& path) {
   std::ifstream in(path, std::ios::in);
   in.exceptions(std::ifstream::failbit | std::ifstream::badbit);
@@ -29,85 +64,58 @@ Ref<Model> ResourceManager::get_model(const std::string& name) {
 void ResourceManager::load_model(const std::string& name, const std::string& path,
                                  bool load_material) {
   spdlog::trace("Loading model {} from path {}", name, path);
-  //attrib will contain the vertex arrays of the file
-  tinyobj::attrib_t attrib;
-  //shapes contains the info for each separate object in the file
-  std::vector<tinyobj::shape_t> shapes;
-  //materials contains the information about the material of each shape, but we wont use it.
-  std::vector<tinyobj::material_t> materials;
+  MemoryOwnerScope owner{name};
 
-  //error and warning output from the load function
-  std::string warn;
+  ImportScope import{path, "obj"};
+  util::MappedFile file;
+  {
+    // fault the pages in here, the read would otherwise be timed as part of the parse
+    ImportStageTimer timer{ImportStage::FileIO};
+    if (!file.Open(path)) {
+      spdlog::error("Cannot open file [{}]", path);
+      return;
+    }
+    file.Prefault();
+    ImportStats::GetInstance().add_file_bytes(file.GetSize());
+  }
+  util::ObjModel obj;
   std::string err;
-
-  //load the OBJ file
-  tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), nullptr);
+  bool parsed = false;
+  {
+    ImportStageTimer timer{ImportStage::Parse};
+    parsed = util::ParseObj(file.GetData(), std::filesystem::path(path).parent_path(), obj, err);
+  }
   //make sure to output the warnings to the console, in case there are issues with the file
-  if (!warn.empty()) {
-    spdlog::warn(warn);
+  if (!obj.warnings.empty()) {
+    spdlog::warn(obj.warnings);
   }
-  //if we have any error, print it to the console, and break the mesh loading.
-  //This happens if the file cant be found or is malformed
-  if (!err.empty()) {
-    spdlog::error(err);
+  //This happens if the file is malformed
+  if (!parsed) {
+    spdlog::error("{}: {}", path, err);
     return;
   }
 
   std::vector<Vertex> vertices;
-  std::vector<GLuint> indices;
-  // Loop over shapes
-  for (size_t s = 0; s < shapes.size(); s++) {
-    // Loop over faces(polygon)
-    size_t index_offset = 0;
-    for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-
-      //hardcode loading to triangles
-      size_t fv = size_t(shapes[s].mesh.num_face_vertices[f]);
-
-      // Loop over vertices in the face.
-      for (size_t v = 0; v < fv; v++) {
-        // access to vertex
-        tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-        //vertex position
-        tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
-        tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
-        tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
-        //vertex normal
-        tinyobj::real_t nx = attrib.normals[3 * idx.normal_index + 0];
-        tinyobj::real_t ny = attrib.normals[3 * idx.normal_index + 1];
-        tinyobj::real_t nz = attrib.normals[3 * idx.normal_index + 2];
-
-        //vertex uv
-        tinyobj::real_t ux = attrib.texcoords[2 * idx.texcoord_index + 0];
-        tinyobj::real_t uy = attrib.texcoords[2 * idx.texcoord_index + 1];
-
-        //copy it into our vertex
-        Vertex new_vert;
-        new_vert.position.x = vx;
-        new_vert.position.y = vy;
-        new_vert.position.z = vz;
-
-        new_vert.normal.x = nx;
-        new_vert.normal.y = ny;
-        new_vert.normal.z = nz;
-
-        new_vert.uv.x = ux;
-        new_vert.uv.y = 1 - uy;
-
-        //we are setting the vertex color as the vertex normal. This is just for display purposes
-
-        indices.push_back(static_cast<GLuint>(vertices.size()));
-        vertices.push_back(new_vert);
-      }
-      index_offset += fv;
-    }
+  ImportStageTimer decode_timer{ImportStage::Decode};
+  // the parser already welded the face corners, only the layout and the uv origin differ
+  vertices.reserve(obj.vertices.size());
+  for (const auto& vertex : obj.vertices) {
+    vertices.emplace_back(vertex.position, glm::vec2(vertex.uv.x, 1.0f - vertex.uv.y),
+                          vertex.normal);
   }
+  std::vector<GLuint> indices = std::move(obj.indices);
 
+  auto& memory_tracker = MemoryTracker::GetInstance();
+  memory_tracker.track(MemoryCategory::HostGeometry, reinterpret_cast<uintptr_t>(&vertices),
+                       vertices.size() * sizeof(Vertex) + indices.size() * sizeof(GLuint));
   // TODO: load material
   if (load_material) {}
   // cache material
-  m_model_cache.try_emplace(name, std::make_shared<Model>(name, vertices, indices));
+  {
+    ImportStageTimer timer{ImportStage::Upload};
+    m_model_cache.try_emplace(name, std::make_shared<Model>(name, vertices, indices));
+  }
+  memory_tracker.untrack(MemoryCategory::HostGeometry, reinterpret_cast<uintptr_t>(&vertices));
 }
 
 Ref<Model> ResourceManager::load_gltf_model(const std::string& path) {
@@ -115,11 +123,30 @@ Ref<Model> ResourceManager::load_gltf_model(const std::string& path) {
   if (m_model_cache.contains(name)) {
     return m_model_cache.at(name);
   }
+  MemoryOwnerScope owner{name};
+  ImportScope import{path, "gltf"};
   tinygltf::Model gltf_model;
   tinygltf::TinyGLTF loader;
   std::string error;
   std::string warning;
-  bool ret = loader.LoadASCIIFromFile(&gltf_model, &error, &warning, path.c_str());
+  // same as LoadASCIIFromFile, split so file reads and image decodes are timed on their own
+  loader.SetFsCallbacks({&tinygltf::FileExists, &tinygltf::ExpandFilePath, &read_gltf_file,
+                         &tinygltf::WriteWholeFile, nullptr});
+  // no user data keeps tinygltf's default image options
+  loader.SetImageLoader(&decode_gltf_image, nullptr);
+  std::vector<unsigned char> json;
+  if (!read_file_bytes(path, json) || json.empty()) {
+    spdlog::error("Failed to read glTF {}", path);
+    return nullptr;
+  }
+  bool ret = false;
+  {
+    ImportStageTimer timer{ImportStage::Parse};
+    ret = loader.LoadASCIIFromString(&gltf_model, &error, &warning,
+                                     reinterpret_cast<const char*>(json.data()),
+                                     static_cast<unsigned int>(json.size()),
+                                     std::filesystem::path(path).parent_path().string());
+  }
   if (!warning.empty()) {
     spdlog::warn(warning);
   }
@@ -130,6 +157,19 @@ Ref<Model> ResourceManager::load_gltf_model(const std::string& path) {
     spdlog::error("Failed to parse glTF");
     return nullptr;
   }
+  // the parsed document keeps every image and buffer alive until the upload is done
+  uint64_t host_image_bytes    = 0;
+  uint64_t host_geometry_bytes = 0;
+  for (const auto& image : gltf_model.images) {
+    host_image_bytes += image.image.size();
+  }
+  for (const auto& buffer : gltf_model.buffers) {
+    host_geometry_bytes += buffer.data.size();
+  }
+  auto& memory_tracker  = MemoryTracker::GetInstance();
+  const auto memory_key = reinterpret_cast<uintptr_t>(&gltf_model);
+  memory_tracker.track(MemoryCategory::HostImage, memory_key, host_image_bytes);
+  memory_tracker.track(MemoryCategory::HostGeometry, memory_key, host_geometry_bytes);
   const auto load_textures = [&](const tinygltf::Model& model) {
     tinygltf::Sampler defaultSampler;
     defaultSampler.minFilter = GL_LINEAR;
@@ -216,7 +256,11 @@ Ref<Model> ResourceManager::load_gltf_model(const std::string& path) {
     }
     mesh.material = std::move(mesh_material);
   };
-  load_textures(gltf_model);
+  {
+    ImportStageTimer timer{ImportStage::Upload};
+    load_textures(gltf_model);
+  }
+  ImportStageTimer decode_timer{ImportStage::Decode};
   std::unordered_map<int, glm::mat4> mesh_matrices;
   const std::function<void(int, const glm::mat4&)> extract_node_matrices =
       [&](int node_idx, const glm::mat4& parent_matrix) {
@@ -246,6 +290,7 @@ Ref<Model> ResourceManager::load_gltf_model(const std::string& path) {
       auto& primitive = gl_mesh.primitives[primitive_index];
       extract_gltf_vertices(primitive, gltf_model, vertices);
       extract_gltf_indices(primitive, gltf_model, indices);
+      ImportStageTimer upload_timer{ImportStage::Upload};
       Mesh mesh{vertices, indices};
       if (mesh_matrices.find(mesh_idx) != mesh_matrices.end()) {
         mesh.model_matrix = mesh_matrices[mesh_idx];
@@ -263,15 +308,25 @@ Ref<Model> ResourceManager::load_gltf_model(const std::string& path) {
   m_model_cache[name] = model;
   model->translate(glm::vec3{0.0f, 0.0f, 0.0f});
   m_texture_cache.clear();
+  memory_tracker.untrack(MemoryCategory::HostImage, memory_key);
+  memory_tracker.untrack(MemoryCategory::HostGeometry, memory_key);
   return model;
 }
 
 Ref<Texture2D> ResourceManager::load_hdr_texture(const std::string& path) {
+  MemoryOwnerScope owner{extract_name(path)};
+  ImportScope import{path, "hdr"};
   int width, height, channels;
-  stbi_set_flip_vertically_on_load(true);
   spdlog::trace("Loading texture at path {}", path);
-  auto* data = stbi_loadf(path.c_str(), &width, &height, &channels, 0);
-  stbi_set_flip_vertically_on_load(false);
+  std::vector<unsigned char> file_data;
+  float* data = nullptr;
+  if (read_file_bytes(path, file_data)) {
+    ImportStageTimer timer{ImportStage::ImageDecode};
+    stbi_set_flip_vertically_on_load(true);
+    data = stbi_loadf_from_memory(file_data.data(), static_cast<int>(file_data.size()), &width,
+                                  &height, &channels, 0);
+    stbi_set_flip_vertically_on_load(false);
+  }
 
   if (!data) {
     spdlog::error("Failed to load HDR image {}", path);
@@ -287,18 +342,37 @@ Ref<Texture2D> ResourceManager::load_hdr_texture(const std::string& path) {
   info.wrap_t          = GL_CLAMP_TO_EDGE;
   info.min_filter      = GL_LINEAR;
   info.mag_filter      = GL_LINEAR;
-  m_hdri_cache.try_emplace(path, Texture2D::Create(info, data));
+  auto& memory_tracker = MemoryTracker::GetInstance();
+  memory_tracker.track(MemoryCategory::HostImage, reinterpret_cast<uintptr_t>(data),
+                       static_cast<uint64_t>(width) * height * channels * sizeof(float));
+  {
+    ImportStageTimer timer{ImportStage::Upload};
+    m_hdri_cache.try_emplace(path, Texture2D::Create(info, data));
+  }
+  memory_tracker.untrack(MemoryCategory::HostImage, reinterpret_cast<uintptr_t>(data));
+  stbi_image_free(data);
   return m_hdri_cache.at(path);
 }
 
 Ref<TextureCubeMap> ResourceManager::load_cubemap_textures(
     const std::string& name, const std::vector<std::string>& face_paths) {
+  MemoryOwnerScope owner{name};
+  ImportScope import{name, "cubemap"};
+  auto& memory_tracker = MemoryTracker::GetInstance();
   std::array<unsigned char*, 6> face_data{};
   int width, height, channels;
+  std::vector<unsigned char> file_data;
   for (unsigned int i = 0; i < face_paths.size(); i++) {
-    unsigned char* data = stbi_load(face_paths[i].c_str(), &width, &height, &channels, 0);
+    unsigned char* data = nullptr;
+    if (read_file_bytes(face_paths[i], file_data)) {
+      ImportStageTimer timer{ImportStage::ImageDecode};
+      data = stbi_load_from_memory(file_data.data(), static_cast<int>(file_data.size()), &width,
+                                   &height, &channels, 0);
+    }
     if (data) {
       face_data[i] = data;
+      memory_tracker.track(MemoryCategory::HostImage, reinterpret_cast<uintptr_t>(data),
+                           static_cast<uint64_t>(width) * height * channels);
       //      stbi_image_free(data);
     } else {
       spdlog::error("Cubemap texture failed to load at path: {}", face_paths[i]);
@@ -315,8 +389,12 @@ Ref<TextureCubeMap> ResourceManager::load_cubemap_textures(
   texture_info.mag_filter      = GL_LINEAR;
   texture_info.data_format     = GL_RGB;
   texture_info.internal_format = GL_RGB8;
-  m_cubemap_cache.try_emplace(name, TextureCubeMap::Create(texture_info, face_data));
+  {
+    ImportStageTimer timer{ImportStage::Upload};
+    m_cubemap_cache.try_emplace(name, TextureCubeMap::Create(texture_info, face_data));
+  }
   for (unsigned int i = 0; i < face_data.size(); i++) {
+    memory_tracker.untrack(MemoryCategory::HostImage, reinterpret_cast<uintptr_t>(face_data[i]));
     stbi_image_free(face_data[i]);
   }
   return m_cubemap_cache.at(name);
@@ -333,4 +411,10 @@ void ResourceManager::delete_model(const std::string& name) {
     m_model_cache.erase(name);
   }
 }
+
+void ResourceManager::clear_caches() {
+  m_model_cache.clear();
+  m_hdri_cache.clear();
+  m_cubemap_cache.clear();
+}
 }  // namespace ezg::gl
\ No newline at end of file
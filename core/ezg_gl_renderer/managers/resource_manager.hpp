@@ -33,6 +33,9 @@ public:
 
   void delete_model(const std::string& name);
 
+  /// @brief Drop every cached model, HDR and cubemap so the next load imports from disk again.
+  void clear_caches();
+
 private:
   ResourceManager() { m_white_texture = Texture2D::CreateDefaultWhite(); };
 
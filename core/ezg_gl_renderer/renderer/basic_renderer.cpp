@@ -1,15 +1,23 @@
 #include "basic_renderer.hpp"
 
+#include <fstream>
 #include <memory>
 #include "assets/line.hpp"
+#include "ezg_util/profiler.hpp"
 #include "graphics/framebuffer.hpp"
+#include "graphics/render_target.hpp"
 #include "graphics/shader.hpp"
+#include "gpu_profiler.hpp"
+#include "log.hpp"
+#include "memory_tracker.hpp"
 #include "render_api.hpp"
+#include "render_graph.hpp"
 #include "shadow_map.hpp"
 
 namespace ezg::gl {
 BasicRenderer::BasicRenderer(const RendererConfig& config)
     : m_width(config.width), m_height(config.height) {
+  MemoryOwnerScope owner{"BasicRenderer"};
   ShaderProgramCreateInfo info1{
       "pbr",
       {
@@ -32,10 +40,21 @@ BasicRenderer::BasicRenderer(const RendererConfig& config)
   compile_shaders({info1, info2, info3});
   setup_ubos();
   setup_screen_quad();
-  setup_framebuffers(m_width, m_height);
   setup_coordinate_axis();
-  m_aabb_line  = CreateRef<Line>();
-  m_shadow_map = CreateRef<ShadowMap>(1024, 1024);
+  m_aabb_line    = CreateRef<Line>();
+  m_shadow_map   = CreateRef<ShadowMap>(1024, 1024);
+  m_gpu_profiler = GpuProfiler::Create();
+  m_render_graph = RenderGraph::Create(m_width, m_height);
+  m_render_graph->set_profiler(m_gpu_profiler);
+  if (config.offscreen) {
+    RenderTargetInfo target_info{};
+    target_info.width                  = m_width;
+    target_info.height                 = m_height;
+    target_info.color_attachment_infos = {{"color", RTAttachmentFormat::RGBA8}};
+    m_offscreen_target                 = RenderTarget::Create(target_info);
+    m_render_graph->set_backbuffer(m_offscreen_target->get_id());
+  }
+  build_render_graph(m_graph_key);
 }
 
 void BasicRenderer::compile_shaders(
@@ -75,17 +94,6 @@ void BasicRenderer::setup_screen_quad() {
   m_quad_vao->unbind();
 }
 
-void BasicRenderer::setup_framebuffers(uint32_t width, uint32_t height) {
-  // srgb color attachment
-  AttachmentInfo color_info =
-      AttachmentInfo::Color("color", AttachmentBinding::COLOR0, width, height);
-  color_info.internal_format = GL_SRGB8_ALPHA8;
-  AttachmentInfo depth{AttachmentInfo::Depth(width, height)};
-  std::vector<AttachmentInfo> attachment_infos{color_info, depth};
-  FramebufferCreatInfo framebuffer_ci{width, height, attachment_infos};
-  m_pbuffer = Framebuffer::Create(framebuffer_ci);
-}
-
 void BasicRenderer::setup_coordinate_axis() {
   m_axis_line                = CreateRef<Line>();
   m_axis_line->line_vertices = {
@@ -120,26 +128,27 @@ void BasicRenderer::set_default_state() {
 
 void BasicRenderer::update_ubo(const FrameInfo& info) {
   // camera ubo
-  m_camera_data.view       = info.camera->get_view_matrix();
-  m_camera_data.projection = info.camera->get_projection_matrix();
+  m_camera_data.view       = info.view;
+  m_camera_data.projection = info.projection;
   m_camera_data.proj_view  = m_camera_data.projection * m_camera_data.view;
   m_camera_ubo->set_data(&m_camera_data, sizeof(CameraData));
   // scene ubo
   auto& shader = m_shader_cache.at("pbr");
   shader->use();
-  shader->set_uniform("uLightIntensity", info.scene->get_light_intensity());
-  shader->set_uniform("uLightPos", info.scene->get_light_pos());
-  shader->set_uniform("uLightDir", info.scene->get_light_dir());
-  shader->set_uniform("uLightType", static_cast<int>(info.options->light_type));
-  shader->set_uniform("uCameraPos", info.camera->get_pos());
+  shader->set_uniform("uLightIntensity", info.light_intensity);
+  shader->set_uniform("uLightPos", info.light_pos);
+  shader->set_uniform("uLightDir", info.light_dir);
+  shader->set_uniform("uLightType", static_cast<int>(info.options.light_type));
+  shader->set_uniform("uCameraPos", info.camera_pos);
   shader->set_uniform("uLightSpaceMat", m_shadow_map->get_light_space_mat());
 }
 
-void BasicRenderer::render_meshes(const std::vector<Mesh>& meshes) {
-  for (const auto& mesh : meshes) {
-    m_sampler_data = {};
+void BasicRenderer::render_meshes(const std::vector<DrawItem>& draws) {
+  for (const auto& draw : draws) {
+    const auto& mesh = *draw.mesh;
+    m_sampler_data   = {};
     // model ubo
-    m_model_data.model_matrix = mesh.model_matrix;
+    m_model_data.model_matrix = draw.model_matrix;
     m_model_ubo->set_data(&m_model_data, sizeof(ModelData));
     // bindless textures
     mesh.material.upload_textures(m_shader_cache.at("pbr"), m_sampler_data);
@@ -149,70 +158,200 @@ void BasicRenderer::render_meshes(const std::vector<Mesh>& meshes) {
   }
 }
 
-void BasicRenderer::render_scene(const FrameInfo& info) {
-  m_shadow_map->bind_for_read(6);
-  if (info.scene->has_skybox()) {
-    // bind Prefiltered IBL texture
-    if (info.options->enable_env_map) {
-      info.scene->m_skybox->bind_prefilter_data();
-    } else {
-      info.scene->m_skybox->unbind_prefilter_data();
-    }
-    if (info.options->show_bg) {
-      info.scene->m_skybox->draw(info.camera, info.options->blur);
-    }
+void BasicRenderer::build_render_graph(const RenderGraphKey& key) {
+  EZG_PROFILE_FUNCTION();
+  m_graph_key = key;
+  m_render_graph->reset();
+  auto shadow_map = m_render_graph->import_texture("shadow_map", m_shadow_map->get_depth_texture(),
+                                                   m_shadow_map->get_width(),
+                                                   m_shadow_map->get_height());
+  m_render_graph->add_pass(
+      "shadow", [&](RGPassBuilder& builder) { builder.write(shadow_map); },
+      [this](const RGResources&) {
+        const auto& info = *m_frame_info;
+        m_shadow_map->run_depth_pass(info);
+        set_default_state();
+        // light space matrix is up to date from here on
+        update_ubo(info);
+      });
+
+  RGHandle scene_color = InvalidRGHandle;
+  RGHandle scene_depth = InvalidRGHandle;
+  const RGTextureDesc color_desc{GL_SRGB8_ALPHA8};
+  const RGTextureDesc depth_desc{GL_DEPTH_COMPONENT32F};
+  if (key.has_skybox && key.show_bg) {
+    m_render_graph->add_pass(
+        "skybox",
+        [&](RGPassBuilder& builder) {
+          scene_color = builder.create("scene_color", color_desc);
+          scene_depth = builder.create("scene_depth", depth_desc);
+        },
+        [this](const RGResources&) {
+          const auto& info = *m_frame_info;
+          info.skybox->draw(info.view, info.projection, info.options.blur);
+        });
   }
-  // render models
-  for (const auto& model : info.scene->m_models) {
-    render_meshes(model->get_meshes());
-    if (info.options->show_aabb) {
-      model->get_aabb().get_lines_data(m_aabb_line);
-      m_shader_cache.at("lines")->use();
-      RenderAPI::draw_line(m_aabb_line->vao, m_aabb_line->line_vertices.size());
-    }
+  m_render_graph->add_pass(
+      "forward",
+      [&](RGPassBuilder& builder) {
+        if (scene_color == InvalidRGHandle) {
+          scene_color = builder.create("scene_color", color_desc);
+          scene_depth = builder.create("scene_depth", depth_desc);
+        } else {
+          builder.write(scene_color);
+          builder.write(scene_depth);
+        }
+        builder.read(shadow_map);
+      },
+      [this, shadow_map, key](const RGResources& resources) {
+        const auto& info = *m_frame_info;
+        resources.bind_texture(shadow_map, 6);
+        if (info.skybox) {
+          // bind Prefiltered IBL texture
+          if (info.options.enable_env_map) {
+            info.skybox->bind_prefilter_data();
+          } else {
+            info.skybox->unbind_prefilter_data();
+          }
+        }
+        render_meshes(info.models);
+        if (key.show_light_model) {
+          render_meshes(info.light_model);
+        }
+        if (key.show_floor) {
+          render_meshes(info.floor);
+        }
+      });
+  if (key.show_aabb || key.show_axis) {
+    m_render_graph->add_pass(
+        "debug_lines",
+        [&](RGPassBuilder& builder) {
+          builder.write(scene_color);
+          builder.write(scene_depth);
+        },
+        [this, key](const RGResources&) {
+          const auto& info = *m_frame_info;
+          m_shader_cache.at("lines")->use();
+          if (key.show_aabb) {
+            for (const auto& aabb : info.model_aabbs) {
+              aabb.get_lines_data(m_aabb_line);
+              RenderAPI::draw_line(m_aabb_line->vao, m_aabb_line->line_vertices.size());
+            }
+          }
+          if (key.show_axis) {
+            RenderAPI::draw_line(m_axis_line->vao, m_axis_line->line_vertices.size());
+          }
+        });
   }
-  if (info.options->show_light_model) {
-    render_meshes(info.scene->m_light_model->get_meshes());
+  // with the depth debug view nothing reads scene_color, so the scene passes are culled
+  m_render_graph->add_pass(
+      "present",
+      [&](RGPassBuilder& builder) {
+        builder.read(key.show_depth_debug ? shadow_map : scene_color);
+        builder.write_backbuffer();
+      },
+      [this, scene_color, key](const RGResources& resources) {
+        const auto& info = *m_frame_info;
+        RenderAPI::disable_depth_testing();
+        RenderAPI::clear_color();
+        m_shader_cache.at("screen")->use();
+        if (key.show_depth_debug) {
+          m_shadow_map->bind_debug_texture(info.options.light_type);
+        } else {
+          resources.bind_texture(scene_color, 0);
+        }
+        RenderAPI::draw_vertices(m_quad_vao, 6);
+      });
+  m_render_graph->compile();
+}
+
+void BasicRenderer::render_frame(const FrameInfo& info) {
+  EZG_PROFILE_FUNCTION();
+  RenderGraphKey key{};
+  key.has_skybox       = info.skybox != nullptr;
+  key.show_bg          = info.options.show_bg;
+  key.show_axis        = info.options.show_axis;
+  key.show_aabb        = info.options.show_aabb;
+  key.show_light_model = info.options.show_light_model;
+  key.show_floor       = info.options.show_floor;
+  key.show_depth_debug = info.options.show_depth_debug;
+  if (key != m_graph_key) {
+    build_render_graph(key);
   }
-  if (info.options->show_floor) {
-    render_meshes(info.scene->m_floor->get_meshes());
+  if (info.options.dump_render_graph) {
+    m_render_graph->dump("render_graph.dot");
   }
-  if (info.options->show_axis) {
-    m_shader_cache.at("lines")->use();
-    RenderAPI::draw_line(m_axis_line->vao, m_axis_line->line_vertices.size());
+
+  m_gpu_profiler->begin_frame();
+  m_frame_info = &info;
+  m_render_graph->execute();
+  m_frame_info = nullptr;
+  if (m_screen_buffer) {
+    const auto backbuffer = m_offscreen_target ? m_offscreen_target->get_id() : 0;
+    glBlitNamedFramebuffer(backbuffer, m_screen_buffer->get_id(), 0, 0, m_width, m_height, 0, 0,
+                           m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
   }
+  m_gpu_profiler->end_frame();
 }
 
-void BasicRenderer::render_frame(const FrameInfo& info) {
-  m_shadow_map->run_depth_pass(info.scene, info.options->light_type);
-  set_default_state();
-  m_pbuffer->bind_for_writing();
-  m_pbuffer->clear();
-  RenderAPI::enable_depth_testing();
-
-  update_ubo(info);
-  render_scene(info);
-
-  m_pbuffer->unbind();
-
-  RenderAPI::disable_depth_testing();
-  RenderAPI::clear_color();
-
-  auto& screen_shader = m_shader_cache.at("screen");
-  screen_shader->use();
-  if (info.options->show_depth_debug) {
-    m_shadow_map->bind_debug_texture(info.options->light_type);
-  } else {
-    m_pbuffer->bind_for_reading("color", 0);
+void BasicRenderer::set_cache_frames(bool enable) {
+  if (!enable) {
+    m_screen_buffer = nullptr;
+    return;
   }
+  if (!m_screen_buffer) {
+    MemoryOwnerScope owner{"BasicRenderer"};
+    RenderTargetInfo target_info{};
+    target_info.width                  = m_width;
+    target_info.height                 = m_height;
+    target_info.color_attachment_infos = {{"color", RTAttachmentFormat::RGBA8}};
+    target_info.has_depth              = false;
+    m_screen_buffer                    = RenderTarget::Create(target_info);
+  }
+}
 
-  RenderAPI::draw_vertices(m_quad_vao, 6);
+void BasicRenderer::present_cached_frame() {
+  EZG_PROFILE_FUNCTION();
+  const auto backbuffer = m_offscreen_target ? m_offscreen_target->get_id() : 0;
+  glBlitNamedFramebuffer(m_screen_buffer->get_id(), backbuffer, 0, 0, m_width, m_height, 0, 0,
+                         m_width, m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 }
 
 void BasicRenderer::resize_fbos(int width, int height) {
   m_width  = width;
   m_height = height;
-  setup_framebuffers(m_width, m_height);
+  // only the window sized attachments are recreated, the shadow map is left untouched
+  m_render_graph->resize(m_width, m_height);
+  if (m_offscreen_target) {
+    m_offscreen_target->resize(width, height);
+    m_render_graph->set_backbuffer(m_offscreen_target->get_id());
+  }
+  if (m_screen_buffer) {
+    m_screen_buffer->resize(width, height);
+  }
   glViewport(0, 0, width, height);
 }
-}  // namespace ezg::gl
\ No newline at end of file
+
+bool BasicRenderer::save_screenshot(const std::string& path) const {
+  const auto fbo = m_offscreen_target ? m_offscreen_target->get_id() : 0;
+  std::vector<uint8_t> pixels(static_cast<size_t>(m_width) * m_height * 3);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    spd::error("Failed to open {} for writing the screenshot", path);
+    return false;
+  }
+  file << "P6\n" << m_width << " " << m_height << "\n255\n";
+  // GL rows start at the bottom
+  const auto row_size = static_cast<std::streamsize>(m_width) * 3;
+  for (auto row = static_cast<int>(m_height) - 1; row >= 0; row--) {
+    file.write(reinterpret_cast<const char*>(pixels.data()) + row * row_size, row_size);
+  }
+  spd::info("Screenshot written to {}", path);
+  return true;
+}
+}  // namespace ezg::gl
@@ -1,6 +1,7 @@
 #ifndef EASYGRAPHICS_BASIC_RENDERER_HPP
 #define EASYGRAPHICS_BASIC_RENDERER_HPP
 
+#include <string>
 #include <vector>
 #include "base.hpp"
 #include "frame_info.hpp"
@@ -11,12 +12,31 @@ namespace ezg::gl {
 class Framebuffer;
 class VertexArray;
 class UniformBuffer;
+class RenderGraph;
+class GpuProfiler;
+class ShadowMap;
+class RenderTarget;
 struct Line;
 
 struct RendererConfig {
   const uint32_t width;
   const uint32_t height;
+  // present into an offscreen render target instead of the default framebuffer
+  const bool offscreen{false};
 };
+
+/// @brief Options that change the shape of the render graph, the graph is rebuilt when they do.
+struct RenderGraphKey {
+  bool has_skybox{false};
+  bool show_bg{false};
+  bool show_axis{false};
+  bool show_aabb{false};
+  bool show_light_model{false};
+  bool show_floor{false};
+  bool show_depth_debug{false};
+  bool operator==(const RenderGraphKey&) const = default;
+};
+
 class BasicRenderer {
 public:
   explicit BasicRenderer(const RendererConfig& config);
@@ -25,15 +45,24 @@ public:
 
   void resize_fbos(int width, int height);
 
+  /// @brief Keep a copy of every rendered image (without GUI) so it can be presented again.
+  void set_cache_frames(bool enable);
+  /// @brief Show the last rendered image instead of rendering the scene, needs set_cache_frames.
+  void present_cached_frame();
+
+  [[nodiscard]] const auto& get_gpu_profiler() const { return m_gpu_profiler; }
+
+  /// @brief Read back the presented image and write it as a binary PPM.
+  bool save_screenshot(const std::string& path) const;
+
 private:
   void compile_shaders(const std::vector<ShaderProgramCreateInfo>& shader_program_infos);
   void setup_ubos();
   void setup_screen_quad();
-  void setup_framebuffers(uint32_t width, uint32_t height);
   void setup_coordinate_axis();
+  void build_render_graph(const RenderGraphKey& key);
 
-  void render_meshes(const std::vector<Mesh>& meshes);
-  void render_scene(const FrameInfo& info);
+  void render_meshes(const std::vector<DrawItem>& draws);
 
   void update_ubo(const FrameInfo& info);
 
@@ -50,7 +79,11 @@ private:
   Ref<UniformBuffer> m_camera_ubo;
   Ref<UniformBuffer> m_pbr_sampler_ubo;
 
-  Ref<Framebuffer> m_pbuffer;
+  Ref<RenderGraph> m_render_graph;
+  Ref<GpuProfiler> m_gpu_profiler;
+  RenderGraphKey m_graph_key{};
+  // valid while the render graph executes
+  const FrameInfo* m_frame_info{nullptr};
 
   Ref<VertexArray> m_quad_vao;
   std::unordered_map<std::string, Ref<ShaderProgram>> m_shader_cache;
@@ -59,6 +92,10 @@ private:
   Ref<Line> m_aabb_line;
 
   Ref<ShadowMap> m_shadow_map;
+  // only in offscreen mode, stands in for the default framebuffer
+  Ref<RenderTarget> m_offscreen_target;
+  // copy of the last rendered image for on-demand rendering
+  Ref<RenderTarget> m_screen_buffer;
 };
 }  // namespace ezg::gl
 #endif  //EASYGRAPHICS_BASIC_RENDERER_HPP
@@ -0,0 +1,93 @@
+#include "draw_list_builder.hpp"
+#include <algorithm>
+#include "ezg_util/job_system.hpp"
+#include "ezg_util/profiler.hpp"
+
+namespace ezg::gl {
+// below this a range is cheaper to cull than to hand to another thread
+static constexpr size_t MinMeshesPerRange = 2048;
+
+Ref<DrawListBuilder> DrawListBuilder::Create(uint32_t num_threads) {
+  return CreateRef<DrawListBuilder>(num_threads);
+}
+
+DrawListBuilder::DrawListBuilder(uint32_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = util::JobSystem::Get().GetNumWorkers() + 1;
+  }
+  m_buckets.resize(num_threads);
+}
+
+void DrawListBuilder::build(const std::vector<Ref<Model>>& models, const Frustum& view_frustum,
+                            const Frustum& shadow_frustum, std::vector<DrawItem>& view_draws,
+                            std::vector<DrawItem>& shadow_draws) {
+  EZG_PROFILE_FUNCTION();
+  m_models         = &models;
+  m_view_frustum   = view_frustum;
+  m_shadow_frustum = shadow_frustum;
+  m_num_meshes     = 0;
+  m_mesh_offsets.clear();
+  for (const auto& model : models) {
+    m_mesh_offsets.push_back(m_num_meshes);
+    m_num_meshes += model->get_mesh_size();
+  }
+  const auto num_ranges = (m_num_meshes + MinMeshesPerRange - 1) / MinMeshesPerRange;
+  m_num_ranges = static_cast<uint32_t>(std::clamp<size_t>(num_ranges, 1, m_buckets.size()));
+
+  // one range per job, range 0 runs on the calling thread
+  util::ParallelFor(0, m_num_ranges, 1, [this](size_t begin, size_t end) {
+    for (auto range = begin; range < end; range++) {
+      build_range(static_cast<uint32_t>(range));
+    }
+  });
+
+  // appending in range order gives the same lists as a single range would
+  size_t view_count   = 0;
+  size_t shadow_count = 0;
+  for (uint32_t range = 0; range < m_num_ranges; range++) {
+    view_count += m_buckets[range].view.size();
+    shadow_count += m_buckets[range].shadow.size();
+  }
+  view_draws.clear();
+  shadow_draws.clear();
+  view_draws.reserve(view_count);
+  shadow_draws.reserve(shadow_count);
+  for (uint32_t range = 0; range < m_num_ranges; range++) {
+    const auto& bucket = m_buckets[range];
+    view_draws.insert(view_draws.end(), bucket.view.begin(), bucket.view.end());
+    shadow_draws.insert(shadow_draws.end(), bucket.shadow.begin(), bucket.shadow.end());
+  }
+  m_models = nullptr;
+}
+
+void DrawListBuilder::build_range(uint32_t range) {
+  EZG_PROFILE_ZONE("Cull Range");
+  auto& bucket = m_buckets[range];
+  bucket.view.clear();
+  bucket.shadow.clear();
+  const auto begin = m_num_meshes * range / m_num_ranges;
+  const auto end   = m_num_meshes * (range + 1) / m_num_ranges;
+  if (begin == end) {
+    return;
+  }
+  // last model starting at or before the range, empty models share their offset with the next
+  const auto first = std::upper_bound(m_mesh_offsets.begin(), m_mesh_offsets.end(), begin);
+  auto model_index  = static_cast<size_t>(first - m_mesh_offsets.begin()) - 1;
+  auto index = begin;
+  while (index < end) {
+    const auto& meshes = (*m_models)[model_index]->get_meshes();
+    const auto offset  = m_mesh_offsets[model_index];
+    const auto last    = std::min(end, offset + meshes.size());
+    for (; index < last; index++) {
+      const auto& mesh = meshes[index - offset];
+      if (m_view_frustum.intersects(mesh.bounds, mesh.model_matrix)) {
+        bucket.view.push_back({&mesh, mesh.model_matrix});
+      }
+      if (m_shadow_frustum.intersects(mesh.bounds, mesh.model_matrix)) {
+        bucket.shadow.push_back({&mesh, mesh.model_matrix});
+      }
+    }
+    model_index++;
+  }
+}
+}  // namespace ezg::gl
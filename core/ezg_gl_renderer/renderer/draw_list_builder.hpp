@@ -0,0 +1,51 @@
+#ifndef EASYGRAPHICS_DRAW_LIST_BUILDER_HPP
+#define EASYGRAPHICS_DRAW_LIST_BUILDER_HPP
+#include <vector>
+#include "base.hpp"
+#include "frame_info.hpp"
+#include "frustum.hpp"
+
+namespace ezg::gl {
+/// @brief Culls the meshes of a scene against the main and the shadow view in one pass.
+/// The meshes are split into contiguous ranges, every range fills its own buckets and the
+/// buckets are appended in range order, so the draw lists match a serial build exactly.
+/// The ranges run on the shared job system.
+class DrawListBuilder {
+public:
+  /// @brief num_threads is the number of ranges culled in parallel, 0 uses every job
+  /// system worker and the calling thread.
+  static Ref<DrawListBuilder> Create(uint32_t num_threads = 0);
+  explicit DrawListBuilder(uint32_t num_threads);
+
+  DrawListBuilder(DrawListBuilder&&)                 = delete;
+  DrawListBuilder(const DrawListBuilder&)            = delete;
+  DrawListBuilder& operator=(DrawListBuilder&&)      = delete;
+  DrawListBuilder& operator=(const DrawListBuilder&) = delete;
+
+  void build(const std::vector<Ref<Model>>& models, const Frustum& view_frustum,
+             const Frustum& shadow_frustum, std::vector<DrawItem>& view_draws,
+             std::vector<DrawItem>& shadow_draws);
+
+  [[nodiscard]] auto get_num_threads() const { return static_cast<uint32_t>(m_buckets.size()); }
+
+private:
+  // own cache lines, the jobs append to neighbouring buckets at the same time
+  struct alignas(64) Bucket {
+    std::vector<DrawItem> view;
+    std::vector<DrawItem> shadow;
+  };
+
+  void build_range(uint32_t range);
+
+  std::vector<Bucket> m_buckets;
+
+  // input of the current build
+  const std::vector<Ref<Model>>* m_models{nullptr};
+  std::vector<size_t> m_mesh_offsets;
+  Frustum m_view_frustum{};
+  Frustum m_shadow_frustum{};
+  size_t m_num_meshes{0};
+  uint32_t m_num_ranges{0};
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_DRAW_LIST_BUILDER_HPP
@@ -0,0 +1,46 @@
+#include "frame_info.hpp"
+#include "draw_list_builder.hpp"
+#include "ezg_util/profiler.hpp"
+#include "shadow_map.hpp"
+
+namespace ezg::gl {
+static void append_draws(const Ref<Model>& model, std::vector<DrawItem>& draws) {
+  for (const auto& mesh : model->get_meshes()) {
+    draws.push_back({&mesh, mesh.model_matrix});
+  }
+}
+
+void FrameInfo::capture(const Ref<BaseScene>& active_scene,
+                        const RenderOptions& render_options, const system::Camera& camera,
+                        DrawListBuilder& draw_lists) {
+  EZG_PROFILE_FUNCTION();
+  scene   = active_scene;
+  skybox  = active_scene->m_skybox;
+  options = render_options;
+
+  view       = camera.get_view_matrix();
+  projection = camera.get_projection_matrix();
+  camera_pos = camera.get_pos();
+
+  light_pos       = active_scene->get_light_pos();
+  light_dir       = active_scene->get_light_dir();
+  light_intensity = active_scene->get_light_intensity();
+  scene_aabb      = active_scene->get_aabb();
+  light_space_mat = ShadowMap::calc_light_space_mat(scene_aabb, light_pos, options.light_type);
+
+  draw_lists.build(active_scene->m_models, Frustum(projection * view), Frustum(light_space_mat),
+                   models, shadow_casters);
+  model_aabbs.clear();
+  for (const auto& model : active_scene->m_models) {
+    model_aabbs.push_back(model->get_aabb());
+  }
+  light_model.clear();
+  if (options.show_light_model) {
+    append_draws(active_scene->m_light_model, light_model);
+  }
+  floor.clear();
+  if (options.show_floor) {
+    append_draws(active_scene->m_floor, floor);
+  }
+}
+}  // namespace ezg::gl
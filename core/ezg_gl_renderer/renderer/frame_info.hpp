@@ -1,5 +1,6 @@
 #ifndef FRAME_INFO_HPP
 #define FRAME_INFO_HPP
+#include <vector>
 #include "engine/render_option.hpp"
 #include "ezg_gl_renderer/engine/scene.hpp"
 #include "systems/camera_system.hpp"
@@ -8,11 +9,44 @@ namespace ezg::gl {
 class ShaderProgram;
 class Model;
 class BaseScene;
+class DrawListBuilder;
 
+/// @brief One mesh draw of a frame, the matrix is copied so the scene can move on meanwhile.
+struct DrawItem {
+  const Mesh* mesh;
+  glm::mat4 model_matrix;
+};
+
+/// @brief Immutable copy of everything the renderer reads for one frame, filled by the
+/// simulation before the frame is handed to the renderer.
 struct FrameInfo {
-  const Ref<BaseScene>& scene;
-  const Ref<RenderOptions>& options;
-  const Ref<system::Camera>& camera;
+  /// @brief Copy the current state and cull the scene for the camera and the light, the
+  /// vectors keep their capacity between frames.
+  void capture(const Ref<BaseScene>& active_scene, const RenderOptions& render_options,
+               const system::Camera& camera, DrawListBuilder& draw_lists);
+
+  // draw lists point into the scene's meshes, scene loads wait until no frame is drawn
+  Ref<BaseScene> scene;
+  Ref<Skybox> skybox;
+  RenderOptions options{};
+
+  glm::mat4 view{1.0f};
+  glm::mat4 projection{1.0f};
+  glm::vec3 camera_pos{0.0f};
+
+  glm::vec3 light_pos{0.0f};
+  glm::vec3 light_dir{0.0f};
+  glm::vec3 light_intensity{0.0f};
+  AABB scene_aabb{};
+  glm::mat4 light_space_mat{1.0f};
+
+  // scene models inside the view frustum
+  std::vector<DrawItem> models;
+  // scene models inside the light frustum
+  std::vector<DrawItem> shadow_casters;
+  std::vector<DrawItem> light_model;
+  std::vector<DrawItem> floor;
+  std::vector<AABB> model_aabbs;
 };
 }  // namespace ezg::gl
 #endif  //FRAME_INFO_HPP
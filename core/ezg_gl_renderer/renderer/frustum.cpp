@@ -0,0 +1,29 @@
+#include "frustum.hpp"
+
+namespace ezg::gl {
+Frustum::Frustum(const glm::mat4& proj_view) {
+  // Gribb / Hartmann, rows of the matrix combined per plane
+  const auto m = glm::transpose(proj_view);
+  planes       = {m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2]};
+  for (auto& plane : planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+}
+
+bool Frustum::intersects(const AABB& bounds, const glm::mat4& model_matrix) const {
+  // world space box around the transformed box (Arvo), center and half extents
+  const auto local_center  = 0.5f * (bounds.bbx_min + bounds.bbx_max);
+  const auto local_extents = 0.5f * (bounds.bbx_max - bounds.bbx_min);
+  const auto center        = glm::vec3(model_matrix * glm::vec4(local_center, 1.0f));
+  const auto extents       = glm::vec3(glm::abs(model_matrix[0]) * local_extents.x +
+                                       glm::abs(model_matrix[1]) * local_extents.y +
+                                       glm::abs(model_matrix[2]) * local_extents.z);
+  for (const auto& plane : planes) {
+    const auto normal = glm::vec3(plane);
+    if (glm::dot(normal, center) + glm::dot(glm::abs(normal), extents) + plane.w < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace ezg::gl
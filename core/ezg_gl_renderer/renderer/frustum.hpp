@@ -0,0 +1,20 @@
+#ifndef EASYGRAPHICS_FRUSTUM_HPP
+#define EASYGRAPHICS_FRUSTUM_HPP
+#include <array>
+#include <glm/glm.hpp>
+#include "assets/aabb.hpp"
+
+namespace ezg::gl {
+/// @brief Clip space planes of a projection * view matrix, normals point inwards.
+struct Frustum {
+  Frustum() = default;
+  explicit Frustum(const glm::mat4& proj_view);
+
+  /// @brief Conservative test of an object space box under the model matrix, boxes near the
+  /// frustum corners can pass while being outside.
+  [[nodiscard]] bool intersects(const AABB& bounds, const glm::mat4& model_matrix) const;
+
+  std::array<glm::vec4, 6> planes{};
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_FRUSTUM_HPP
@@ -0,0 +1,180 @@
+#include "gpu_profiler.hpp"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <fstream>
+#include "log.hpp"
+
+namespace ezg::gl {
+static float elapsed_ms(uint32_t begin_query, uint32_t end_query) {
+  GLuint64 begin = 0;
+  GLuint64 end   = 0;
+  glGetQueryObjectui64v(begin_query, GL_QUERY_RESULT, &begin);
+  glGetQueryObjectui64v(end_query, GL_QUERY_RESULT, &end);
+  return end > begin ? static_cast<float>(end - begin) * 1e-6f : 0.0f;
+}
+
+Ref<GpuProfiler> GpuProfiler::Create(uint32_t window_size) {
+  return CreateRef<GpuProfiler>(window_size);
+}
+
+GpuProfiler::GpuProfiler(uint32_t window_size) : m_window_size(window_size) {
+  for (auto& frame : m_frames) {
+    glCreateQueries(GL_TIMESTAMP, QueriesPerFrame, frame.queries.data());
+    frame.scopes.reserve(MaxScopes);
+  }
+}
+
+GpuProfiler::~GpuProfiler() {
+  for (auto& frame : m_frames) {
+    glDeleteQueries(QueriesPerFrame, frame.queries.data());
+  }
+}
+
+void GpuProfiler::begin_frame() {
+  auto& frame = m_frames[m_frame_index % FramesInFlight];
+  if (frame.pending) {
+    // timestamps complete in order, the frame end query being ready means all of them are
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_TRUE || m_wait_for_results) {
+      collect(frame);
+      update_timings();
+    } else {
+      m_dropped_frames++;
+    }
+  }
+  frame.scopes.clear();
+  frame.num_used    = 2;
+  frame.frame_index = m_frame_index;
+  frame.pending     = false;
+  m_scope_stack.clear();
+  glQueryCounter(frame.queries[0], GL_TIMESTAMP);
+  m_in_frame = true;
+}
+
+void GpuProfiler::end_frame() {
+  if (!m_in_frame) {
+    return;
+  }
+  while (!m_scope_stack.empty()) {
+    spd::warn("GPU scope not closed before end of frame");
+    end_scope();
+  }
+  auto& frame = m_frames[m_frame_index % FramesInFlight];
+  glQueryCounter(frame.queries[1], GL_TIMESTAMP);
+  frame.pending = true;
+  m_in_frame    = false;
+  m_frame_index++;
+}
+
+void GpuProfiler::begin_scope(const std::string& name) {
+  glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name.c_str());
+  auto& frame = m_frames[m_frame_index % FramesInFlight];
+  if (!m_in_frame || frame.num_used + 2 > QueriesPerFrame) {
+    m_scope_stack.push_back(-1);
+    return;
+  }
+  m_scope_stack.push_back(static_cast<int>(frame.scopes.size()));
+  auto& scope       = frame.scopes.emplace_back();
+  scope.name        = name;
+  scope.begin_query = frame.num_used++;
+  scope.end_query   = frame.num_used++;
+  scope.depth       = static_cast<int>(m_scope_stack.size()) - 1;
+  glQueryCounter(frame.queries[scope.begin_query], GL_TIMESTAMP);
+}
+
+void GpuProfiler::end_scope() {
+  if (m_scope_stack.empty()) {
+    return;
+  }
+  auto index = m_scope_stack.back();
+  m_scope_stack.pop_back();
+  if (index >= 0) {
+    auto& frame = m_frames[m_frame_index % FramesInFlight];
+    glQueryCounter(frame.queries[frame.scopes[index].end_query], GL_TIMESTAMP);
+  }
+  glPopDebugGroup();
+}
+
+void GpuProfiler::flush() {
+  // oldest frame first so the frame callback sees frames in order
+  for (uint64_t i = 0; i < FramesInFlight; i++) {
+    auto& frame = m_frames[(m_frame_index + i) % FramesInFlight];
+    if (frame.pending) {
+      collect(frame);
+    }
+  }
+  update_timings();
+}
+
+void GpuProfiler::collect(FrameQueries& frame) {
+  frame.pending = false;
+  FrameRecord record{};
+  record.frame_index = frame.frame_index;
+  record.frame_ms    = elapsed_ms(frame.queries[0], frame.queries[1]);
+  record.scopes.reserve(frame.scopes.size());
+  for (const auto& scope : frame.scopes) {
+    auto& timing   = record.scopes.emplace_back();
+    timing.name    = scope.name;
+    timing.depth   = scope.depth;
+    timing.last_ms = elapsed_ms(frame.queries[scope.begin_query], frame.queries[scope.end_query]);
+  }
+  if (m_frame_callback) {
+    m_frame_callback(record.frame_index, record.frame_ms);
+  }
+  m_history.push_back(std::move(record));
+  while (m_history.size() > m_window_size) {
+    m_history.pop_front();
+  }
+}
+
+void GpuProfiler::update_timings() {
+  // scopes are matched by name and depth, in the order they first appear in the window
+  std::vector<GpuTiming> timings;
+  std::vector<uint32_t> counts;
+  float frame_sum = 0.0f;
+  for (const auto& record : m_history) {
+    frame_sum += record.frame_ms;
+    for (const auto& scope : record.scopes) {
+      uint32_t i = 0;
+      while (i < timings.size() &&
+             (timings[i].name != scope.name || timings[i].depth != scope.depth)) {
+        i++;
+      }
+      if (i == timings.size()) {
+        auto& timing = timings.emplace_back();
+        timing.name  = scope.name;
+        timing.depth = scope.depth;
+        counts.push_back(0);
+      }
+      timings[i].last_ms = scope.last_ms;
+      timings[i].avg_ms += scope.last_ms;
+      timings[i].max_ms = std::max(timings[i].max_ms, scope.last_ms);
+      counts[i]++;
+    }
+  }
+  for (uint32_t i = 0; i < timings.size(); i++) {
+    timings[i].avg_ms /= static_cast<float>(counts[i]);
+  }
+  m_frame_avg_ms = m_history.empty() ? 0.0f : frame_sum / static_cast<float>(m_history.size());
+  m_timings      = std::move(timings);
+}
+
+void GpuProfiler::export_csv(const std::string& path) const {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    spd::error("Failed to open {} for writing GPU timings", path);
+    return;
+  }
+  file << "frame,scope,depth,gpu_ms\n";
+  for (const auto& record : m_history) {
+    file << record.frame_index << ",frame,0," << record.frame_ms << "\n";
+    for (const auto& scope : record.scopes) {
+      file << record.frame_index << "," << scope.name << "," << scope.depth + 1 << ","
+           << scope.last_ms << "\n";
+    }
+  }
+  spd::info("GPU timings of {} frames written to {}", m_history.size(), path);
+}
+}  // namespace ezg::gl
@@ -0,0 +1,117 @@
+#ifndef EASYGRAPHICS_GPU_PROFILER_HPP
+#define EASYGRAPHICS_GPU_PROFILER_HPP
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include "base.hpp"
+
+namespace ezg::gl {
+struct GpuTiming {
+  std::string name;
+  int depth{0};
+  float last_ms{0.0f};
+  float avg_ms{0.0f};
+  float max_ms{0.0f};
+};
+
+/// @brief GPU timestamp queries around named scopes.
+/// Queries are ring-buffered over FramesInFlight frames and only read back once the
+/// driver reports them available, so collecting results never stalls the pipeline.
+class GpuProfiler {
+public:
+  static constexpr uint32_t FramesInFlight = 3;
+  static constexpr uint32_t MaxScopes      = 64;
+  using FrameCallback = std::function<void(uint64_t frame_index, float frame_ms)>;
+
+  static Ref<GpuProfiler> Create(uint32_t window_size = 120);
+  explicit GpuProfiler(uint32_t window_size);
+  ~GpuProfiler();
+
+  void begin_frame();
+  void end_frame();
+
+  /// @brief Open a timed scope, also pushed as a GL debug group for frame debuggers.
+  void begin_scope(const std::string& name);
+  void end_scope();
+
+  /// @brief Per scope timings averaged over the last window_size collected frames.
+  [[nodiscard]] const auto& get_timings() const { return m_timings; }
+  [[nodiscard]] auto get_frame_ms() const { return m_frame_avg_ms; }
+  [[nodiscard]] auto get_dropped_frames() const { return m_dropped_frames; }
+
+  /// @brief Write every frame in the averaging window as frame,scope,depth,gpu_ms rows.
+  void export_csv(const std::string& path) const;
+
+  /// @brief Called with the GPU time of every collected frame, in frame order.
+  void set_frame_callback(FrameCallback callback) { m_frame_callback = std::move(callback); }
+  /// @brief Wait for late results instead of dropping the frame, benchmarks need every frame.
+  void set_wait_for_results(bool wait) { m_wait_for_results = wait; }
+  /// @brief Block until every submitted frame has been collected.
+  void flush();
+
+private:
+  static constexpr uint32_t QueriesPerFrame = 2 * MaxScopes + 2;
+
+  struct Scope {
+    std::string name;
+    uint32_t begin_query;
+    uint32_t end_query;
+    int depth;
+  };
+
+  struct FrameQueries {
+    std::array<uint32_t, QueriesPerFrame> queries{};
+    std::vector<Scope> scopes;
+    uint32_t num_used{0};
+    uint64_t frame_index{0};
+    bool pending{false};
+  };
+
+  struct FrameRecord {
+    uint64_t frame_index;
+    float frame_ms;
+    std::vector<GpuTiming> scopes;
+  };
+
+  void collect(FrameQueries& frame);
+  void update_timings();
+
+  std::array<FrameQueries, FramesInFlight> m_frames;
+  // index into the current frame's scopes, -1 for scopes dropped because the pool is full
+  std::vector<int> m_scope_stack;
+  std::deque<FrameRecord> m_history;
+  std::vector<GpuTiming> m_timings;
+  uint32_t m_window_size;
+  uint64_t m_frame_index{0};
+  uint32_t m_dropped_frames{0};
+  float m_frame_avg_ms{0.0f};
+  bool m_in_frame{false};
+  bool m_wait_for_results{false};
+  FrameCallback m_frame_callback;
+};
+
+/// @brief RAII helper for GpuProfiler scopes, a null profiler turns it into a no-op.
+class GpuScope {
+public:
+  GpuScope(GpuProfiler* profiler, const std::string& name) : m_profiler(profiler) {
+    if (m_profiler) {
+      m_profiler->begin_scope(name);
+    }
+  }
+  ~GpuScope() {
+    if (m_profiler) {
+      m_profiler->end_scope();
+    }
+  }
+  GpuScope(const GpuScope&)            = delete;
+  GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+  GpuProfiler* m_profiler;
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_GPU_PROFILER_HPP
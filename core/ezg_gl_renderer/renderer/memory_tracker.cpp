@@ -0,0 +1,184 @@
+#include "memory_tracker.hpp"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include "log.hpp"
+
+namespace ezg::gl {
+static std::vector<std::string>& owner_stack() {
+  thread_local std::vector<std::string> stack;
+  return stack;
+}
+
+MemoryOwnerScope::MemoryOwnerScope(std::string owner) {
+  owner_stack().push_back(std::move(owner));
+}
+
+MemoryOwnerScope::~MemoryOwnerScope() {
+  owner_stack().pop_back();
+}
+
+const std::string& MemoryOwnerScope::GetCurrent() {
+  static const std::string untagged = "untagged";
+  const auto& stack = owner_stack();
+  return stack.empty() ? untagged : stack.back();
+}
+
+MemoryDomain MemoryTracker::get_domain(MemoryCategory category) {
+  return category >= MemoryCategory::HostImage ? MemoryDomain::CPU : MemoryDomain::GPU;
+}
+
+const char* MemoryTracker::get_category_name(MemoryCategory category) {
+  switch (category) {
+    case MemoryCategory::Texture:
+      return "Texture";
+    case MemoryCategory::Cubemap:
+      return "Cubemap";
+    case MemoryCategory::RenderTarget:
+      return "Render Target";
+    case MemoryCategory::Renderbuffer:
+      return "Renderbuffer";
+    case MemoryCategory::VertexBuffer:
+      return "Vertex Buffer";
+    case MemoryCategory::IndexBuffer:
+      return "Index Buffer";
+    case MemoryCategory::UniformBuffer:
+      return "Uniform Buffer";
+    case MemoryCategory::HostImage:
+      return "Host Image";
+    case MemoryCategory::HostGeometry:
+      return "Host Geometry";
+    default:
+      return "Unknown";
+  }
+}
+
+uint32_t MemoryTracker::get_bytes_per_texel(uint32_t internal_format) {
+  switch (internal_format) {
+    case GL_R8:
+      return 1;
+    case GL_RG8:
+    case GL_R16F:
+    case GL_DEPTH_COMPONENT16:
+      return 2;
+    case GL_RGB8:
+    case GL_SRGB8:
+      return 3;
+    case GL_RGBA8:
+    case GL_SRGB8_ALPHA8:
+    case GL_RG16F:
+    case GL_R32F:
+    case GL_R11F_G11F_B10F:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+      return 4;
+    case GL_RGB16F:
+      return 6;
+    case GL_RGBA16F:
+    case GL_RG32F:
+    case GL_DEPTH32F_STENCIL8:
+      return 8;
+    case GL_RGB32F:
+      return 12;
+    case GL_RGBA32F:
+      return 16;
+    default:
+      spd::warn("Unknown internal format {:#x}, assuming 4 bytes per texel", internal_format);
+      return 4;
+  }
+}
+
+uint64_t MemoryTracker::calc_texture_bytes(uint32_t internal_format, int width, int height,
+                                           int levels, int layers, int samples) {
+  const uint64_t texel_bytes = get_bytes_per_texel(internal_format);
+  uint64_t bytes             = 0;
+  for (int level = 0; level < levels; level++) {
+    bytes += static_cast<uint64_t>(std::max(width >> level, 1)) * std::max(height >> level, 1);
+  }
+  return bytes * texel_bytes * std::max(layers, 1) * std::max(samples, 1);
+}
+
+void MemoryTracker::add(MemoryCategory category, uint64_t bytes) {
+  auto& stats = m_categories[static_cast<size_t>(category)];
+  stats.bytes += bytes;
+  stats.count++;
+  stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes);
+  if (get_domain(category) == MemoryDomain::GPU) {
+    m_gpu_bytes += bytes;
+    m_gpu_peak_bytes = std::max(m_gpu_peak_bytes, m_gpu_bytes);
+  } else {
+    m_cpu_bytes += bytes;
+    m_cpu_peak_bytes = std::max(m_cpu_peak_bytes, m_cpu_bytes);
+  }
+}
+
+void MemoryTracker::remove(MemoryCategory category, uint64_t bytes) {
+  auto& stats = m_categories[static_cast<size_t>(category)];
+  stats.bytes -= bytes;
+  stats.count--;
+  if (get_domain(category) == MemoryDomain::GPU) {
+    m_gpu_bytes -= bytes;
+  } else {
+    m_cpu_bytes -= bytes;
+  }
+}
+
+void MemoryTracker::track(MemoryCategory category, uint64_t key, uint64_t bytes) {
+  std::lock_guard lock(m_mutex);
+  auto [it, inserted] = m_allocations.try_emplace({category, key});
+  if (!inserted) {
+    remove(category, it->second.bytes);
+  }
+  it->second.bytes = bytes;
+  it->second.owner = MemoryOwnerScope::GetCurrent();
+  add(category, bytes);
+}
+
+void MemoryTracker::untrack(MemoryCategory category, uint64_t key) {
+  std::lock_guard lock(m_mutex);
+  auto it = m_allocations.find({category, key});
+  if (it == m_allocations.end()) {
+    return;
+  }
+  remove(category, it->second.bytes);
+  m_allocations.erase(it);
+}
+
+MemorySnapshot MemoryTracker::snapshot() const {
+  std::lock_guard lock(m_mutex);
+  MemorySnapshot snapshot{};
+  snapshot.categories     = m_categories;
+  snapshot.gpu_bytes      = m_gpu_bytes;
+  snapshot.gpu_peak_bytes = m_gpu_peak_bytes;
+  snapshot.cpu_bytes      = m_cpu_bytes;
+  snapshot.cpu_peak_bytes = m_cpu_peak_bytes;
+  for (const auto& [key, allocation] : m_allocations) {
+    auto it = std::find_if(snapshot.owners.begin(), snapshot.owners.end(),
+                           [&](const auto& owner) { return owner.owner == allocation.owner; });
+    if (it == snapshot.owners.end()) {
+      it        = snapshot.owners.emplace(snapshot.owners.end());
+      it->owner = allocation.owner;
+    }
+    if (get_domain(key.first) == MemoryDomain::GPU) {
+      it->gpu_bytes += allocation.bytes;
+    } else {
+      it->cpu_bytes += allocation.bytes;
+    }
+    it->count++;
+  }
+  std::sort(snapshot.owners.begin(), snapshot.owners.end(), [](const auto& a, const auto& b) {
+    return a.gpu_bytes + a.cpu_bytes > b.gpu_bytes + b.cpu_bytes;
+  });
+  return snapshot;
+}
+
+void MemoryTracker::reset_peaks() {
+  std::lock_guard lock(m_mutex);
+  for (auto& stats : m_categories) {
+    stats.peak_bytes = stats.bytes;
+  }
+  m_gpu_peak_bytes = m_gpu_bytes;
+  m_cpu_peak_bytes = m_cpu_bytes;
+}
+}  // namespace ezg::gl
@@ -0,0 +1,115 @@
+#ifndef EASYGRAPHICS_MEMORY_TRACKER_HPP
+#define EASYGRAPHICS_MEMORY_TRACKER_HPP
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ezg::gl {
+enum class MemoryCategory : uint8_t {
+  // GPU
+  Texture,
+  Cubemap,
+  RenderTarget,
+  Renderbuffer,
+  VertexBuffer,
+  IndexBuffer,
+  UniformBuffer,
+  // CPU, decoded assets waiting for upload
+  HostImage,
+  HostGeometry,
+  Count
+};
+
+enum class MemoryDomain : uint8_t { GPU, CPU };
+
+struct MemoryCategoryStats {
+  uint64_t bytes{0};
+  uint64_t peak_bytes{0};
+  uint32_t count{0};
+};
+
+struct MemoryOwnerStats {
+  std::string owner;
+  uint64_t gpu_bytes{0};
+  uint64_t cpu_bytes{0};
+  uint32_t count{0};
+};
+
+struct MemorySnapshot {
+  std::array<MemoryCategoryStats, static_cast<size_t>(MemoryCategory::Count)> categories{};
+  uint64_t gpu_bytes{0};
+  uint64_t gpu_peak_bytes{0};
+  uint64_t cpu_bytes{0};
+  uint64_t cpu_peak_bytes{0};
+  // live allocations merged by owner, largest first
+  std::vector<MemoryOwnerStats> owners;
+
+  [[nodiscard]] const auto& get(MemoryCategory category) const {
+    return categories[static_cast<size_t>(category)];
+  }
+};
+
+/// @brief Tracks the size of every GL allocation (and decoded CPU side asset data) by category
+/// and owner. Sizes are computed from format, levels, layers and samples, drivers may pad them.
+class MemoryTracker {
+public:
+  static MemoryTracker& GetInstance() {
+    static MemoryTracker tracker;
+    return tracker;
+  }
+  MemoryTracker(const MemoryTracker&)            = delete;
+  MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+  static MemoryDomain get_domain(MemoryCategory category);
+  static const char* get_category_name(MemoryCategory category);
+  static uint32_t get_bytes_per_texel(uint32_t internal_format);
+  /// @brief Storage of a texture with a full or partial mip chain, cubemaps pass layers = 6.
+  static uint64_t calc_texture_bytes(uint32_t internal_format, int width, int height,
+                                     int levels = 1, int layers = 1, int samples = 1);
+
+  /// @brief Record an allocation owned by the current MemoryOwnerScope, tracking the same key
+  /// again replaces the previous size (resized storage).
+  void track(MemoryCategory category, uint64_t key, uint64_t bytes);
+  void untrack(MemoryCategory category, uint64_t key);
+
+  [[nodiscard]] MemorySnapshot snapshot() const;
+  /// @brief Restart the high-water marks from the current totals.
+  void reset_peaks();
+
+private:
+  MemoryTracker() = default;
+
+  struct Allocation {
+    uint64_t bytes{0};
+    std::string owner;
+  };
+
+  void add(MemoryCategory category, uint64_t bytes);
+  void remove(MemoryCategory category, uint64_t bytes);
+
+  mutable std::mutex m_mutex;
+  std::map<std::pair<MemoryCategory, uint64_t>, Allocation> m_allocations;
+  std::array<MemoryCategoryStats, static_cast<size_t>(MemoryCategory::Count)> m_categories{};
+  uint64_t m_gpu_bytes{0};
+  uint64_t m_gpu_peak_bytes{0};
+  uint64_t m_cpu_bytes{0};
+  uint64_t m_cpu_peak_bytes{0};
+};
+
+/// @brief Tags the allocations made on this thread while alive, the innermost scope wins.
+class MemoryOwnerScope {
+public:
+  explicit MemoryOwnerScope(std::string owner);
+  ~MemoryOwnerScope();
+  MemoryOwnerScope(const MemoryOwnerScope&)            = delete;
+  MemoryOwnerScope& operator=(const MemoryOwnerScope&) = delete;
+
+  static const std::string& GetCurrent();
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_MEMORY_TRACKER_HPP
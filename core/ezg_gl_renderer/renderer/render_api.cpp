@@ -2,6 +2,7 @@
 #include "assets/mesh.hpp"
 #include "assets/model.hpp"
 #include "graphics/vertex_array.hpp"
+#include "render_stats.hpp"
 
 namespace ezg::gl {
 void RenderAPI::enable_blending(int sfactor, int dfactor) {
@@ -32,16 +33,19 @@ void RenderAPI::draw_line(const std::shared_ptr<VertexArray>& vao, uint32_t num_
   vao->bind();
   glLineWidth(2.0f);
   glDrawArrays(GL_LINES, 0, num_vertices);
+  RenderStats::count_line_draw(num_vertices / 2);
 }
 
 void RenderAPI::draw_vertices(const std::shared_ptr<VertexArray>& vao,
                               uint32_t num_vertices) {
   vao->bind();
   glDrawArrays(GL_TRIANGLES, 0, num_vertices);
+  RenderStats::count_draw(num_vertices / 3);
 }
 void RenderAPI::draw_indices(const std::shared_ptr<VertexArray>& vao) {
   vao->bind();
   glDrawElements(GL_TRIANGLES, vao->get_index_buffer()->get_count(), GL_UNSIGNED_INT, nullptr);
+  RenderStats::count_draw(vao->get_index_buffer()->get_count() / 3);
 }
 
 
@@ -49,11 +53,13 @@ void RenderAPI::draw_meshes(const std::vector<Mesh>& meshes) {
   for (const auto& mesh : meshes) {
     mesh.vao->bind();
     glDrawElements(GL_TRIANGLES, mesh.num_indices, GL_UNSIGNED_INT, nullptr);
+    RenderStats::count_draw(mesh.num_indices / 3);
   }
 }
 
 void RenderAPI::draw_mesh(const Mesh& mesh) {
   mesh.vao->bind();
   glDrawElements(GL_TRIANGLES, mesh.num_indices, GL_UNSIGNED_INT, nullptr);
+  RenderStats::count_draw(mesh.num_indices / 3);
 }
 }  // namespace ezg::gl
\ No newline at end of file
@@ -0,0 +1,489 @@
+#include "render_graph.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "ezg_util/profiler.hpp"
+#include "gpu_profiler.hpp"
+#include "render_stats.hpp"
+#include "graphics/framebuffer.hpp"
+#include "log.hpp"
+#include "memory_tracker.hpp"
+
+namespace ezg::gl {
+static bool is_depth_format(GLenum format) {
+  switch (format) {
+    case GL_DEPTH_COMPONENT16:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32:
+    case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+    case GL_DEPTH32F_STENCIL8:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool has_stencil(GLenum format) {
+  return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+}
+
+TransientTexturePool::~TransientTexturePool() {
+  for (auto& entry : m_entries) {
+    GLuint id = entry.texture->get_id();
+    MemoryTracker::GetInstance().untrack(MemoryCategory::RenderTarget, id);
+    glDeleteTextures(1, &id);
+  }
+  m_entries.clear();
+}
+
+Ref<Attachment> TransientTexturePool::acquire(uint32_t width, uint32_t height,
+                                              GLenum internal_format) {
+  for (auto& entry : m_entries) {
+    if (!entry.in_use && entry.width == width && entry.height == height &&
+        entry.internal_format == internal_format) {
+      entry.in_use          = true;
+      entry.used_this_round = true;
+      return entry.texture;
+    }
+  }
+  MemoryOwnerScope owner{"RenderGraph"};
+  AttachmentInfo info = is_depth_format(internal_format)
+                            ? AttachmentInfo::Depth(width, height)
+                            : AttachmentInfo::Color("transient", AttachmentBinding::COLOR0, width,
+                                                    height);
+  info.internal_format = internal_format;
+  auto& entry           = m_entries.emplace_back();
+  entry.texture         = Attachment::Create(info);
+  entry.width           = width;
+  entry.height          = height;
+  entry.internal_format = internal_format;
+  entry.in_use          = true;
+  entry.used_this_round = true;
+  m_num_created++;
+  return entry.texture;
+}
+
+void TransientTexturePool::release(const Ref<Attachment>& texture) {
+  for (auto& entry : m_entries) {
+    if (entry.texture == texture) {
+      entry.in_use = false;
+      return;
+    }
+  }
+}
+
+void TransientTexturePool::reset() {
+  for (auto& entry : m_entries) {
+    entry.in_use          = false;
+    entry.used_this_round = false;
+  }
+}
+
+void TransientTexturePool::trim() {
+  auto it = std::remove_if(m_entries.begin(), m_entries.end(), [](const Entry& entry) {
+    if (entry.used_this_round) {
+      return false;
+    }
+    GLuint id = entry.texture->get_id();
+    MemoryTracker::GetInstance().untrack(MemoryCategory::RenderTarget, id);
+    glDeleteTextures(1, &id);
+    return true;
+  });
+  m_entries.erase(it, m_entries.end());
+}
+
+uint32_t RGResources::get_texture(RGHandle handle) const {
+  return m_graph.get_texture_id(handle);
+}
+
+void RGResources::bind_texture(RGHandle handle, int slot) const {
+  glBindTextureUnit(slot, m_graph.get_texture_id(handle));
+  RenderStats::count_texture_bind();
+}
+
+RGHandle RGPassBuilder::create(const std::string& name, const RGTextureDesc& desc) {
+  RGHandle handle = m_graph.m_resources.size();
+  auto& resource  = m_graph.m_resources.emplace_back();
+  resource.name   = name;
+  resource.desc   = desc;
+  m_graph.m_resource_lut.insert_or_assign(name, handle);
+  return write(handle);
+}
+
+RGHandle RGPassBuilder::read(RGHandle handle) {
+  m_graph.m_passes[m_pass_index].reads.push_back(handle);
+  return handle;
+}
+
+RGHandle RGPassBuilder::write(RGHandle handle) {
+  m_graph.m_passes[m_pass_index].writes.push_back(handle);
+  m_graph.m_resources[handle].writers.push_back(m_pass_index);
+  return handle;
+}
+
+void RGPassBuilder::write_backbuffer() {
+  m_graph.m_passes[m_pass_index].writes_backbuffer = true;
+  set_side_effect();
+}
+
+void RGPassBuilder::set_side_effect() {
+  m_graph.m_passes[m_pass_index].side_effect = true;
+}
+
+Ref<RenderGraph> RenderGraph::Create(uint32_t width, uint32_t height) {
+  return CreateRef<RenderGraph>(width, height);
+}
+
+RenderGraph::RenderGraph(uint32_t width, uint32_t height) : m_width(width), m_height(height) {}
+
+RenderGraph::~RenderGraph() {
+  destroy_framebuffers();
+}
+
+void RenderGraph::reset() {
+  m_passes.clear();
+  m_resources.clear();
+  m_resource_lut.clear();
+  m_compiled = false;
+}
+
+RGHandle RenderGraph::import_texture(const std::string& name, uint32_t texture_id, uint32_t width,
+                                     uint32_t height) {
+  RGHandle handle      = m_resources.size();
+  auto& resource       = m_resources.emplace_back();
+  resource.name        = name;
+  resource.imported    = true;
+  resource.imported_id = texture_id;
+  resource.width       = width;
+  resource.height      = height;
+  m_resource_lut.insert_or_assign(name, handle);
+  return handle;
+}
+
+void RenderGraph::add_pass(const std::string& name,
+                           const std::function<void(RGPassBuilder&)>& setup,
+                           RGExecuteFunc execute) {
+  uint32_t index = m_passes.size();
+  auto& pass     = m_passes.emplace_back();
+  pass.name      = name;
+  pass.zone_name = EZG_PROFILE_NAME(name);
+  pass.execute   = std::move(execute);
+  RGPassBuilder builder{*this, index};
+  setup(builder);
+  m_compiled = false;
+}
+
+void RenderGraph::compile() {
+  EZG_PROFILE_FUNCTION();
+  for (auto& resource : m_resources) {
+    if (!resource.imported) {
+      const auto& desc = resource.desc;
+      resource.width =
+          desc.width != 0 ? desc.width : std::max(1u, static_cast<uint32_t>(m_width * desc.scale));
+      resource.height = desc.height != 0
+                            ? desc.height
+                            : std::max(1u, static_cast<uint32_t>(m_height * desc.scale));
+    }
+  }
+  cull_passes();
+  compute_lifetimes();
+  allocate_textures();
+  setup_pass_framebuffers();
+  m_compiled = true;
+}
+
+void RenderGraph::cull_passes() {
+  for (auto& resource : m_resources) {
+    resource.ref_count = 0;
+  }
+  for (auto& pass : m_passes) {
+    pass.culled    = false;
+    pass.ref_count = pass.writes.size() + (pass.side_effect ? 1 : 0);
+    for (auto handle : pass.reads) {
+      m_resources[handle].ref_count++;
+    }
+  }
+  // flood backwards from resources nobody reads
+  std::vector<RGHandle> unreferenced;
+  for (RGHandle handle = 0; handle < m_resources.size(); handle++) {
+    if (m_resources[handle].ref_count == 0) {
+      unreferenced.push_back(handle);
+    }
+  }
+  while (!unreferenced.empty()) {
+    auto& resource = m_resources[unreferenced.back()];
+    unreferenced.pop_back();
+    for (auto writer : resource.writers) {
+      auto& pass = m_passes[writer];
+      if (pass.ref_count == 0 || --pass.ref_count > 0) {
+        continue;
+      }
+      pass.culled = true;
+      for (auto handle : pass.reads) {
+        if (--m_resources[handle].ref_count == 0) {
+          unreferenced.push_back(handle);
+        }
+      }
+    }
+  }
+}
+
+void RenderGraph::compute_lifetimes() {
+  for (auto& resource : m_resources) {
+    resource.first_use    = -1;
+    resource.last_use     = -1;
+    resource.first_writer = -1;
+  }
+  for (int i = 0; i < static_cast<int>(m_passes.size()); i++) {
+    const auto& pass = m_passes[i];
+    if (pass.culled) {
+      continue;
+    }
+    auto touch = [&](RGHandle handle) {
+      auto& resource = m_resources[handle];
+      if (resource.first_use < 0) {
+        resource.first_use = i;
+      }
+      resource.last_use = i;
+    };
+    std::for_each(pass.reads.begin(), pass.reads.end(), touch);
+    std::for_each(pass.writes.begin(), pass.writes.end(), touch);
+    for (auto handle : pass.writes) {
+      if (m_resources[handle].first_writer < 0) {
+        m_resources[handle].first_writer = i;
+      }
+    }
+  }
+}
+
+void RenderGraph::allocate_textures() {
+  const auto num_created = m_texture_pool.get_num_created();
+  m_texture_pool.reset();
+  for (auto& resource : m_resources) {
+    resource.texture.reset();
+  }
+  for (int i = 0; i < static_cast<int>(m_passes.size()); i++) {
+    if (m_passes[i].culled) {
+      continue;
+    }
+    for (auto& resource : m_resources) {
+      if (!resource.imported && resource.first_use == i) {
+        resource.texture =
+            m_texture_pool.acquire(resource.width, resource.height, resource.desc.internal_format);
+      }
+    }
+    // textures whose lifetime ends here may back resources of later passes
+    for (auto& resource : m_resources) {
+      if (!resource.imported && resource.last_use == i) {
+        m_texture_pool.release(resource.texture);
+      }
+    }
+  }
+  m_texture_pool.trim();
+  spd::trace("Render graph: {} pooled textures, {} created on this compile",
+             m_texture_pool.get_num_textures(), m_texture_pool.get_num_created() - num_created);
+}
+
+void RenderGraph::setup_pass_framebuffers() {
+  std::map<std::vector<uint32_t>, uint32_t> fbo_cache;
+  for (auto& pass : m_passes) {
+    pass.fbo = 0;
+    if (pass.culled) {
+      continue;
+    }
+    std::vector<RGHandle> targets;
+    std::vector<uint32_t> key;
+    for (auto handle : pass.writes) {
+      if (!m_resources[handle].imported) {
+        targets.push_back(handle);
+        key.push_back(get_texture_id(handle));
+      }
+    }
+    if (targets.empty()) {
+      continue;
+    }
+    if (auto it = fbo_cache.find(key); it != fbo_cache.end()) {
+      pass.fbo = it->second;
+      continue;
+    }
+    if (auto it = m_fbo_cache.find(key); it != m_fbo_cache.end()) {
+      // same textures as the previous compile, keep the framebuffer
+      pass.fbo = it->second;
+      m_fbo_cache.erase(it);
+      fbo_cache.emplace(key, pass.fbo);
+      continue;
+    }
+    glCreateFramebuffers(1, &pass.fbo);
+    std::vector<GLenum> buffers;
+    for (auto handle : targets) {
+      const auto& resource = m_resources[handle];
+      const auto format    = resource.desc.internal_format;
+      GLenum binding       = GL_COLOR_ATTACHMENT0 + buffers.size();
+      if (is_depth_format(format)) {
+        binding = has_stencil(format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+      } else {
+        buffers.push_back(binding);
+      }
+      glNamedFramebufferTexture(pass.fbo, binding, resource.texture->get_id(), 0);
+    }
+    if (buffers.empty()) {
+      glNamedFramebufferDrawBuffer(pass.fbo, GL_NONE);
+    } else {
+      glNamedFramebufferDrawBuffers(pass.fbo, buffers.size(), buffers.data());
+    }
+    auto status = glCheckNamedFramebufferStatus(pass.fbo, GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+      spd::error("Render graph framebuffer of pass {} is not complete, status {}", pass.name,
+                 status);
+    }
+    fbo_cache.emplace(key, pass.fbo);
+  }
+  destroy_framebuffers();
+  m_fbo_cache = std::move(fbo_cache);
+}
+
+void RenderGraph::destroy_framebuffers() {
+  for (auto& [key, fbo] : m_fbo_cache) {
+    glDeleteFramebuffers(1, &fbo);
+  }
+  m_fbo_cache.clear();
+}
+
+void RenderGraph::execute() {
+  if (!m_compiled) {
+    compile();
+  }
+  const float clear_color[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+  const float clear_depth    = 1.0f;
+  RGResources resources{*this};
+  for (uint32_t i = 0; i < m_passes.size(); i++) {
+    const auto& pass = m_passes[i];
+    if (pass.culled) {
+      continue;
+    }
+    EZG_PROFILE_ZONE(pass.zone_name);
+    GpuScope scope{m_profiler.get(), pass.name};
+    if (pass.fbo != 0) {
+      glBindFramebuffer(GL_FRAMEBUFFER, pass.fbo);
+      RenderStats::count_framebuffer_bind();
+      bool viewport_set = false;
+      int color_index   = 0;
+      for (auto handle : pass.writes) {
+        const auto& resource = m_resources[handle];
+        if (resource.imported) {
+          continue;
+        }
+        if (!viewport_set) {
+          glViewport(0, 0, resource.width, resource.height);
+          viewport_set = true;
+        }
+        const auto format = resource.desc.internal_format;
+        // pooled textures hold stale data, the first writer clears them
+        const bool first_write = resource.first_writer == static_cast<int>(i);
+        if (is_depth_format(format)) {
+          if (first_write) {
+            if (has_stencil(format)) {
+              glClearNamedFramebufferfi(pass.fbo, GL_DEPTH_STENCIL, 0, clear_depth, 0);
+            } else {
+              glClearNamedFramebufferfv(pass.fbo, GL_DEPTH, 0, &clear_depth);
+            }
+          }
+        } else {
+          if (first_write) {
+            glClearNamedFramebufferfv(pass.fbo, GL_COLOR, color_index, clear_color);
+          }
+          color_index++;
+        }
+      }
+    } else if (pass.writes_backbuffer) {
+      glBindFramebuffer(GL_FRAMEBUFFER, m_backbuffer_fbo);
+      RenderStats::count_framebuffer_bind();
+      glViewport(0, 0, m_width, m_height);
+    }
+    pass.execute(resources);
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderGraph::resize(uint32_t width, uint32_t height) {
+  if (width == m_width && height == m_height) {
+    return;
+  }
+  m_width  = width;
+  m_height = height;
+  if (m_compiled) {
+    compile();
+  }
+}
+
+RGHandle RenderGraph::find(const std::string& name) const {
+  auto it = m_resource_lut.find(name);
+  return it != m_resource_lut.end() ? it->second : InvalidRGHandle;
+}
+
+uint32_t RenderGraph::get_texture_id(RGHandle handle) const {
+  const auto& resource = m_resources[handle];
+  if (resource.imported) {
+    return resource.imported_id;
+  }
+  return resource.texture ? resource.texture->get_id() : 0;
+}
+
+std::string RenderGraph::dump() const {
+  std::stringstream ss;
+  ss << "digraph RenderGraph {\n";
+  ss << "  rankdir=LR;\n";
+  for (uint32_t i = 0; i < m_passes.size(); i++) {
+    const auto& pass = m_passes[i];
+    ss << "  pass" << i << " [shape=box, label=\"" << pass.name << "\"";
+    if (pass.culled) {
+      ss << ", style=dashed, fontcolor=gray, color=gray";
+    } else {
+      ss << ", style=filled, fillcolor=orange";
+    }
+    ss << "];\n";
+    for (auto handle : pass.reads) {
+      ss << "  res" << handle << " -> pass" << i << ";\n";
+    }
+    for (auto handle : pass.writes) {
+      ss << "  pass" << i << " -> res" << handle << ";\n";
+    }
+    if (pass.writes_backbuffer) {
+      ss << "  pass" << i << " -> backbuffer;\n";
+    }
+  }
+  for (uint32_t i = 0; i < m_resources.size(); i++) {
+    const auto& resource = m_resources[i];
+    ss << "  res" << i << " [shape=ellipse, label=\"" << resource.name << "\\n"
+       << resource.width << "x" << resource.height;
+    if (resource.imported) {
+      ss << "\\nimported tex " << resource.imported_id << "\", style=dashed";
+    } else {
+      ss << "\\nformat 0x" << std::hex << resource.desc.internal_format << std::dec;
+      if (resource.texture) {
+        ss << "\\ntex " << resource.texture->get_id() << " [" << resource.first_use << ", "
+           << resource.last_use << "]";
+      } else {
+        ss << "\\nunused";
+      }
+      ss << "\"";
+    }
+    ss << "];\n";
+  }
+  ss << "  backbuffer [shape=doublecircle];\n";
+  ss << "}\n";
+  return ss.str();
+}
+
+void RenderGraph::dump(const std::string& path) const {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    spd::error("Failed to open {} for writing render graph", path);
+    return;
+  }
+  file << dump();
+  spd::info("Render graph written to {}", path);
+}
+}  // namespace ezg::gl
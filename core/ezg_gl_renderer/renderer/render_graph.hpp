@@ -0,0 +1,184 @@
+#ifndef EASYGRAPHICS_RENDER_GRAPH_HPP
+#define EASYGRAPHICS_RENDER_GRAPH_HPP
+
+#include <glad/glad.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "base.hpp"
+
+namespace ezg::gl {
+class Attachment;
+class GpuProfiler;
+class RenderGraph;
+
+using RGHandle                     = uint32_t;
+constexpr RGHandle InvalidRGHandle = ~0u;
+
+/// @brief Description of a transient texture owned by the render graph.
+/// A zero width/height means the texture follows the graph's output size (times scale).
+struct RGTextureDesc {
+  GLenum internal_format{GL_RGBA8};
+  uint32_t width{0};
+  uint32_t height{0};
+  float scale{1.0f};
+};
+
+/// @brief Pool of physical textures backing transient graph resources.
+/// Textures are handed out by exact (width, height, format) match so that resources
+/// with disjoint lifetimes alias the same GL texture.
+class TransientTexturePool {
+public:
+  ~TransientTexturePool();
+
+  Ref<Attachment> acquire(uint32_t width, uint32_t height, GLenum internal_format);
+  void release(const Ref<Attachment>& texture);
+
+  /// @brief Begin a new allocation round, every pooled texture becomes available again.
+  void reset();
+  /// @brief Destroy textures that were not acquired since the last reset.
+  void trim();
+
+  [[nodiscard]] auto get_num_textures() const { return m_entries.size(); }
+  [[nodiscard]] auto get_num_created() const { return m_num_created; }
+
+private:
+  struct Entry {
+    Ref<Attachment> texture;
+    uint32_t width;
+    uint32_t height;
+    GLenum internal_format;
+    bool in_use{false};
+    bool used_this_round{false};
+  };
+  std::vector<Entry> m_entries;
+  uint32_t m_num_created{0};
+};
+
+/// @brief Resolves graph handles to GL objects while a pass executes.
+class RGResources {
+public:
+  explicit RGResources(const RenderGraph& graph) : m_graph(graph) {}
+  [[nodiscard]] uint32_t get_texture(RGHandle handle) const;
+  void bind_texture(RGHandle handle, int slot) const;
+
+private:
+  const RenderGraph& m_graph;
+};
+
+using RGExecuteFunc = std::function<void(const RGResources&)>;
+
+/// @brief Handed to a pass's setup callback to declare what the pass reads and writes.
+class RGPassBuilder {
+public:
+  RGPassBuilder(RenderGraph& graph, uint32_t pass_index)
+      : m_graph(graph), m_pass_index(pass_index) {}
+
+  RGHandle create(const std::string& name, const RGTextureDesc& desc);
+  RGHandle read(RGHandle handle);
+  RGHandle write(RGHandle handle);
+  /// @brief The pass renders into the default framebuffer, it is never culled.
+  void write_backbuffer();
+  /// @brief The pass has effects outside the graph, it is never culled.
+  void set_side_effect();
+
+private:
+  RenderGraph& m_graph;
+  uint32_t m_pass_index;
+};
+
+class RenderGraph {
+  friend class RGPassBuilder;
+  friend class RGResources;
+
+public:
+  static Ref<RenderGraph> Create(uint32_t width, uint32_t height);
+  RenderGraph(uint32_t width, uint32_t height);
+  ~RenderGraph();
+
+  /// @brief Drop all passes and resources, pooled textures are kept for the next build.
+  void reset();
+
+  RGHandle import_texture(const std::string& name, uint32_t texture_id, uint32_t width,
+                          uint32_t height);
+
+  void add_pass(const std::string& name, const std::function<void(RGPassBuilder&)>& setup,
+                RGExecuteFunc execute);
+
+  /// @brief Cull unused passes, compute resource lifetimes and assign pooled textures.
+  void compile();
+  void execute();
+
+  /// @brief Every executed pass is wrapped in a GPU timer scope named after the pass.
+  void set_profiler(Ref<GpuProfiler> profiler) { m_profiler = std::move(profiler); }
+
+  /// @brief Framebuffer bound by passes writing the backbuffer, 0 is the default framebuffer.
+  void set_backbuffer(uint32_t fbo) { m_backbuffer_fbo = fbo; }
+
+  /// @brief Update the output size, only textures whose size changed are recreated.
+  void resize(uint32_t width, uint32_t height);
+
+  /// @brief Graphviz representation of the compiled graph.
+  [[nodiscard]] std::string dump() const;
+  void dump(const std::string& path) const;
+
+  [[nodiscard]] RGHandle find(const std::string& name) const;
+  [[nodiscard]] auto get_width() const { return m_width; }
+  [[nodiscard]] auto get_height() const { return m_height; }
+
+private:
+  struct ResourceNode {
+    std::string name;
+    RGTextureDesc desc;
+    bool imported{false};
+    uint32_t imported_id{0};
+    uint32_t width{0};
+    uint32_t height{0};
+    std::vector<uint32_t> writers;
+    uint32_t ref_count{0};
+    int first_use{-1};
+    int last_use{-1};
+    // pooled textures hold stale data, the first writer clears them
+    int first_writer{-1};
+    Ref<Attachment> texture;
+  };
+
+  struct PassNode {
+    std::string name;
+    // interned copy of name for the CPU profiler
+    const char* zone_name{nullptr};
+    std::vector<RGHandle> reads;
+    std::vector<RGHandle> writes;
+    RGExecuteFunc execute;
+    bool side_effect{false};
+    bool writes_backbuffer{false};
+    uint32_t ref_count{0};
+    bool culled{false};
+    uint32_t fbo{0};
+  };
+
+  void cull_passes();
+  void compute_lifetimes();
+  void allocate_textures();
+  void setup_pass_framebuffers();
+  void destroy_framebuffers();
+  uint32_t get_texture_id(RGHandle handle) const;
+
+  uint32_t m_width;
+  uint32_t m_height;
+  bool m_compiled{false};
+  uint32_t m_backbuffer_fbo{0};
+
+  std::vector<PassNode> m_passes;
+  std::vector<ResourceNode> m_resources;
+  std::unordered_map<std::string, RGHandle> m_resource_lut;
+
+  TransientTexturePool m_texture_pool;
+  Ref<GpuProfiler> m_profiler;
+  // framebuffers are shared by passes writing the same set of textures
+  std::map<std::vector<uint32_t>, uint32_t> m_fbo_cache;
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_RENDER_GRAPH_HPP
@@ -0,0 +1,146 @@
+#include "render_stats.hpp"
+
+#include <glad/glad.h>
+#include <cstring>
+#include "log.hpp"
+
+namespace ezg::gl {
+static constexpr GLenum PipelineStatisticTargets[] = {
+    GL_VERTICES_SUBMITTED,
+    GL_PRIMITIVES_SUBMITTED,
+    GL_FRAGMENT_SHADER_INVOCATIONS,
+};
+
+RenderStats::~RenderStats() {
+  stop_json_dump();
+}
+
+void RenderStats::init() {
+  m_supports_pipeline_stats = GLAD_GL_VERSION_4_6;
+  GLint num_extensions      = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+  for (GLint i = 0; i < num_extensions && !m_supports_pipeline_stats; i++) {
+    const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+    m_supports_pipeline_stats = std::strcmp(name, "GL_ARB_pipeline_statistics_query") == 0;
+  }
+}
+
+void RenderStats::set_pipeline_statistics(bool enable) {
+  if (enable == m_pipeline_stats_enabled || m_in_frame) {
+    return;
+  }
+  if (enable) {
+    if (!supports_pipeline_statistics()) {
+      spd::warn("GL_ARB_pipeline_statistics_query is not supported");
+      return;
+    }
+    for (uint32_t i = 0; i < FramesInFlight; i++) {
+      for (uint32_t j = 0; j < NumStatistics; j++) {
+        glCreateQueries(PipelineStatisticTargets[j], 1, &m_queries[i][j]);
+      }
+    }
+  } else {
+    for (auto& queries : m_queries) {
+      glDeleteQueries(NumStatistics, queries.data());
+      queries.fill(0);
+    }
+    m_pending.fill(false);
+    m_has_pipeline_results = false;
+  }
+  m_pipeline_stats_enabled = enable;
+}
+
+void RenderStats::begin_frame() {
+  // m_current was reset by end_frame, work done between frames (scene loading) is
+  // attributed to this frame
+  m_current.frame_index = m_frame_index;
+  if (m_pipeline_stats_enabled) {
+    const auto slot = m_frame_index % FramesInFlight;
+    if (m_pending[slot]) {
+      read_pipeline_statistics();
+    }
+    for (uint32_t j = 0; j < NumStatistics; j++) {
+      glBeginQuery(PipelineStatisticTargets[j], m_queries[slot][j]);
+    }
+  }
+  m_in_frame = true;
+}
+
+void RenderStats::end_frame() {
+  if (!m_in_frame) {
+    return;
+  }
+  if (m_pipeline_stats_enabled) {
+    for (auto target : PipelineStatisticTargets) {
+      glEndQuery(target);
+    }
+    m_pending[m_frame_index % FramesInFlight] = true;
+  }
+  m_current.has_pipeline_statistics = m_has_pipeline_results;
+  m_current.vertices_submitted      = m_pipeline_results[0];
+  m_current.primitives_submitted    = m_pipeline_results[1];
+  m_current.fragment_invocations    = m_pipeline_results[2];
+
+  m_last = m_current;
+  if (m_json_file.is_open()) {
+    write_json(m_last);
+  }
+  m_current  = {};
+  m_in_frame = false;
+  m_frame_index++;
+}
+
+void RenderStats::read_pipeline_statistics() {
+  const auto slot = m_frame_index % FramesInFlight;
+  m_pending[slot] = false;
+  GLint available = GL_FALSE;
+  glGetQueryObjectiv(m_queries[slot][NumStatistics - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+  if (available != GL_TRUE) {
+    // never wait on the GPU, keep the previous results
+    return;
+  }
+  for (uint32_t j = 0; j < NumStatistics; j++) {
+    GLuint64 value = 0;
+    glGetQueryObjectui64v(m_queries[slot][j], GL_QUERY_RESULT, &value);
+    m_pipeline_results[j] = value;
+  }
+  m_has_pipeline_results = true;
+}
+
+void RenderStats::start_json_dump(const std::string& path) {
+  stop_json_dump();
+  m_json_file.open(path, std::ios::out | std::ios::trunc);
+  if (!m_json_file.is_open()) {
+    spd::error("Failed to open {} for writing render stats", path);
+    return;
+  }
+  spd::info("Dumping render stats to {}", path);
+}
+
+void RenderStats::stop_json_dump() {
+  if (m_json_file.is_open()) {
+    m_json_file.close();
+  }
+}
+
+void RenderStats::write_json(const FrameStats& stats) {
+  m_json_file << "{\"frame\":" << stats.frame_index << ",\"draw_calls\":" << stats.draw_calls
+              << ",\"triangles\":" << stats.triangles << ",\"lines\":" << stats.lines
+              << ",\"state_changes\":" << stats.get_state_changes()
+              << ",\"program_binds\":" << stats.program_binds
+              << ",\"vertex_array_binds\":" << stats.vertex_array_binds
+              << ",\"texture_binds\":" << stats.texture_binds
+              << ",\"framebuffer_binds\":" << stats.framebuffer_binds
+              << ",\"buffer_updates\":" << stats.buffer_updates
+              << ",\"upload_bytes\":" << stats.upload_bytes
+              << ",\"textures_created\":" << stats.textures_created
+              << ",\"buffers_created\":" << stats.buffers_created
+              << ",\"created_bytes\":" << stats.created_bytes;
+  if (stats.has_pipeline_statistics) {
+    m_json_file << ",\"vertices_submitted\":" << stats.vertices_submitted
+                << ",\"primitives_submitted\":" << stats.primitives_submitted
+                << ",\"fragment_invocations\":" << stats.fragment_invocations;
+  }
+  m_json_file << "}\n";
+}
+}  // namespace ezg::gl
@@ -0,0 +1,119 @@
+#ifndef EASYGRAPHICS_RENDER_STATS_HPP
+#define EASYGRAPHICS_RENDER_STATS_HPP
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace ezg::gl {
+struct FrameStats {
+  uint64_t frame_index{0};
+  uint32_t draw_calls{0};
+  uint64_t triangles{0};
+  uint64_t lines{0};
+  uint32_t program_binds{0};
+  uint32_t vertex_array_binds{0};
+  uint32_t texture_binds{0};
+  uint32_t framebuffer_binds{0};
+  uint32_t buffer_updates{0};
+  uint64_t upload_bytes{0};
+  uint32_t textures_created{0};
+  uint32_t buffers_created{0};
+  // initial data of the created buffers, upload_bytes only counts updates
+  uint64_t created_bytes{0};
+  // GL_ARB_pipeline_statistics_query, read back a few frames late to avoid stalls
+  bool has_pipeline_statistics{false};
+  uint64_t vertices_submitted{0};
+  uint64_t primitives_submitted{0};
+  uint64_t fragment_invocations{0};
+
+  [[nodiscard]] uint32_t get_state_changes() const {
+    return program_binds + vertex_array_binds + texture_binds + framebuffer_binds;
+  }
+};
+
+/// @brief Per-frame counters incremented by the GL wrappers (RenderAPI, buffers, textures,
+/// framebuffers), reset by begin_frame.
+class RenderStats {
+public:
+  static RenderStats& GetInstance() {
+    static RenderStats stats;
+    return stats;
+  }
+  RenderStats(const RenderStats&)            = delete;
+  RenderStats& operator=(const RenderStats&) = delete;
+  ~RenderStats();
+
+  static void count_draw(uint64_t triangles) {
+    auto& frame = GetInstance().m_current;
+    frame.draw_calls++;
+    frame.triangles += triangles;
+  }
+  static void count_line_draw(uint64_t lines) {
+    auto& frame = GetInstance().m_current;
+    frame.draw_calls++;
+    frame.lines += lines;
+  }
+  static void count_upload(uint64_t bytes) {
+    auto& frame = GetInstance().m_current;
+    frame.buffer_updates++;
+    frame.upload_bytes += bytes;
+  }
+  static void count_buffer_created(uint64_t bytes) {
+    auto& frame = GetInstance().m_current;
+    frame.buffers_created++;
+    frame.created_bytes += bytes;
+  }
+  static void count_texture_created() { GetInstance().m_current.textures_created++; }
+  static void count_program_bind() { GetInstance().m_current.program_binds++; }
+  static void count_vertex_array_bind() { GetInstance().m_current.vertex_array_binds++; }
+  static void count_texture_bind() { GetInstance().m_current.texture_binds++; }
+  static void count_framebuffer_bind() { GetInstance().m_current.framebuffer_binds++; }
+
+  void begin_frame();
+  void end_frame();
+
+  /// @brief Counters of the last finished frame.
+  [[nodiscard]] const auto& get_last_frame() const { return m_last; }
+
+  /// @brief Query the GL capabilities once, needs the GL context.
+  void init();
+
+  /// @brief Cached by init, safe to call without the GL context.
+  [[nodiscard]] bool supports_pipeline_statistics() const { return m_supports_pipeline_stats; }
+  /// @brief Creates or deletes the query objects, call it on the thread owning the GL context.
+  void set_pipeline_statistics(bool enable);
+  [[nodiscard]] auto is_pipeline_statistics_enabled() const { return m_pipeline_stats_enabled; }
+
+  /// @brief Append every finished frame as one JSON object per line to path.
+  void start_json_dump(const std::string& path);
+  void stop_json_dump();
+  [[nodiscard]] auto is_dumping_json() const { return m_json_file.is_open(); }
+
+private:
+  RenderStats() = default;
+
+  static constexpr uint32_t FramesInFlight = 3;
+  static constexpr uint32_t NumStatistics  = 3;
+
+  void read_pipeline_statistics();
+  void write_json(const FrameStats& stats);
+
+  FrameStats m_current{};
+  FrameStats m_last{};
+  uint64_t m_frame_index{0};
+
+  bool m_supports_pipeline_stats{false};
+  bool m_pipeline_stats_enabled{false};
+  bool m_in_frame{false};
+  // [frame][statistic] query objects
+  std::array<std::array<uint32_t, NumStatistics>, FramesInFlight> m_queries{};
+  std::array<bool, FramesInFlight> m_pending{};
+  std::array<uint64_t, NumStatistics> m_pipeline_results{};
+  bool m_has_pipeline_results{false};
+
+  std::ofstream m_json_file;
+};
+}  // namespace ezg::gl
+#endif  //EASYGRAPHICS_RENDER_STATS_HPP
@@ -1,8 +1,10 @@
 #include "shadow_map.hpp"
-#include "engine/scene.hpp"
+#include "frame_info.hpp"
 #include "graphics/framebuffer.hpp"
 #include "log.hpp"
+#include "memory_tracker.hpp"
 #include "render_api.hpp"
+#include "render_stats.hpp"
 
 namespace ezg::gl {
 ShadowMap::ShadowMap(uint32_t width, uint32_t height) : m_width(width), m_height(height) {
@@ -21,52 +23,76 @@ ShadowMap::ShadowMap(uint32_t width, uint32_t height) : m_width(width), m_height
   setup_framebuffer();
 }
 
-void ShadowMap::run_depth_pass(const Ref<BaseScene>& scene, const LightType& type) {
-  const auto& aabb = scene->get_aabb();
-  auto aabb_len    = glm::length(aabb.diag);
-  // set near far plane
-  m_near             = 0.01f * aabb_len;
-  m_far              = 10.0f * aabb_len;
-  const auto box_len = aabb_len * 2;
+ShadowMap::~ShadowMap() {
+  MemoryTracker::GetInstance().untrack(MemoryCategory::RenderTarget, m_depth_texture);
+  glDeleteTextures(1, &m_depth_texture);
+  glDeleteFramebuffers(1, &m_fbo);
+}
+
+static float calc_near_plane(const AABB& scene_aabb) {
+  return 0.01f * glm::length(scene_aabb.diag);
+}
+
+static float calc_far_plane(const AABB& scene_aabb) {
+  return 10.0f * glm::length(scene_aabb.diag);
+}
+
+glm::mat4 ShadowMap::calc_light_space_mat(const AABB& scene_aabb, const glm::vec3& light_pos,
+                                          LightType type) {
+  const auto near    = calc_near_plane(scene_aabb);
+  const auto far     = calc_far_plane(scene_aabb);
+  const auto box_len = glm::length(scene_aabb.diag) * 2;
 
   glm::mat4 light_view{1.0f};
   glm::mat4 light_proj{1.0f};
   if (type == LightType::Directional) {
-    light_proj = glm::ortho(-box_len, box_len, -box_len, box_len, m_near, m_far);
+    light_proj = glm::ortho(-box_len, box_len, -box_len, box_len, near, far);
     // for directional light, fix the light position
     light_view =
-        glm::lookAt(scene->get_aabb().bbx_max * 5.0f, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::lookAt(scene_aabb.bbx_max * 5.0f, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
   } else {
-    light_proj = glm::perspective(glm::radians(45.0f), 1.0f, m_near, m_far);
-    light_view = glm::lookAt(scene->get_light_pos(), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    light_proj = glm::perspective(glm::radians(45.0f), 1.0f, near, far);
+    light_view = glm::lookAt(light_pos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
   }
-  m_light_space_mat = light_proj * light_view;
+  return light_proj * light_view;
+}
+
+void ShadowMap::run_depth_pass(const FrameInfo& info) {
+  // the matrix was computed with the snapshot, the shadow casters are culled against it
+  m_near            = calc_near_plane(info.scene_aabb);
+  m_far             = calc_far_plane(info.scene_aabb);
+  m_light_space_mat = info.light_space_mat;
 
   glEnable(GL_DEPTH_TEST);
   glDepthFunc(GL_LESS);
   glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+  RenderStats::count_framebuffer_bind();
   glViewport(0, 0, m_width, m_height);
   // Clear the depth buffer of the shadow map
   glClearNamedFramebufferfv(m_fbo, GL_DEPTH, 0, &ClearDepth);
   m_depth_shader->use();
   m_depth_shader->set_uniform("uLightSpaceMat", m_light_space_mat);
-  for (const auto& model : scene->m_models) {
-    for (const auto& mesh : model->get_meshes()) {
-      m_depth_shader->set_uniform("uModelMat", mesh.model_matrix);
-      RenderAPI::draw_mesh(mesh);
-    }
+  for (const auto& draw : info.shadow_casters) {
+    m_depth_shader->set_uniform("uModelMat", draw.model_matrix);
+    RenderAPI::draw_mesh(*draw.mesh);
   }
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  RenderStats::count_framebuffer_bind();
 }
 
 void ShadowMap::setup_framebuffer() {
   glCreateFramebuffers(1, &m_fbo);
   glCreateTextures(GL_TEXTURE_2D, 1, &m_depth_texture);
+  RenderStats::count_texture_created();
   glTextureParameteri(m_depth_texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTextureParameteri(m_depth_texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTextureParameteri(m_depth_texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
   glTextureParameteri(m_depth_texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
   glTextureStorage2D(m_depth_texture, 1, GL_DEPTH_COMPONENT32F, m_width, m_height);
+  MemoryOwnerScope owner{"ShadowMap"};
+  MemoryTracker::GetInstance().track(
+      MemoryCategory::RenderTarget, m_depth_texture,
+      MemoryTracker::calc_texture_bytes(GL_DEPTH_COMPONENT32F, m_width, m_height));
   const float border_color[] = {1.0f, 1.0f, 1.0f, 1.0f};
   glTextureParameterfv(m_depth_texture, GL_TEXTURE_BORDER_COLOR, border_color);
   glNamedFramebufferTexture(m_fbo, GL_DEPTH_ATTACHMENT, m_depth_texture, 0);
@@ -81,6 +107,7 @@ void ShadowMap::setup_framebuffer() {
 
 void ShadowMap::bind_for_read(int slot) {
   glBindTextureUnit(slot, m_depth_texture);
+  RenderStats::count_texture_bind();
   //  m_fbo->bind_for_reading("depth", slot);
 }
 
@@ -90,5 +117,6 @@ void ShadowMap::bind_debug_texture(const LightType& type) {
   m_debug_shader->set_uniform("uFar", m_far);
   m_debug_shader->set_uniform("uLightType", static_cast<int>(type));
   glBindTextureUnit(0, m_depth_texture);
+  RenderStats::count_texture_bind();
 }
 }  // namespace ezg::gl
\ No newline at end of file
@@ -2,20 +2,28 @@
 #define EASYGRAPHICS_SHADOW_MAP_FBO_HPP
 #include "base.hpp"
 #include "engine/render_option.hpp"
-#include <glm/mat4x4.hpp>
+#include <glm/glm.hpp>
 
 namespace ezg::gl {
 class Framebuffer;
-class BaseScene;
+struct FrameInfo;
+struct AABB;
 class ShaderProgram;
 
 class ShadowMap {
 public:
   ShadowMap(uint32_t width, uint32_t height);
-  void run_depth_pass(const Ref<BaseScene>& scene, const LightType& type);
+  ~ShadowMap();
+  /// @brief View projection of the light, shared by the depth pass and shadow caster culling.
+  static glm::mat4 calc_light_space_mat(const AABB& scene_aabb, const glm::vec3& light_pos,
+                                        LightType type);
+  void run_depth_pass(const FrameInfo& info);
   void bind_for_read(int slot);
   void bind_debug_texture(const LightType& type);
   auto get_light_space_mat() const { return m_light_space_mat; }
+  auto get_depth_texture() const { return m_depth_texture; }
+  auto get_width() const { return m_width; }
+  auto get_height() const { return m_height; }
 private:
   void setup_framebuffer();
   uint32_t m_fbo{0};
@@ -138,6 +138,13 @@ void Camera::update(float deltaTime, bool rotate) {
   }
 }
 
+void Camera::set_pose(const CameraPose& pose) {
+  m_position = pose.position;
+  m_yaw      = pose.yaw;
+  m_pitch    = pose.pitch;
+  update_base_vectors();
+}
+
 void Camera::update_aspect(float aspect) {
   m_aspect = aspect;
   set_projection_matrix();
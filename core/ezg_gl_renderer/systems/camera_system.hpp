@@ -5,6 +5,13 @@
 #include "base.hpp"
 using namespace ezg::gl;
 namespace ezg::system {
+/// @brief Everything needed to restore a camera view, used to record and replay camera paths.
+struct CameraPose {
+  glm::vec3 position{0.0f};
+  float yaw{-90.0f};
+  float pitch{0.0f};
+};
+
 class Camera {
 public:
   static Ref<Camera> Create(const glm::vec3& bbox_min, const glm::vec3& bbox_max,
@@ -21,6 +28,9 @@ public:
   void update(float deltaTime, bool rotate = false);
   void update_aspect(float aspect);
 
+  [[nodiscard]] CameraPose get_pose() const { return {m_position, m_yaw, m_pitch}; }
+  void set_pose(const CameraPose& pose);
+
 private:
   void set_projection_matrix();
   void update_base_vectors();
@@ -1,5 +1,9 @@
 #include "gui_system.hpp"
+#include "ezg_util/profiler.hpp"
 #include "log.hpp"
+#include "renderer/gpu_profiler.hpp"
+#include "renderer/memory_tracker.hpp"
+#include "renderer/render_stats.hpp"
 
 namespace ezg::system {
 static const char* glsl_version = "#version 450";
@@ -22,9 +26,11 @@ GUISystem::GUISystem(GLFWwindow* glfw_window) {
   ImGui::StyleColorsDark();
   ImGui_ImplGlfw_InitForOpenGL(glfw_window, true);
   ImGui_ImplOpenGL3_Init(glsl_version);
+  // created up front, ImGui_ImplOpenGL3_NewFrame is a GL free no-op afterwards
+  ImGui_ImplOpenGL3_CreateDeviceObjects();
 }
 
-void GUISystem::draw(Ref<gl::RenderOptions> options) {
+void GUISystem::build(Ref<gl::RenderOptions> options, const Ref<gl::GpuProfiler>& gpu_profiler) {
   begin_frame();
   {
     ImGui::SetNextWindowSize(ImVec2(300, 300));
@@ -40,6 +46,10 @@ void GUISystem::draw(Ref<gl::RenderOptions> options) {
     ImGui::SameLine();
     ImGui::Checkbox("Show AABB", &options->show_aabb);
     ImGui::Checkbox("Show Depth Debug", &options->show_depth_debug);
+    ImGui::SameLine();
+    if (ImGui::Button("Dump Render Graph")) {
+      options->dump_render_graph = true;
+    }
 
     options->scene_changed = ImGui::Combo("Select Model", &options->selected_model,
                                           options->model_list, options->num_models);
@@ -68,10 +78,119 @@ void GUISystem::draw(Ref<gl::RenderOptions> options) {
         ImGui::Checkbox("Rotate Light", &options->rotate_light);
       }
     }
+    if (ImGui::CollapsingHeader("Render Stats")) {
+      draw_render_stats(*options);
+    }
+    if (ImGui::CollapsingHeader("Memory")) {
+      draw_memory_stats();
+    }
+    if (gpu_profiler && ImGui::CollapsingHeader("GPU Timings")) {
+      draw_gpu_timings(gpu_profiler);
+    }
+#ifdef EZG_ENABLE_PROFILER
+    if (ImGui::CollapsingHeader("CPU Zones")) {
+      draw_cpu_zones();
+    }
+#endif
     ImGui::End();
   }
   end_frame();
-  render_frame();
+}
+
+void GUISystem::draw_gpu_timings(const Ref<gl::GpuProfiler>& gpu_profiler) {
+  const float frame_ms = gpu_profiler->get_frame_ms();
+  ImGui::Text("GPU frame: %.3f ms", frame_ms);
+  for (const auto& timing : gpu_profiler->get_timings()) {
+    // bar length is the share of the GPU frame spent in the pass
+    const float fraction = frame_ms > 0.0f ? timing.avg_ms / frame_ms : 0.0f;
+    char overlay[32];
+    snprintf(overlay, sizeof(overlay), "%.3f ms", timing.avg_ms);
+    ImGui::Text("%*s%s", timing.depth * 2, "", timing.name.c_str());
+    ImGui::SameLine(100.0f);
+    ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f), overlay);
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("last %.3f ms, max %.3f ms", timing.last_ms, timing.max_ms);
+    }
+  }
+  if (ImGui::Button("Export CSV")) {
+    gpu_profiler->export_csv("gpu_timings.csv");
+  }
+}
+
+void GUISystem::draw_cpu_zones() {
+  auto& profiler = util::Profiler::Get();
+  ImGui::Text("CPU frame: %.3f ms", profiler.GetLastFrameMs());
+  for (const auto& zone : profiler.GetFrameStats()) {
+    ImGui::Text("%-20s %7.3f ms x%u", zone.name, zone.total_ms, zone.count);
+  }
+  if (ImGui::Button("Export Trace")) {
+    if (profiler.ExportChromeTrace("cpu_trace.json")) {
+      spd::info("CPU trace written to cpu_trace.json");
+    }
+  }
+}
+
+void GUISystem::draw_render_stats(gl::RenderOptions& options) {
+  auto& render_stats = gl::RenderStats::GetInstance();
+  const auto& stats  = render_stats.get_last_frame();
+  ImGui::Text("Draw calls:     %u", stats.draw_calls);
+  ImGui::Text("Triangles:      %llu", static_cast<unsigned long long>(stats.triangles));
+  ImGui::Text("Lines:          %llu", static_cast<unsigned long long>(stats.lines));
+  ImGui::Text("State changes:  %u", stats.get_state_changes());
+  ImGui::Text("  programs %u, vaos %u, textures %u, fbos %u", stats.program_binds,
+              stats.vertex_array_binds, stats.texture_binds, stats.framebuffer_binds);
+  ImGui::Text("Buffer updates: %u (%.1f KB)", stats.buffer_updates,
+              static_cast<double>(stats.upload_bytes) / 1024.0);
+  ImGui::Text("Created:        %u textures, %u buffers (%.1f KB)", stats.textures_created,
+              stats.buffers_created, static_cast<double>(stats.created_bytes) / 1024.0);
+
+  // the next packet carries the toggle to the render thread
+  ImGui::BeginDisabled(!options.pipeline_statistics &&
+                       !render_stats.supports_pipeline_statistics());
+  ImGui::Checkbox("Pipeline Statistics", &options.pipeline_statistics);
+  ImGui::EndDisabled();
+  if (stats.has_pipeline_statistics) {
+    ImGui::Text("Vertices:       %llu", static_cast<unsigned long long>(stats.vertices_submitted));
+    ImGui::Text("Primitives:     %llu",
+                static_cast<unsigned long long>(stats.primitives_submitted));
+    ImGui::Text("Fragments:      %llu",
+                static_cast<unsigned long long>(stats.fragment_invocations));
+  }
+
+  bool dump_json = render_stats.is_dumping_json();
+  if (ImGui::Checkbox("Dump Stats JSON", &dump_json)) {
+    if (dump_json) {
+      render_stats.start_json_dump("render_stats.jsonl");
+    } else {
+      render_stats.stop_json_dump();
+    }
+  }
+}
+
+void GUISystem::draw_memory_stats() {
+  constexpr double MB = 1024.0 * 1024.0;
+  const auto snapshot = gl::MemoryTracker::GetInstance().snapshot();
+  ImGui::Text("GPU: %.2f MB (peak %.2f MB)", snapshot.gpu_bytes / MB, snapshot.gpu_peak_bytes / MB);
+  ImGui::Text("CPU: %.2f MB (peak %.2f MB)", snapshot.cpu_bytes / MB, snapshot.cpu_peak_bytes / MB);
+  if (ImGui::Button("Reset Peaks")) {
+    gl::MemoryTracker::GetInstance().reset_peaks();
+  }
+  if (ImGui::TreeNode("Categories")) {
+    for (uint32_t i = 0; i < snapshot.categories.size(); i++) {
+      const auto& stats = snapshot.categories[i];
+      ImGui::Text("%-15s %4u %9.2f MB (peak %.2f MB)",
+                  gl::MemoryTracker::get_category_name(static_cast<gl::MemoryCategory>(i)),
+                  stats.count, stats.bytes / MB, stats.peak_bytes / MB);
+    }
+    ImGui::TreePop();
+  }
+  if (ImGui::TreeNode("Assets")) {
+    for (const auto& owner : snapshot.owners) {
+      ImGui::Text("%-24s %4u GPU %8.2f MB CPU %8.2f MB", owner.owner.c_str(), owner.count,
+                  owner.gpu_bytes / MB, owner.cpu_bytes / MB);
+    }
+    ImGui::TreePop();
+  }
 }
 
 void GUISystem::begin_frame() {
@@ -82,12 +201,43 @@ void GUISystem::begin_frame() {
 }
 
 void GUISystem::end_frame() {
-  ImGui::EndFrame();
+  // the draw data stays valid until the next begin_frame
+  ImGui::Render();
 }
 
-void GUISystem::render_frame() {
-  ImGui::Render();
+void GUISystem::render() {
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
+GuiDrawData::~GuiDrawData() {
+  clear();
+}
+
+void GuiDrawData::capture(const ImDrawData* draw_data) {
+  clear();
+  if (draw_data == nullptr || !draw_data->Valid) {
+    return;
+  }
+  m_draw_data = *draw_data;
+  m_cmd_lists.reserve(draw_data->CmdListsCount);
+  for (int i = 0; i < draw_data->CmdListsCount; i++) {
+    m_cmd_lists.push_back(draw_data->CmdLists[i]->CloneOutput());
+  }
+  m_draw_data.CmdLists = m_cmd_lists.data();
+}
+
+void GuiDrawData::render() {
+  if (m_draw_data.Valid) {
+    ImGui_ImplOpenGL3_RenderDrawData(&m_draw_data);
+  }
+}
+
+void GuiDrawData::clear() {
+  for (auto* cmd_list : m_cmd_lists) {
+    IM_DELETE(cmd_list);
+  }
+  m_cmd_lists.clear();
+  m_draw_data.Clear();
+}
+
 }  // namespace ezg::system
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include <vector>
 #include <string>
 using namespace ezg::gl;
+namespace ezg::gl {
+class GpuProfiler;
+}
 namespace ezg::system {
 class GUISystem {
   friend class Engine;
@@ -16,12 +19,41 @@ public:
   GUISystem(GLFWwindow* glfw_window);
   ~GUISystem();
 
-  void draw(Ref<gl::RenderOptions> options);
+  /// @brief Run the widgets and record the draw lists, issues no GL calls.
+  void build(Ref<gl::RenderOptions> options, const Ref<gl::GpuProfiler>& gpu_profiler = nullptr);
+  /// @brief Draw the lists recorded by the last build, needs the GL context.
+  void render();
 
 private:
   void begin_frame();
   void end_frame();
-  void render_frame();
+
+  void draw_gpu_timings(const Ref<gl::GpuProfiler>& gpu_profiler);
+  void draw_cpu_zones();
+  void draw_render_stats(gl::RenderOptions& options);
+  void draw_memory_stats();
+};
+
+/// @brief Deep copy of ImGui's draw lists, the render thread draws the copy while the next GUI
+/// frame is built.
+class GuiDrawData {
+public:
+  GuiDrawData() = default;
+  ~GuiDrawData();
+
+  GuiDrawData(GuiDrawData&&)                 = delete;
+  GuiDrawData(const GuiDrawData&)            = delete;
+  GuiDrawData& operator=(GuiDrawData&&)      = delete;
+  GuiDrawData& operator=(const GuiDrawData&) = delete;
+
+  void capture(const ImDrawData* draw_data);
+  void render();
+
+private:
+  void clear();
+
+  ImDrawData m_draw_data{};
+  std::vector<ImDrawList*> m_cmd_lists;
 };
 }  // namespace ezg::system
 #endif  //EASYGRAPHICS_GUI_SYSTEM_HPP
@@ -1,101 +1,127 @@
 #include "input_system.hpp"
+#include <chrono>
 
 namespace ezg::system {
+static double now_seconds() {
+  using Clock             = std::chrono::steady_clock;
+  static const auto start = Clock::now();
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
 
-void KeyboardMouseInput::press_key(const std::int32_t key) {
+void KeyboardMouseInput::push_event(InputEventType type, std::int32_t code, double x, double y) {
+  if (!m_events.TryPush({type, code, x, y, now_seconds()})) {
+    m_dropped_events.fetch_add(1, std::memory_order_relaxed);
+  }
+}
 
-  std::scoped_lock lock(m_input_mutex);
-  m_key_pressed[key] = true;
-  m_keyboard_updated = true;
+void KeyboardMouseInput::press_key(const std::int32_t key) {
+  push_event(InputEventType::KeyPress, key);
 }
 
 void KeyboardMouseInput::release_key(const std::int32_t key) {
-  std::scoped_lock lock(m_input_mutex);
-  m_key_pressed[key] = false;
-  m_keyboard_updated = true;
+  push_event(InputEventType::KeyRelease, key);
 }
 
 bool KeyboardMouseInput::is_key_pressed(const std::int32_t key) const {
-  std::shared_lock lock(m_input_mutex);
-  return m_key_pressed[key];
+  return m_snapshot.keys_down[key];
 }
-bool KeyboardMouseInput::was_key_pressed_once(const std::int32_t key) {
-  std::scoped_lock lock(m_input_mutex);
-  if (!m_key_pressed[key] || !m_keyboard_updated) {
-    return false;
-  }
 
-  m_key_pressed[key] = false;
-  return true;
+bool KeyboardMouseInput::was_key_pressed_once(const std::int32_t key) const {
+  return m_snapshot.keys_pressed[key];
 }
 
 void KeyboardMouseInput::press_mouse_button(const std::int32_t button) {
-
-  std::scoped_lock lock(m_input_mutex);
-  m_mouse_button_pressed[button] = true;
-  m_mouse_buttons_updated        = true;
+  push_event(InputEventType::MouseButtonPress, button);
 }
 
 void KeyboardMouseInput::release_mouse_button(const std::int32_t button) {
-  std::scoped_lock lock(m_input_mutex);
-  m_mouse_button_pressed[button] = false;
-  m_mouse_buttons_updated        = true;
+  push_event(InputEventType::MouseButtonRelease, button);
 }
 
 bool KeyboardMouseInput::is_mouse_button_pressed(const std::int32_t button) const {
-  std::shared_lock lock(m_input_mutex);
-  return m_mouse_button_pressed[button];
+  return m_snapshot.mouse_buttons_down[button];
 }
 
-bool KeyboardMouseInput::was_mouse_button_pressed_once(const std::int32_t button) {
-  std::scoped_lock lock(m_input_mutex);
-  if (!m_mouse_button_pressed[button] || !m_mouse_buttons_updated) {
-    return false;
-  }
-
-  m_mouse_button_pressed[button] = false;
-  return true;
+bool KeyboardMouseInput::was_mouse_button_pressed_once(const std::int32_t button) const {
+  return m_snapshot.mouse_buttons_pressed[button];
 }
 
 void KeyboardMouseInput::set_cursor_pos(const double pos_x, const double pos_y) {
-  std::scoped_lock lock(m_input_mutex);
-  if (m_first_mouse) {
-    m_previous_cursor_pos[0] = pos_x;
-    m_previous_cursor_pos[1] = pos_y;
-    m_first_mouse = false;
-  }
-  if (!m_mouse_paused) {
-    m_current_cursor_pos[0] = static_cast<std::int64_t>(pos_x);
-    m_current_cursor_pos[1] = static_cast<std::int64_t>(pos_y);
-  }
+  push_event(InputEventType::CursorPos, 0, pos_x, pos_y);
 }
 
 std::array<std::int64_t, 2> KeyboardMouseInput::get_cursor_pos() const {
-  std::shared_lock lock(m_input_mutex);
-  return m_current_cursor_pos;
+  return {static_cast<std::int64_t>(m_snapshot.cursor_pos[0]),
+          static_cast<std::int64_t>(m_snapshot.cursor_pos[1])};
+}
+
+std::array<double, 2> KeyboardMouseInput::calculate_cursor_position_delta() const {
+  return m_snapshot.cursor_delta;
 }
 
-std::array<double, 2> KeyboardMouseInput::calculate_cursor_position_delta() {
-  std::scoped_lock lock(m_input_mutex);
-  // Calculate the change in cursor position in x- and y-axis.
-  const std::array m_cursor_pos_delta{
-      static_cast<double>(m_current_cursor_pos[0]) - static_cast<double>(m_previous_cursor_pos[0]),
-      static_cast<double>(m_previous_cursor_pos[1]) - static_cast<double>(m_current_cursor_pos[1])};
+void KeyboardMouseInput::add_scroll(const double offset_x, const double offset_y) {
+  push_event(InputEventType::Scroll, 0, offset_x, offset_y);
+}
 
-  m_previous_cursor_pos = m_current_cursor_pos;
+std::array<double, 2> KeyboardMouseInput::get_scroll_delta() const {
+  return m_snapshot.scroll_delta;
+}
 
-  return m_cursor_pos_delta;
+void KeyboardMouseInput::update_snapshot() {
+  // held keys and the cursor carry over, everything else is per frame
+  m_snapshot.keys_pressed.reset();
+  m_snapshot.mouse_buttons_pressed.reset();
+  m_snapshot.cursor_delta = {0.0, 0.0};
+  m_snapshot.scroll_delta = {0.0, 0.0};
+  m_snapshot.events.clear();
+  m_snapshot.time = now_seconds();
+
+  InputEvent event{};
+  while (m_events.TryPop(event)) {
+    switch (event.type) {
+      case InputEventType::KeyPress:
+        m_snapshot.keys_down[event.code]    = true;
+        m_snapshot.keys_pressed[event.code] = true;
+        break;
+      case InputEventType::KeyRelease:
+        m_snapshot.keys_down[event.code] = false;
+        break;
+      case InputEventType::MouseButtonPress:
+        m_snapshot.mouse_buttons_down[event.code]    = true;
+        m_snapshot.mouse_buttons_pressed[event.code] = true;
+        break;
+      case InputEventType::MouseButtonRelease:
+        m_snapshot.mouse_buttons_down[event.code] = false;
+        break;
+      case InputEventType::CursorPos:
+        if (m_mouse_paused) {
+          break;
+        }
+        if (m_first_mouse) {
+          m_last_cursor_pos = {event.x, event.y};
+          m_first_mouse     = false;
+        }
+        // y is flipped, moving the mouse up looks up
+        m_snapshot.cursor_delta[0] += event.x - m_last_cursor_pos[0];
+        m_snapshot.cursor_delta[1] += m_last_cursor_pos[1] - event.y;
+        m_last_cursor_pos     = {event.x, event.y};
+        m_snapshot.cursor_pos = m_last_cursor_pos;
+        break;
+      case InputEventType::Scroll:
+        m_snapshot.scroll_delta[0] += event.x;
+        m_snapshot.scroll_delta[1] += event.y;
+        break;
+    }
+    m_snapshot.events.push_back(event);
+  }
 }
 
 void KeyboardMouseInput::resume() {
-  std::scoped_lock lock(m_input_mutex);
-  m_current_cursor_pos = m_previous_cursor_pos;
-  m_first_mouse = true;
+  m_first_mouse  = true;
   m_mouse_paused = false;
 }
 
 void KeyboardMouseInput::pause() {
-  std::scoped_lock lock(m_input_mutex);
   m_mouse_paused = true;
 }
-}  // namespace ezg::system
\ No newline at end of file
+}  // namespace ezg::system
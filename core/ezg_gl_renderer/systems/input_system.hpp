@@ -1,10 +1,57 @@
 #ifndef EASYGRAPHICS_INPUT_SYSTEM_HPP
 #define EASYGRAPHICS_INPUT_SYSTEM_HPP
 #include <array>
-#include <shared_mutex>
+#include <atomic>
+#include <bitset>
+#include <vector>
 #include <GLFW/glfw3.h>
+#include "ezg_util/spsc_queue.hpp"
 
 namespace ezg::system {
+enum class InputEventType : std::uint8_t {
+  KeyPress,
+  KeyRelease,
+  MouseButtonPress,
+  MouseButtonRelease,
+  CursorPos,
+  Scroll,
+};
+
+struct InputEvent {
+  InputEventType type;
+  // key or mouse button
+  std::int32_t code;
+  // cursor position or scroll offset
+  double x;
+  double y;
+  // seconds, steady clock
+  double time;
+};
+
+/// @brief State of all inputs at the start of a frame, it doesn't change until the next
+/// KeyboardMouseInput::update_snapshot.
+struct InputSnapshot {
+  static constexpr std::int32_t KeyCount         = GLFW_KEY_LAST + 1;
+  static constexpr std::int32_t MouseButtonCount = GLFW_MOUSE_BUTTON_LAST + 1;
+
+  std::bitset<KeyCount> keys_down;
+  // went down since the previous snapshot, also set if the key was released again
+  std::bitset<KeyCount> keys_pressed;
+  std::bitset<MouseButtonCount> mouse_buttons_down;
+  std::bitset<MouseButtonCount> mouse_buttons_pressed;
+
+  std::array<double, 2> cursor_pos{0.0, 0.0};
+  // accumulated over the events of the frame, y points up
+  std::array<double, 2> cursor_delta{0.0, 0.0};
+  std::array<double, 2> scroll_delta{0.0, 0.0};
+
+  // events since the previous snapshot in arrival order
+  std::vector<InputEvent> events;
+  double time{0.0};
+};
+
+/// @brief The GLFW callbacks push events into a lock-free queue, once per frame the main loop
+/// folds them into an immutable snapshot. Queries only read the snapshot, no locks.
 class KeyboardMouseInput {
 public:
   static KeyboardMouseInput& GetInstance() {
@@ -18,74 +65,96 @@ public:
   KeyboardMouseInput& operator=(const KeyboardMouseInput&) = delete;
   KeyboardMouseInput& operator=(KeyboardMouseInput&&)      = delete;
 
-  /// @brief Change the key's state to pressed.
-  /// @param key the key which was pressed and greater or equal to 0
+  /// @brief Queue a key press.
+  /// @param key the key which was pressed
+  /// @note key must be smaller or equal to ``GLFW_KEY_LAST`` and greater or equal to 0
   void press_key(std::int32_t key);
 
-  /// @brief Change the key's state to unpressed.
+  /// @brief Queue a key release.
   /// @param key the key which was released
-  /// @note key must be smaller than ``GLFW_KEY_LAST`` and greater or equal to 0
+  /// @note key must be smaller or equal to ``GLFW_KEY_LAST`` and greater or equal to 0
   void release_key(std::int32_t key);
 
-  /// @brief Check if the given key is currently pressed.
+  /// @brief Check if the given key is pressed in the current snapshot.
   /// @param key the key index
-  /// @note key must be smaller than ``GLFW_KEY_LAST`` and greater or equal to 0
+  /// @note key must be smaller or equal to ``GLFW_KEY_LAST`` and greater or equal to 0
   /// @return ``true`` if the key is pressed
   [[nodiscard]] bool is_key_pressed(std::int32_t key) const;
 
-  /// @brief Checks if a key was pressed once.
+  /// @brief Checks if a key went down since the previous snapshot.
   /// @param key The key index
-  /// @note key must be smaller than ``GLFW_KEY_LAST`` and greater or equal to 0
+  /// @note key must be smaller or equal to ``GLFW_KEY_LAST`` and greater or equal to 0
   /// @return ``true`` if the key was pressed
-  [[nodiscard]] bool was_key_pressed_once(std::int32_t key);
+  [[nodiscard]] bool was_key_pressed_once(std::int32_t key) const;
 
-  /// @brief Change the mouse button's state to pressed.
+  /// @brief Queue a mouse button press.
   /// @param button the mouse button which was pressed
-  /// @note button must be smaller than ``GLFW_MOUSE_BUTTON_LAST`` and greater or equal to 0
+  /// @note button must be smaller or equal to ``GLFW_MOUSE_BUTTON_LAST`` and greater or equal to 0
   void press_mouse_button(std::int32_t button);
 
-  /// @brief Change the mouse button's state to unpressed.
+  /// @brief Queue a mouse button release.
   /// @param button the mouse button which was released
-  /// @note button must be smaller than ``GLFW_MOUSE_BUTTON_LAST`` and greater or equal to 0
+  /// @note button must be smaller or equal to ``GLFW_MOUSE_BUTTON_LAST`` and greater or equal to 0
   void release_mouse_button(std::int32_t button);
 
-  /// @brief Check if the given mouse button is currently pressed.
+  /// @brief Check if the given mouse button is pressed in the current snapshot.
   /// @param button the mouse button index
-  /// @note button must be smaller than ``GLFW_MOUSE_BUTTON_LAST`` and greater or equal to 0
+  /// @note button must be smaller or equal to ``GLFW_MOUSE_BUTTON_LAST`` and greater or equal to 0
   /// @return ``true`` if the mouse button is pressed
   [[nodiscard]] bool is_mouse_button_pressed(std::int32_t button) const;
 
-  /// @brief Checks if a mouse button was pressed once.
+  /// @brief Checks if a mouse button went down since the previous snapshot.
   /// @param button the mouse button index
-  /// @note button must be smaller than ``GLFW_MOUSE_BUTTON_LAST`` and greater or equal to 0
+  /// @note button must be smaller or equal to ``GLFW_MOUSE_BUTTON_LAST`` and greater or equal to 0
   /// @return ``true`` if the mouse button was pressed
-  [[nodiscard]] bool was_mouse_button_pressed_once(std::int32_t button);
+  [[nodiscard]] bool was_mouse_button_pressed_once(std::int32_t button) const;
 
-  /// @brief Set the current cursor position.
+  /// @brief Queue a cursor movement.
   /// @param pos_x the current x-coordinate of the cursor
   /// @param pos_y the current y-coordinate of the cursor
   void set_cursor_pos(double pos_x, double pos_y);
 
   [[nodiscard]] std::array<std::int64_t, 2> get_cursor_pos() const;
 
-  /// @brief Calculate the change in x- and y-position of the cursor.
+  /// @brief Change in x- and y-position of the cursor since the previous snapshot.
   /// @return a std::array of size 2 which contains the change in x-position in index 0 and the change in y-position
   /// in index 1
-  [[nodiscard]] std::array<double, 2> calculate_cursor_position_delta();
+  [[nodiscard]] std::array<double, 2> calculate_cursor_position_delta() const;
+
+  /// @brief Queue a scroll wheel / touchpad offset.
+  void add_scroll(double offset_x, double offset_y);
 
+  [[nodiscard]] std::array<double, 2> get_scroll_delta() const;
+
+  /// @brief Fold the queued events into a new snapshot, call once per frame on the thread
+  /// reading the input.
+  void update_snapshot();
+
+  [[nodiscard]] const InputSnapshot& get_snapshot() const { return m_snapshot; }
+
+  /// @brief Events lost because the queue was full, it holds EventCapacity events per frame.
+  [[nodiscard]] auto get_dropped_events() const {
+    return m_dropped_events.load(std::memory_order_relaxed);
+  }
+
+  /// @brief Stop accumulating cursor movement, the next movement after resume doesn't jump.
   void resume();
 
   void pause();
+
+  static constexpr size_t EventCapacity = 1024;
+
 private:
   KeyboardMouseInput() = default;
-  std::array<std::int64_t, 2> m_previous_cursor_pos{0, 0};  // [x, y]
-  std::array<std::int64_t, 2> m_current_cursor_pos{0, 0};   // [x, y]
-  std::array<bool, GLFW_KEY_LAST> m_key_pressed{false};
-  std::array<bool, GLFW_MOUSE_BUTTON_LAST> m_mouse_button_pressed{false};
-  bool m_keyboard_updated{false};
-  bool m_mouse_buttons_updated{false};
+  void push_event(InputEventType type, std::int32_t code, double x = 0.0, double y = 0.0);
+
+  util::SpscQueue<InputEvent, EventCapacity> m_events;
+  std::atomic<std::uint64_t> m_dropped_events{0};
+
+  // consumer side, only touched by update_snapshot and the queries
+  InputSnapshot m_snapshot;
+  std::array<double, 2> m_last_cursor_pos{0.0, 0.0};
   bool m_first_mouse{true};
-  mutable std::shared_mutex m_input_mutex;
   bool m_mouse_paused{false};
 };
 }  // namespace ezg::system
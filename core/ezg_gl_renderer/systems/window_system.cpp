@@ -1,4 +1,6 @@
 #include "window_system.hpp"
+// glad must be included before GLFW
+#include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "log.hpp"
 #include "input_system.hpp"
@@ -9,6 +11,11 @@ static void glfw_error_call_back(int code, const char* msg) {
   spd::error("GLFW error [{}]: {}", code, msg);
 }
 
+
+void Window::mark_event(GLFWwindow* w) {
+  static_cast<WindowData*>(glfwGetWindowUserPointer(w))->has_events = true;
+}
+
 WindowConfig Window::default_config() {
   WindowConfig config{};
   config.width         = 800;
@@ -27,6 +34,7 @@ void Window::set_glfw_callbacks() {
     window_data->width         = width;
     window_data->height        = height;
     window_data->should_resize = true;
+    window_data->has_events    = true;
     spd::trace("Window resized to {} x {}", width, height);
   };
   glfwSetWindowSizeCallback(m_window, resize_callback);
@@ -35,6 +43,7 @@ void Window::set_glfw_callbacks() {
     if (key < 0 || key > GLFW_KEY_LAST) {
       return;
     }
+    mark_event(w);
     switch (action) {
       case GLFW_PRESS:
         KeyboardMouseInput::GetInstance().press_key(key);
@@ -49,6 +58,7 @@ void Window::set_glfw_callbacks() {
   glfwSetKeyCallback(m_window, key_callback);
 
   const auto cursor_pos_callback = [](GLFWwindow* w, auto xPos, auto yPos) {
+    mark_event(w);
     KeyboardMouseInput::GetInstance().set_cursor_pos(xPos, yPos);
   };
   glfwSetCursorPosCallback(m_window, cursor_pos_callback);
@@ -57,6 +67,7 @@ void Window::set_glfw_callbacks() {
     if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST) {
       return;
     }
+    mark_event(window);
     switch (action) {
       case GLFW_PRESS:
         KeyboardMouseInput::GetInstance().press_mouse_button(button);
@@ -69,11 +80,24 @@ void Window::set_glfw_callbacks() {
     }
   };
   glfwSetMouseButtonCallback(m_window, mouse_button_callback);
+
+  const auto scroll_callback = [](GLFWwindow* w, double offset_x, double offset_y) {
+    mark_event(w);
+    KeyboardMouseInput::GetInstance().add_scroll(offset_x, offset_y);
+  };
+  glfwSetScrollCallback(m_window, scroll_callback);
+
+  // only tracked so on-demand rendering wakes up, ImGui chains its own callbacks after these
+  glfwSetCharCallback(m_window, [](GLFWwindow* w, unsigned int) { mark_event(w); });
+  glfwSetWindowFocusCallback(m_window, [](GLFWwindow* w, int) { mark_event(w); });
+  // the window content was damaged (uncovered, restored), the last image has to be shown again
+  glfwSetWindowRefreshCallback(m_window, mark_event);
 }
 
 Window::Window(const WindowConfig& config) {
-  m_data.width  = config.width;
-  m_data.height = config.height;
+  m_data.width    = config.width;
+  m_data.height   = config.height;
+  m_data.headless = config.headless;
 
   if (!glfwInit()) {
     spd::error("Failed to initialize GLFW!");
@@ -83,7 +107,10 @@ Window::Window(const WindowConfig& config) {
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, config.major_version);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, config.minor_version);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-  glfwWindowHint(GLFW_RESIZABLE, config.resizable);
+  glfwWindowHint(GLFW_RESIZABLE, config.headless ? GLFW_FALSE : config.resizable);
+  if (config.headless) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  }
 
   m_window = glfwCreateWindow(m_data.width, m_data.height, config.title, nullptr, nullptr);
 
@@ -96,7 +123,12 @@ Window::Window(const WindowConfig& config) {
 
   glfwSetWindowUserPointer(m_window, &m_data);
 
-  center_window();
+  if (config.headless) {
+    // nothing is presented, don't let the swap interval throttle the frame rate
+    glfwSwapInterval(0);
+  } else {
+    center_window();
+  }
   // setup input callbacks
   set_glfw_callbacks();
 }
@@ -115,7 +147,16 @@ void Window::wait_for_focus() {
 }
 
 void Window::swap_buffers() const {
-  glfwSwapBuffers(m_window);
+  if (m_data.headless) {
+    // the hidden window's default framebuffer is never shown, just submit the frame
+    glFlush();
+  } else {
+    glfwSwapBuffers(m_window);
+  }
+}
+
+void Window::set_vsync(bool enable) const {
+  glfwSwapInterval(enable ? 1 : 0);
 }
 
 void Window::enable_cursor() const {
@@ -129,9 +170,16 @@ void Window::disable_cursor() const {
 Extend2D Window::get_framebuffer_size() const {
   return {m_data.width, m_data.height};
 }
-void Window::update() {
-  glfwPollEvents();
-  if (KeyboardMouseInput::GetInstance().is_key_pressed(GLFW_KEY_TAB)) {
+void Window::update(double wait_timeout) {
+  if (wait_timeout > 0.0) {
+    glfwWaitEventsTimeout(wait_timeout);
+  } else {
+    glfwPollEvents();
+  }
+  // the callbacks above only queued events, the rest of the frame reads this snapshot
+  auto& input = KeyboardMouseInput::GetInstance();
+  input.update_snapshot();
+  if (input.was_key_pressed_once(GLFW_KEY_TAB)) {
     m_data.show_cursor = !m_data.show_cursor;
     if (m_data.show_cursor) {
       enable_cursor();
@@ -139,13 +187,18 @@ void Window::update() {
       disable_cursor();
     }
   }
-  if (KeyboardMouseInput::GetInstance().is_key_pressed(GLFW_KEY_ESCAPE) ||
-      glfwWindowShouldClose(m_window)) {
+  if (input.is_key_pressed(GLFW_KEY_ESCAPE) || glfwWindowShouldClose(m_window)) {
     m_data.should_close = true;
     glfwSetWindowShouldClose(m_window, GL_TRUE);
   }
 }
 
+bool Window::consume_events() {
+  const bool has_events = m_data.has_events;
+  m_data.has_events     = false;
+  return has_events;
+}
+
 bool Window::center_window() {
   int sx = 0, sy = 0;
   int px = 0, py = 0;
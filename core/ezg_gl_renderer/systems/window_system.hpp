@@ -18,6 +18,8 @@ struct WindowConfig {
   const char* title;
   int major_version;
   int minor_version;
+  // hidden window, only used to own the GL context, rendering goes to an offscreen target
+  bool headless{false};
 };
 
 class Window {
@@ -36,13 +38,20 @@ public:
 
   void swap_buffers() const;
 
+  void set_vsync(bool enable) const;
+
   void enable_cursor() const;
 
   void disable_cursor() const;
 
   [[nodiscard]] Extend2D get_framebuffer_size() const;
 
-  void update();
+  /// @brief Process pending events. With a positive wait_timeout (seconds) the call sleeps until
+  /// an event arrives or the timeout expires instead of returning immediately.
+  void update(double wait_timeout = 0.0);
+
+  /// @brief Whether any input or window event arrived since the last call.
+  bool consume_events();
 
   [[nodiscard]] auto should_close() const { return m_data.should_close; }
   [[nodiscard]] auto should_resize() const { return m_data.should_resize; }
@@ -52,8 +61,10 @@ public:
   [[nodiscard]] auto get_width() const { return m_data.width; }
   [[nodiscard]] auto get_height() const { return m_data.height; }
   [[nodiscard]] auto get_aspect() const { return float(m_data.width) / float(m_data.height); }
+  [[nodiscard]] auto is_headless() const { return m_data.headless; }
 
 private:
+  static void mark_event(GLFWwindow* w);
   bool center_window();
   void destroy();
 
@@ -69,6 +80,8 @@ private:
     bool should_close{false};
     bool show_cursor{true};
     bool should_resize{false};
+    bool headless{false};
+    bool has_events{false};
   } m_data;
 };
 }  // namespace ezg::system
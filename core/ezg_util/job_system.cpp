@@ -0,0 +1,202 @@
+#include "job_system.hpp"
+#include <string>
+#include "profiler.hpp"
+
+namespace ezg::util {
+// queue of the worker running on this thread, NoQueue on every other thread
+static constexpr uint32_t NoQueue = UINT32_MAX;
+static thread_local uint32_t LocalQueue = NoQueue;
+
+namespace {
+// self destroying coroutine driving a spawned task
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+  std::coroutine_handle<promise_type> handle;
+};
+
+DetachedTask RunDetached(Task<void> task, JobCounter* counter) {
+  co_await task;
+  if (counter != nullptr) {
+    counter->Decrement();
+  }
+}
+}  // namespace
+
+void JobCounter::Decrement() {
+  std::vector<std::coroutine_handle<>> waiters;
+  {
+    std::lock_guard lock(m_mutex);
+    if (m_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    waiters.swap(m_waiters);
+  }
+  for (const auto waiter : waiters) {
+    JobSystem::Get().Submit([waiter] { waiter.resume(); });
+  }
+}
+
+void JobCounter::Wait() {
+  auto& jobs = JobSystem::Get();
+  while (!IsDone()) {
+    if (!jobs.TryRunJob()) {
+      std::this_thread::yield();
+    }
+  }
+  // the last decrement may still hold the lock
+  std::lock_guard lock(m_mutex);
+}
+
+bool JobCounter::Awaiter::await_suspend(std::coroutine_handle<> handle) {
+  std::lock_guard lock(counter.m_mutex);
+  if (counter.IsDone()) {
+    return false;
+  }
+  counter.m_waiters.push_back(handle);
+  return true;
+}
+
+JobSystem& JobSystem::Get() {
+  // the calling thread helps in ParallelFor and Wait, so one thread less than there are cores
+  static JobSystem instance(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  return instance;
+}
+
+JobSystem::JobSystem(uint32_t num_workers) {
+  for (uint32_t i = 0; i < num_workers; i++) {
+    m_queues.push_back(std::make_unique<WorkerQueue>());
+  }
+  for (uint32_t i = 0; i < num_workers; i++) {
+    m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard lock(m_sleep_mutex);
+    m_stop.store(true);
+  }
+  m_wake_cv.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+void JobSystem::Submit(Job job) {
+  // workers keep their own jobs, the deque back stays hot in their cache
+  const auto queue = LocalQueue != NoQueue
+                         ? LocalQueue
+                         : m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+  {
+    std::lock_guard lock(m_queues[queue]->mutex);
+    m_queues[queue]->jobs.push_back(std::move(job));
+  }
+  m_queued.fetch_add(1);
+  WakeWorker();
+}
+
+void JobSystem::Spawn(Task<void> task, JobCounter* counter) {
+  if (counter != nullptr) {
+    counter->Add();
+  }
+  const auto detached = RunDetached(std::move(task), counter).handle;
+  Submit([detached] { detached.resume(); });
+}
+
+void JobSystem::SubmitMainThread(Job job) {
+  std::lock_guard lock(m_main_mutex);
+  m_main_jobs.push_back(std::move(job));
+}
+
+void JobSystem::RunMainThreadJobs() {
+  std::vector<Job> jobs;
+  {
+    std::lock_guard lock(m_main_mutex);
+    jobs.swap(m_main_jobs);
+  }
+  // jobs queued while these run wait for the next call, a frame can't starve
+  for (auto& job : jobs) {
+    job();
+  }
+}
+
+bool JobSystem::TryRunJob() {
+  Job job;
+  const auto queue = LocalQueue;
+  if ((queue != NoQueue && PopJob(queue, job)) || StealJob(queue, job)) {
+    job();
+    return true;
+  }
+  return false;
+}
+
+bool JobSystem::PopJob(uint32_t queue, Job& job) {
+  auto& worker_queue = *m_queues[queue];
+  std::lock_guard lock(worker_queue.mutex);
+  if (worker_queue.jobs.empty()) {
+    return false;
+  }
+  job = std::move(worker_queue.jobs.back());
+  worker_queue.jobs.pop_back();
+  m_queued.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool JobSystem::StealJob(uint32_t thief, Job& job) {
+  const auto num_queues = static_cast<uint32_t>(m_queues.size());
+  // start next to the thief so the victims are spread out
+  const auto first = thief != NoQueue ? thief + 1 : 0;
+  for (uint32_t i = 0; i < num_queues; i++) {
+    const auto victim = (first + i) % num_queues;
+    if (victim == thief) {
+      continue;
+    }
+    auto& victim_queue = *m_queues[victim];
+    std::unique_lock lock(victim_queue.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || victim_queue.jobs.empty()) {
+      continue;
+    }
+    // oldest job, usually the biggest chunk of the victim's work
+    job = std::move(victim_queue.jobs.front());
+    victim_queue.jobs.pop_front();
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void JobSystem::WakeWorker() {
+  // pairs with the increment in WorkerLoop, no lock unless somebody sleeps
+  if (m_sleeping.load() > 0) {
+    std::lock_guard lock(m_sleep_mutex);
+    m_wake_cv.notify_one();
+  }
+}
+
+void JobSystem::WorkerLoop(uint32_t index) {
+  LocalQueue = index;
+#ifdef EZG_ENABLE_PROFILER
+  Profiler::Get().SetThreadName("Job Worker " + std::to_string(index));
+#endif
+  while (true) {
+    if (TryRunJob()) {
+      continue;
+    }
+    std::unique_lock lock(m_sleep_mutex);
+    m_sleeping.fetch_add(1);
+    m_wake_cv.wait(lock, [this] { return m_stop.load() || m_queued.load() > 0; });
+    m_sleeping.fetch_sub(1);
+    if (m_stop.load() && m_queued.load() == 0) {
+      return;
+    }
+  }
+}
+}  // namespace ezg::util
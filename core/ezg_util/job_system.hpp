@@ -0,0 +1,256 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ezg::util {
+using Job = std::function<void()>;
+
+/// @brief Number of outstanding jobs. Threads block in Wait, coroutines co_await it, both
+/// continue once it drops to zero. It can be reused after that.
+class JobCounter {
+public:
+  explicit JobCounter(uint32_t count = 0) : m_count(count) {}
+  JobCounter(const JobCounter&)            = delete;
+  JobCounter& operator=(const JobCounter&) = delete;
+
+  void Add(uint32_t count = 1) { m_count.fetch_add(count, std::memory_order_relaxed); }
+  void Decrement();
+  [[nodiscard]] bool IsDone() const { return m_count.load(std::memory_order_acquire) == 0; }
+
+  /// @brief Block until the counter is zero, the calling thread runs queued jobs meanwhile.
+  void Wait();
+
+  struct Awaiter {
+    JobCounter& counter;
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+  };
+  /// @brief Suspend the coroutine until the counter is zero, it resumes on a worker.
+  Awaiter operator co_await() { return {*this}; }
+
+private:
+  std::atomic<uint32_t> m_count;
+  // held by every decrement, so a waiter that saw zero can't free the counter too early
+  std::mutex m_mutex;
+  std::vector<std::coroutine_handle<>> m_waiters;
+};
+
+namespace detail {
+struct TaskPromiseBase {
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+      // symmetric transfer, the awaiting coroutine continues on this thread
+      const auto continuation = handle.promise().continuation;
+      return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() { exception = std::current_exception(); }
+
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+  template <typename U>
+  void return_value(U&& value) {
+    result.emplace(std::forward<U>(value));
+  }
+  T take_result() {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+    return std::move(*result);
+  }
+  std::optional<T> result;
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+  void return_void() const noexcept {}
+  void take_result() const {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+};
+}  // namespace detail
+
+/// @brief Lazily started coroutine, it runs when awaited or handed to JobSystem::Spawn.
+///
+///   Task<int> LoadSize(std::string path) {
+///     co_await JobSystem::Get().Schedule();  // continue on a worker
+///     co_return ReadFile(path).size();
+///   }
+template <typename T = void>
+class [[nodiscard]] Task {
+public:
+  struct promise_type : detail::TaskPromise<T> {
+    Task get_return_object() {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+  };
+
+  Task() = default;
+  explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+  Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      m_handle = std::exchange(other.m_handle, {});
+    }
+    return *this;
+  }
+  Task(const Task&)            = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task() { Reset(); }
+
+  struct Awaiter {
+    std::coroutine_handle<promise_type> handle;
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+      handle.promise().continuation = continuation;
+      return handle;
+    }
+    T await_resume() { return handle.promise().take_result(); }
+  };
+  Awaiter operator co_await() const noexcept { return {m_handle}; }
+
+private:
+  void Reset() {
+    if (m_handle) {
+      m_handle.destroy();
+      m_handle = {};
+    }
+  }
+
+  std::coroutine_handle<promise_type> m_handle;
+};
+
+/// @brief Work stealing scheduler shared by the renderers. Every worker owns a deque: it pushes
+/// and pops at the back, idle workers steal from the front of the others. Jobs submitted from
+/// other threads are spread round robin. Jobs that must stay on one thread (window, GL or SDL
+/// calls) go to the main thread queue, drained by RunMainThreadJobs.
+class JobSystem {
+public:
+  static JobSystem& Get();
+
+  JobSystem(const JobSystem&)            = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  ~JobSystem();
+
+  void Submit(Job job);
+  /// @brief Run a task to completion on the workers, the counter (if any) is incremented now
+  /// and decremented when the task finishes.
+  void Spawn(Task<void> task, JobCounter* counter = nullptr);
+
+  void SubmitMainThread(Job job);
+  /// @brief Run the queued main thread jobs, call it once per frame from the main loop.
+  void RunMainThreadJobs();
+
+  /// @brief Run one queued job on the calling thread, returns false if there was none.
+  bool TryRunJob();
+
+  [[nodiscard]] uint32_t GetNumWorkers() const { return static_cast<uint32_t>(m_workers.size()); }
+
+  struct ScheduleAwaiter {
+    JobSystem& jobs;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+      jobs.Submit([handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+  };
+  struct MainThreadAwaiter {
+    JobSystem& jobs;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+      jobs.SubmitMainThread([handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+  };
+  /// @brief co_await to continue the coroutine on a worker.
+  ScheduleAwaiter Schedule() { return {*this}; }
+  /// @brief co_await to continue the coroutine in the next RunMainThreadJobs.
+  MainThreadAwaiter MainThread() { return {*this}; }
+
+private:
+  // own cache lines, neighbouring deques are locked by different threads
+  struct alignas(64) WorkerQueue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  explicit JobSystem(uint32_t num_workers);
+  void WorkerLoop(uint32_t index);
+  bool PopJob(uint32_t queue, Job& job);
+  bool StealJob(uint32_t thief, Job& job);
+  void WakeWorker();
+
+  std::vector<std::thread> m_workers;
+  std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+  std::atomic<uint32_t> m_next_queue{0};
+
+  // jobs waiting in any deque, workers sleep while it is zero
+  std::atomic<int64_t> m_queued{0};
+  std::atomic<uint32_t> m_sleeping{0};
+  std::mutex m_sleep_mutex;
+  std::condition_variable m_wake_cv;
+  std::atomic<bool> m_stop{false};
+
+  std::mutex m_main_mutex;
+  std::vector<Job> m_main_jobs;
+};
+
+/// @brief Call func(chunk_begin, chunk_end) for chunks of at most grain indices of
+/// [begin, end) on the workers and the calling thread, returns when all chunks are done.
+template <typename Func>
+void ParallelFor(size_t begin, size_t end, size_t grain, Func&& func) {
+  if (begin >= end) {
+    return;
+  }
+  grain = std::max<size_t>(grain, 1);
+  JobCounter counter;
+  // the calling thread takes the first chunk instead of idling
+  for (auto chunk = begin + grain; chunk < end; chunk += grain) {
+    const auto chunk_end = std::min(chunk + grain, end);
+    counter.Add();
+    JobSystem::Get().Submit([&func, &counter, chunk, chunk_end] {
+      func(chunk, chunk_end);
+      counter.Decrement();
+    });
+  }
+  func(begin, std::min(begin + grain, end));
+  counter.Wait();
+}
+
+/// @brief Split [begin, end) into about one chunk per thread, for uniform per index costs.
+template <typename Func>
+void ParallelFor(size_t begin, size_t end, Func&& func) {
+  const auto threads = static_cast<size_t>(JobSystem::Get().GetNumWorkers()) + 1;
+  const auto grain   = (end - std::min(begin, end) + threads - 1) / threads;
+  ParallelFor(begin, end, grain, std::forward<Func>(func));
+}
+}  // namespace ezg::util
+
+#endif  //JOB_SYSTEM_HPP
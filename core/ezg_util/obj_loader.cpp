@@ -0,0 +1,698 @@
+#include "obj_loader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include "job_system.hpp"
+#include "profiler.hpp"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ezg::util {
+bool MappedFile::Open(const std::filesystem::path& path) {
+  Close();
+#ifdef _WIN32
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  m_file = file;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    Close();
+    return false;
+  }
+  if (size.QuadPart == 0) {
+    return true;
+  }
+  m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_mapping == nullptr) {
+    Close();
+    return false;
+  }
+  m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (m_data == nullptr) {
+    Close();
+    return false;
+  }
+  m_size = static_cast<size_t>(size.QuadPart);
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return false;
+  }
+  const auto size = static_cast<size_t>(info.st_size);
+  if (size > 0) {
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return false;
+    }
+    // every chunk is read right away by some worker, fault the pages in ahead of them
+    madvise(data, size, MADV_WILLNEED);
+    m_data = static_cast<const char*>(data);
+    m_size = size;
+  }
+  // the mapping stays valid without the descriptor
+  close(fd);
+#endif
+  return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+  if (m_data != nullptr) {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping != nullptr) {
+    CloseHandle(m_mapping);
+  }
+  if (m_file != nullptr) {
+    CloseHandle(m_file);
+  }
+  m_mapping = nullptr;
+  m_file    = nullptr;
+#else
+  if (m_data != nullptr) {
+    munmap(const_cast<char*>(m_data), m_size);
+  }
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void MappedFile::Prefault() const {
+  constexpr size_t PageSize = 4096;
+  // volatile keeps the otherwise unused reads
+  volatile char sink = 0;
+  for (size_t offset = 0; offset < m_size; offset += PageSize) {
+    sink = m_data[offset];
+  }
+  (void)sink;
+}
+
+namespace {
+// below this a file isn't worth splitting
+constexpr size_t MinChunkSize = 256 * 1024;
+constexpr int32_t NoIndex     = INT32_MIN;
+
+// attribute indices of one triangle corner, 0 based. Negative (relative) OBJ indices are stored
+// relative to the start of the chunk until the chunks are merged.
+struct Corner {
+  int32_t position;
+  int32_t uv;
+  int32_t normal;
+  // bit i set: index i is chunk relative
+  uint32_t relative;
+};
+
+struct MaterialSwitch {
+  // first corner drawn with the material
+  size_t corner;
+  std::string name;
+};
+
+struct ChunkResult {
+  std::vector<float> positions;
+  std::vector<float> uvs;
+  std::vector<float> normals;
+  std::vector<Corner> corners;
+  std::vector<MaterialSwitch> material_switches;
+  std::vector<std::string> material_libs;
+  std::string error;
+};
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool IsDigit(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
+const char* SkipSpaces(const char* p, const char* end) {
+  while (p < end && IsSpace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+std::string_view NextToken(const char*& p, const char* end) {
+  p                 = SkipSpaces(p, end);
+  const char* begin = p;
+  while (p < end && !IsSpace(*p)) {
+    p++;
+  }
+  return {begin, static_cast<size_t>(p - begin)};
+}
+
+// rest of the line without surrounding spaces, names may contain spaces
+std::string_view RestOfLine(const char* p, const char* end) {
+  p = SkipSpaces(p, end);
+  while (end > p && IsSpace(end[-1])) {
+    end--;
+  }
+  return {p, static_cast<size_t>(end - p)};
+}
+
+bool IsKeyword(const char* p, const char* end, std::string_view keyword) {
+  const auto length = keyword.size();
+  return static_cast<size_t>(end - p) > length && memcmp(p, keyword.data(), length) == 0 &&
+         IsSpace(p[length]);
+}
+
+const char* ParseFloatSlow(const char* p, const char* end, float& out) {
+  // odd notations (inf, nan, hex, very long mantissas), rare enough for strtof and a copy
+  char buffer[64];
+  const size_t length = std::min<size_t>(end - p, sizeof(buffer) - 1);
+  memcpy(buffer, p, length);
+  buffer[length] = '\0';
+  char* parsed_end;
+  out = std::strtof(buffer, &parsed_end);
+  return parsed_end == buffer ? nullptr : p + (parsed_end - buffer);
+}
+
+/// @brief Decimal and exponent notation in one pass without library calls, the digits are
+/// accumulated in an integer and scaled once by an exact power of ten.
+const char* ParseFloat(const char* p, const char* end, float& out) {
+  static constexpr double Pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                     1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char* start   = p;
+  const bool negative = p < end && *p == '-';
+  if (p < end && (*p == '-' || *p == '+')) {
+    p++;
+  }
+  uint64_t mantissa = 0;
+  int digits        = 0;
+  int exponent      = 0;
+  bool any_digit    = false;
+  for (; p < end && IsDigit(*p); p++) {
+    any_digit = true;
+    if (digits < 19) {
+      mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+      digits += mantissa != 0;
+    } else {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && IsDigit(*p); p++) {
+      any_digit = true;
+      // digits beyond 19 are far below float precision
+      if (digits < 19) {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        digits += mantissa != 0;
+        exponent--;
+      }
+    }
+  }
+  if (!any_digit) {
+    return ParseFloatSlow(start, end, out);
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char* exponent_start = p;
+    p++;
+    const bool negative_exponent = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+      p++;
+    }
+    if (p == end || !IsDigit(*p)) {
+      // a trailing 'e' isn't part of the number
+      p = exponent_start;
+    } else {
+      int value = 0;
+      for (; p < end && IsDigit(*p); p++) {
+        value = std::min(value * 10 + (*p - '0'), 10000);
+      }
+      exponent += negative_exponent ? -value : value;
+    }
+  }
+  if (exponent < -22 || exponent > 22) {
+    return ParseFloatSlow(start, end, out);
+  }
+  double value = static_cast<double>(mantissa);
+  value        = exponent < 0 ? value / Pow10[-exponent] : value * Pow10[exponent];
+  out          = static_cast<float>(negative ? -value : value);
+  return p;
+}
+
+const char* ParseInt(const char* p, const char* end, int32_t& out) {
+  const bool negative = p < end && *p == '-';
+  if (p < end && (*p == '-' || *p == '+')) {
+    p++;
+  }
+  if (p == end || !IsDigit(*p)) {
+    return nullptr;
+  }
+  int64_t value = 0;
+  for (; p < end && IsDigit(*p); p++) {
+    value = std::min<int64_t>(value * 10 + (*p - '0'), INT32_MAX);
+  }
+  out = static_cast<int32_t>(negative ? -value : value);
+  return p;
+}
+
+void SetError(ChunkResult& chunk, std::string_view message, const char* line, const char* end) {
+  if (chunk.error.empty()) {
+    chunk.error = std::string(message) + ": " + std::string(RestOfLine(line, end));
+  }
+}
+
+void ParseFloats(const char* p, const char* end, int count, std::vector<float>& out,
+                 ChunkResult& chunk, const char* line) {
+  for (int i = 0; i < count; i++) {
+    p           = SkipSpaces(p, end);
+    float value = 0.0f;
+    // missing trailing components (e.g. 1D texture coordinates) are 0
+    if (p < end) {
+      p = ParseFloat(p, end, value);
+      if (p == nullptr) {
+        SetError(chunk, "invalid number", line, end);
+        return;
+      }
+    }
+    out.push_back(value);
+  }
+}
+
+// OBJ index to a 0 based index, count is the number of attributes parsed so far in this chunk
+bool ResolveLocal(int32_t raw, size_t count, uint32_t bit, int32_t& index, uint32_t& relative) {
+  if (raw > 0) {
+    index = raw - 1;
+  } else if (raw < 0) {
+    index = static_cast<int32_t>(static_cast<int64_t>(count) + raw);
+    relative |= bit;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void ParseFace(const char* p, const char* end, ChunkResult& chunk, std::vector<Corner>& polygon,
+               const char* line) {
+  polygon.clear();
+  while (true) {
+    p = SkipSpaces(p, end);
+    if (p == end) {
+      break;
+    }
+    Corner corner{NoIndex, NoIndex, NoIndex, 0};
+    int32_t raw = 0;
+    p           = ParseInt(p, end, raw);
+    bool valid  = p != nullptr && ResolveLocal(raw, chunk.positions.size() / 3, 1,
+                                               corner.position, corner.relative);
+    if (valid && p < end && *p == '/') {
+      p++;
+      if (p < end && *p != '/') {
+        p     = ParseInt(p, end, raw);
+        valid = p != nullptr && ResolveLocal(raw, chunk.uvs.size() / 2, 2, corner.uv,
+                                             corner.relative);
+      }
+      if (valid && p < end && *p == '/') {
+        p     = ParseInt(p + 1, end, raw);
+        valid = p != nullptr && ResolveLocal(raw, chunk.normals.size() / 3, 4, corner.normal,
+                                             corner.relative);
+      }
+    }
+    if (!valid || (p < end && !IsSpace(*p))) {
+      SetError(chunk, "invalid face", line, end);
+      return;
+    }
+    polygon.push_back(corner);
+  }
+  // fan triangulation, exporters write convex polygons
+  for (size_t i = 2; i < polygon.size(); i++) {
+    chunk.corners.push_back(polygon[0]);
+    chunk.corners.push_back(polygon[i - 1]);
+    chunk.corners.push_back(polygon[i]);
+  }
+}
+
+void ParseChunk(const char* begin, const char* end, ChunkResult& chunk) {
+  // reserve for a typical mix of attribute and face lines
+  const size_t estimated_lines = static_cast<size_t>(end - begin) / 32;
+  chunk.positions.reserve(estimated_lines);
+  chunk.corners.reserve(estimated_lines);
+
+  std::vector<Corner> polygon;
+  for (const char* line = begin; line < end;) {
+    // memchr is vectorized in every libc, the line scan runs at memory speed
+    const auto* newline  = static_cast<const char*>(memchr(line, '\n', end - line));
+    const char* line_end = newline != nullptr ? newline : end;
+    const char* p        = SkipSpaces(line, line_end);
+    if (line_end - p >= 2) {
+      switch (p[0]) {
+        case 'v':
+          if (IsSpace(p[1])) {
+            ParseFloats(p + 2, line_end, 3, chunk.positions, chunk, line);
+          } else if (p[1] == 't' && line_end - p > 2 && IsSpace(p[2])) {
+            ParseFloats(p + 3, line_end, 2, chunk.uvs, chunk, line);
+          } else if (p[1] == 'n' && line_end - p > 2 && IsSpace(p[2])) {
+            ParseFloats(p + 3, line_end, 3, chunk.normals, chunk, line);
+          }
+          break;
+        case 'f':
+          if (IsSpace(p[1])) {
+            ParseFace(p + 2, line_end, chunk, polygon, line);
+          }
+          break;
+        case 'u':
+          if (IsKeyword(p, line_end, "usemtl")) {
+            chunk.material_switches.push_back(
+                {chunk.corners.size(), std::string(RestOfLine(p + 6, line_end))});
+          }
+          break;
+        case 'm':
+          if (IsKeyword(p, line_end, "mtllib")) {
+            const char* name = p + 6;
+            while (true) {
+              const auto token = NextToken(name, line_end);
+              if (token.empty()) {
+                break;
+              }
+              chunk.material_libs.emplace_back(token);
+            }
+          }
+          break;
+        default:
+          // comments, objects, groups, smoothing groups, lines and points
+          break;
+      }
+    }
+    line = line_end + 1;
+  }
+}
+
+// resolves a merged corner index, returns false if it is out of range
+bool ResolveGlobal(int32_t& index, bool relative, size_t base, size_t count, bool optional) {
+  if (index == NoIndex) {
+    return optional;
+  }
+  const int64_t resolved = relative ? index + static_cast<int64_t>(base) : index;
+  if (resolved < 0 || resolved >= static_cast<int64_t>(count)) {
+    return false;
+  }
+  index = static_cast<int32_t>(resolved);
+  return true;
+}
+
+uint64_t HashCorner(const Corner& corner) {
+  uint64_t hash = static_cast<uint32_t>(corner.position) * 0x9E3779B97F4A7C15ull;
+  hash ^= static_cast<uint32_t>(corner.uv) * 0xC2B2AE3D27D4EB4Full;
+  hash ^= static_cast<uint32_t>(corner.normal) * 0x165667B19E3779F9ull;
+  return hash ^ (hash >> 29);
+}
+
+bool SameCorner(const Corner& a, const Corner& b) {
+  return a.position == b.position && a.uv == b.uv && a.normal == b.normal;
+}
+
+void LoadMaterialLibs(const std::vector<std::string>& libs, const std::filesystem::path& base_dir,
+                      ObjModel& model) {
+  for (const auto& lib : libs) {
+    MappedFile file;
+    if (!file.Open(base_dir / lib)) {
+      model.warnings += "Material file " + (base_dir / lib).string() + " not found\n";
+      continue;
+    }
+    ParseMtl(file.GetData(), model.materials);
+  }
+}
+}  // namespace
+
+bool ParseObj(std::string_view source, const std::filesystem::path& base_dir, ObjModel& model,
+              std::string& error) {
+  EZG_PROFILE_FUNCTION();
+  model = {};
+  if (source.empty()) {
+    return true;
+  }
+  const char* begin = source.data();
+  const char* end   = begin + source.size();
+
+  // several chunks per thread, so a thread that got a chunk of short lines doesn't hold up
+  // the others
+  const size_t threads    = static_cast<size_t>(JobSystem::Get().GetNumWorkers()) + 1;
+  const size_t num_chunks = std::clamp<size_t>(source.size() / MinChunkSize, 1, threads * 4);
+  std::vector<const char*> bounds{begin};
+  for (size_t i = 1; i < num_chunks; i++) {
+    const char* split   = std::max(begin + source.size() * i / num_chunks, bounds.back());
+    const auto* newline = static_cast<const char*>(memchr(split, '\n', end - split));
+    bounds.push_back(newline != nullptr ? newline + 1 : end);
+  }
+  bounds.push_back(end);
+
+  std::vector<ChunkResult> chunks(bounds.size() - 1);
+  ParallelFor(0, chunks.size(), 1, [&](size_t chunk_begin, size_t chunk_end) {
+    for (size_t i = chunk_begin; i < chunk_end; i++) {
+      ParseChunk(bounds[i], bounds[i + 1], chunks[i]);
+    }
+  });
+  for (const auto& chunk : chunks) {
+    if (!chunk.error.empty()) {
+      error = chunk.error;
+      return false;
+    }
+  }
+
+  // attribute and corner offsets of every chunk in the merged arrays
+  struct ChunkBase {
+    size_t position;
+    size_t uv;
+    size_t normal;
+    size_t corner;
+  };
+  std::vector<ChunkBase> bases(chunks.size());
+  ChunkBase total{};
+  for (size_t i = 0; i < chunks.size(); i++) {
+    bases[i] = total;
+    total.position += chunks[i].positions.size();
+    total.uv += chunks[i].uvs.size();
+    total.normal += chunks[i].normals.size();
+    total.corner += chunks[i].corners.size();
+  }
+  if (total.corner > UINT32_MAX) {
+    error = "too many face corners";
+    return false;
+  }
+
+  std::vector<float> positions(total.position);
+  std::vector<float> uvs(total.uv);
+  std::vector<float> normals(total.normal);
+  std::vector<Corner> corners(total.corner);
+  std::atomic<bool> out_of_range{false};
+  ParallelFor(0, chunks.size(), 1, [&](size_t chunk_begin, size_t chunk_end) {
+    for (size_t i = chunk_begin; i < chunk_end; i++) {
+      const auto& chunk = chunks[i];
+      const auto& base  = bases[i];
+      std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + base.position);
+      std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + base.uv);
+      std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + base.normal);
+      for (size_t c = 0; c < chunk.corners.size(); c++) {
+        Corner corner = chunk.corners[c];
+        const bool valid =
+            ResolveGlobal(corner.position, corner.relative & 1, base.position / 3,
+                          total.position / 3, false) &&
+            ResolveGlobal(corner.uv, corner.relative & 2, base.uv / 2, total.uv / 2, true) &&
+            ResolveGlobal(corner.normal, corner.relative & 4, base.normal / 3, total.normal / 3,
+                          true);
+        if (!valid) {
+          out_of_range.store(true, std::memory_order_relaxed);
+        }
+        corners[base.corner + c] = corner;
+      }
+    }
+  });
+  if (out_of_range.load()) {
+    error = "face index out of range";
+    return false;
+  }
+
+  // welding, open addressing on the index triple, the table holds vertex ids
+  std::vector<Corner> unique;
+  unique.reserve(total.corner / 2);
+  model.indices.resize(total.corner);
+  {
+    size_t capacity = 16;
+    while (capacity < total.corner * 2) {
+      capacity *= 2;
+    }
+    std::vector<uint32_t> table(capacity, UINT32_MAX);
+    const size_t mask = capacity - 1;
+    for (size_t i = 0; i < corners.size(); i++) {
+      const Corner& corner = corners[i];
+      size_t slot          = HashCorner(corner) & mask;
+      while (table[slot] != UINT32_MAX && !SameCorner(unique[table[slot]], corner)) {
+        slot = (slot + 1) & mask;
+      }
+      if (table[slot] == UINT32_MAX) {
+        table[slot] = static_cast<uint32_t>(unique.size());
+        unique.push_back(corner);
+      }
+      model.indices[i] = table[slot];
+    }
+  }
+
+  model.vertices.resize(unique.size());
+  ParallelFor(0, unique.size(), [&](size_t vertex_begin, size_t vertex_end) {
+    for (size_t i = vertex_begin; i < vertex_end; i++) {
+      const Corner& corner = unique[i];
+      ObjVertex& vertex    = model.vertices[i];
+      const float* p       = &positions[3 * static_cast<size_t>(corner.position)];
+      vertex.position      = {p[0], p[1], p[2]};
+      if (corner.uv != NoIndex) {
+        const float* t = &uvs[2 * static_cast<size_t>(corner.uv)];
+        vertex.uv      = {t[0], t[1]};
+      }
+      if (corner.normal != NoIndex) {
+        const float* n = &normals[3 * static_cast<size_t>(corner.normal)];
+        vertex.normal  = {n[0], n[1], n[2]};
+      }
+    }
+  });
+  model.has_uvs     = total.uv > 0;
+  model.has_normals = total.normal > 0;
+
+  std::vector<std::string> libs;
+  std::vector<MaterialSwitch> switches;
+  for (size_t i = 0; i < chunks.size(); i++) {
+    for (auto& lib : chunks[i].material_libs) {
+      if (std::find(libs.begin(), libs.end(), lib) == libs.end()) {
+        libs.push_back(std::move(lib));
+      }
+    }
+    for (auto& material_switch : chunks[i].material_switches) {
+      switches.push_back({bases[i].corner + material_switch.corner,
+                          std::move(material_switch.name)});
+    }
+  }
+  LoadMaterialLibs(libs, base_dir, model);
+  std::unordered_map<std::string_view, int32_t> material_ids;
+  for (size_t i = 0; i < model.materials.size(); i++) {
+    material_ids.try_emplace(model.materials[i].name, static_cast<int32_t>(i));
+  }
+
+  int32_t material = -1;
+  size_t run_begin = 0;
+  auto close_run   = [&](size_t run_end) {
+    if (run_end == run_begin) {
+      return;
+    }
+    if (!model.submeshes.empty() && model.submeshes.back().material == material) {
+      model.submeshes.back().index_count += static_cast<uint32_t>(run_end - run_begin);
+    } else {
+      model.submeshes.push_back({material, static_cast<uint32_t>(run_begin),
+                                 static_cast<uint32_t>(run_end - run_begin)});
+    }
+  };
+  for (const auto& material_switch : switches) {
+    close_run(material_switch.corner);
+    const auto it = material_ids.find(material_switch.name);
+    material      = it != material_ids.end() ? it->second : -1;
+    run_begin     = material_switch.corner;
+  }
+  close_run(total.corner);
+  return true;
+}
+
+bool LoadObj(const std::filesystem::path& path, ObjModel& model, std::string& error) {
+  MappedFile file;
+  if (!file.Open(path)) {
+    error = "Cannot open file " + path.string();
+    return false;
+  }
+  return ParseObj(file.GetData(), path.parent_path(), model, error);
+}
+
+void ParseMtl(std::string_view source, std::vector<ObjMaterial>& materials) {
+  const char* end       = source.data() + source.size();
+  ObjMaterial* material = nullptr;
+  const auto read_vec3  = [](const char* p, const char* line_end, glm::vec3& out) {
+    for (int i = 0; i < 3; i++) {
+      p = SkipSpaces(p, line_end);
+      if (p == line_end || (p = ParseFloat(p, line_end, out[i])) == nullptr) {
+        return;
+      }
+    }
+  };
+  const auto read_float = [](const char* p, const char* line_end, float& out) {
+    p = SkipSpaces(p, line_end);
+    if (p < line_end) {
+      ParseFloat(p, line_end, out);
+    }
+  };
+  for (const char* line = source.data(); line < end;) {
+    const auto* newline  = static_cast<const char*>(memchr(line, '\n', end - line));
+    const char* line_end = newline != nullptr ? newline : end;
+    const char* p        = SkipSpaces(line, line_end);
+    const char* rest     = p;
+    const auto keyword   = NextToken(rest, line_end);
+    line                 = line_end + 1;
+
+    if (keyword == "newmtl") {
+      material       = &materials.emplace_back();
+      material->name = std::string(RestOfLine(rest, line_end));
+    } else if (material == nullptr) {
+      continue;
+    } else if (keyword == "Ka") {
+      read_vec3(rest, line_end, material->ambient);
+    } else if (keyword == "Kd") {
+      read_vec3(rest, line_end, material->diffuse);
+    } else if (keyword == "Ks") {
+      read_vec3(rest, line_end, material->specular);
+    } else if (keyword == "Ke") {
+      read_vec3(rest, line_end, material->emission);
+    } else if (keyword == "Ns") {
+      read_float(rest, line_end, material->shininess);
+    } else if (keyword == "d") {
+      read_float(rest, line_end, material->dissolve);
+    } else if (keyword == "Tr") {
+      float transparency = 0.0f;
+      read_float(rest, line_end, transparency);
+      material->dissolve = 1.0f - transparency;
+    } else if (keyword == "illum") {
+      int32_t illum = 0;
+      if (ParseInt(SkipSpaces(rest, line_end), line_end, illum) != nullptr) {
+        material->illum = illum;
+      }
+    } else {
+      // texture options like -bm 1.0 come first, the file name is the last token
+      std::string* texture = nullptr;
+      if (keyword == "map_Kd") {
+        texture = &material->diffuse_texture;
+      } else if (keyword == "map_Ks") {
+        texture = &material->specular_texture;
+      } else if (keyword == "map_Bump" || keyword == "map_bump" || keyword == "bump" ||
+                 keyword == "norm") {
+        texture = &material->normal_texture;
+      } else if (keyword == "map_d") {
+        texture = &material->alpha_texture;
+      }
+      if (texture != nullptr) {
+        std::string_view name;
+        for (auto token = NextToken(rest, line_end); !token.empty();
+             token      = NextToken(rest, line_end)) {
+          name = token;
+        }
+        *texture = std::string(name);
+      }
+    }
+  }
+}
+}  // namespace ezg::util
@@ -0,0 +1,94 @@
+#ifndef OBJ_LOADER_HPP
+#define OBJ_LOADER_HPP
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ezg::util {
+/// @brief Read only memory mapping of a whole file.
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&)            = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { Close(); }
+
+  bool Open(const std::filesystem::path& path);
+  void Close();
+
+  /// @brief Read one byte of every page, so the file is read from disk now rather than by the
+  /// first pass over the data.
+  void Prefault() const;
+
+  [[nodiscard]] std::string_view GetData() const { return {m_data, m_size}; }
+  [[nodiscard]] size_t GetSize() const { return m_size; }
+
+private:
+  const char* m_data{nullptr};
+  size_t m_size{0};
+#ifdef _WIN32
+  void* m_file{nullptr};
+  void* m_mapping{nullptr};
+#endif
+};
+
+struct ObjVertex {
+  glm::vec3 position{0.0f};
+  glm::vec3 normal{0.0f};
+  // as written in the file, v points up
+  glm::vec2 uv{0.0f};
+};
+
+struct ObjMaterial {
+  std::string name;
+  glm::vec3 ambient{0.0f};
+  glm::vec3 diffuse{1.0f};
+  glm::vec3 specular{0.0f};
+  glm::vec3 emission{0.0f};
+  float shininess{1.0f};
+  float dissolve{1.0f};
+  int illum{0};
+  // relative to the MTL file, like in the file
+  std::string diffuse_texture;
+  std::string specular_texture;
+  std::string normal_texture;
+  std::string alpha_texture;
+};
+
+// run of triangles with one material, in file order
+struct ObjSubmesh {
+  // index into ObjModel::materials, -1 without usemtl or for unknown names
+  int32_t material{-1};
+  uint32_t first_index{0};
+  uint32_t index_count{0};
+};
+
+/// @brief Triangulated, indexed OBJ. Face corners that reference the same position, uv and
+/// normal share one vertex.
+struct ObjModel {
+  std::vector<ObjVertex> vertices;
+  std::vector<uint32_t> indices;
+  std::vector<ObjSubmesh> submeshes;
+  std::vector<ObjMaterial> materials;
+  bool has_normals{false};
+  bool has_uvs{false};
+  // missing MTL files and similar, the model is still usable
+  std::string warnings;
+};
+
+/// @brief Parse OBJ text. The text is split into line aligned chunks that are parsed on the job
+/// system, then merged and welded. MTL files named by mtllib are read relative to base_dir.
+bool ParseObj(std::string_view source, const std::filesystem::path& base_dir, ObjModel& model,
+              std::string& error);
+
+/// @brief Map the file and ParseObj it.
+bool LoadObj(const std::filesystem::path& path, ObjModel& model, std::string& error);
+
+/// @brief Append the materials of MTL text.
+void ParseMtl(std::string_view source, std::vector<ObjMaterial>& materials);
+}  // namespace ezg::util
+
+#endif  //OBJ_LOADER_HPP
@@ -0,0 +1,189 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ezg::util {
+static void WriteJsonString(std::ofstream& file, const char* str) {
+  file << '"';
+  for (const char* c = str; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      file << '\\' << *c;
+    } else if (static_cast<unsigned char>(*c) >= 0x20) {
+      file << *c;
+    }
+  }
+  file << '"';
+}
+
+Profiler& Profiler::Get() {
+  static Profiler instance;
+  return instance;
+}
+
+Profiler::Profiler() {
+  Calibrate();
+  m_start_tick      = Now();
+  m_last_frame_tick = m_start_tick;
+}
+
+void Profiler::Calibrate() {
+#ifdef EZG_PROFILER_RDTSC
+  // measure the tsc frequency against steady_clock over a short interval
+  const auto clock_begin = std::chrono::steady_clock::now();
+  const auto tick_begin  = Now();
+  while (std::chrono::steady_clock::now() - clock_begin < std::chrono::milliseconds(10)) {
+  }
+  const auto clock_end = std::chrono::steady_clock::now();
+  const auto tick_end  = Now();
+  const auto ns        = std::chrono::duration<double, std::nano>(clock_end - clock_begin).count();
+  m_ns_per_tick = ns / static_cast<double>(tick_end - tick_begin);
+#else
+  m_ns_per_tick = 1e9 * std::chrono::steady_clock::period::num /
+                  static_cast<double>(std::chrono::steady_clock::period::den);
+#endif
+}
+
+Profiler::ThreadBuffer* Profiler::RegisterThread() {
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->slots = std::make_unique<ZoneSlot[]>(RingCapacity);
+  std::lock_guard lock(m_mutex);
+  buffer->thread_id   = static_cast<uint32_t>(m_buffers.size());
+  buffer->thread_name = "Thread " + std::to_string(buffer->thread_id);
+  // buffers are never freed, so zones of finished threads can still be exported
+  return m_buffers.emplace_back(std::move(buffer)).get();
+}
+
+bool Profiler::ReadZone(const ThreadBuffer& buffer, uint64_t index, ZoneEvent& event) {
+  const auto& slot       = buffer.slots[index & (RingCapacity - 1)];
+  const uint64_t written = 2 * index + 2;
+  if (slot.sequence.load(std::memory_order_acquire) != written) {
+    return false;
+  }
+  event.name  = slot.name.load(std::memory_order_relaxed);
+  event.begin = slot.begin.load(std::memory_order_relaxed);
+  event.end   = slot.end.load(std::memory_order_relaxed);
+  event.depth = slot.depth.load(std::memory_order_relaxed);
+  // the copy completes before the sequence is checked again
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(std::memory_order_relaxed) == written;
+}
+
+void Profiler::SetThreadName(std::string name) {
+  auto* buffer = LocalBuffer();
+  std::lock_guard lock(m_mutex);
+  buffer->thread_name = std::move(name);
+}
+
+void Profiler::FrameMark() {
+  const auto now = Now();
+  std::vector<ZoneStats> stats;
+  {
+    std::lock_guard lock(m_mutex);
+    for (auto& buffer : m_buffers) {
+      const auto head = buffer->head.load(std::memory_order_acquire);
+      // the producer may have lapped us, skip what was overwritten
+      auto cursor = std::max(buffer->frame_cursor, head > RingCapacity ? head - RingCapacity : 0);
+      for (; cursor < head; cursor++) {
+        ZoneEvent event;
+        if (!ReadZone(*buffer, cursor, event)) {
+          continue;
+        }
+        const auto ms = TicksToMs(event.end - event.begin);
+        auto it = std::find_if(stats.begin(), stats.end(), [&](const ZoneStats& s) {
+          return s.name == event.name || std::strcmp(s.name, event.name) == 0;
+        });
+        if (it == stats.end()) {
+          stats.push_back({event.name, 1, ms, ms});
+        } else {
+          it->count++;
+          it->total_ms += ms;
+          it->max_ms = std::max(it->max_ms, ms);
+        }
+      }
+      buffer->frame_cursor = head;
+    }
+    m_frame_marks.push_back(now);
+    if (m_frame_marks.size() > RingCapacity) {
+      m_frame_marks.erase(m_frame_marks.begin(), m_frame_marks.begin() + RingCapacity / 2);
+    }
+    m_last_frame_ms   = TicksToMs(now - m_last_frame_tick);
+    m_last_frame_tick = now;
+    m_frame_stats     = std::move(stats);
+  }
+}
+
+std::vector<ZoneStats> Profiler::GetFrameStats() const {
+  std::lock_guard lock(m_mutex);
+  return m_frame_stats;
+}
+
+double Profiler::GetLastFrameMs() const {
+  std::lock_guard lock(m_mutex);
+  return m_last_frame_ms;
+}
+
+const char* Profiler::Intern(std::string_view name) {
+  std::lock_guard lock(m_mutex);
+  // node based container, element addresses are stable across rehashing
+  return m_interned.emplace(name).first->c_str();
+}
+
+double Profiler::MeasureZoneOverhead(uint32_t iterations) {
+  const auto begin = Now();
+  for (uint32_t i = 0; i < iterations; i++) {
+    ProfileZone zone{"ProfilerOverhead"};
+  }
+  const auto end     = Now();
+  m_zone_overhead_ns = TicksToMs(end - begin) * 1e6 / static_cast<double>(iterations);
+  return m_zone_overhead_ns;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::lock_guard lock(m_mutex);
+  const auto to_us = [&](uint64_t tick) {
+    return tick > m_start_tick ? TicksToMs(tick - m_start_tick) * 1e3 : 0.0;
+  };
+  file << "{\"traceEvents\":[\n";
+  bool first = true;
+  const auto separator = [&]() {
+    if (!first) {
+      file << ",\n";
+    }
+    first = false;
+  };
+  file.precision(3);
+  file << std::fixed;
+  for (const auto& buffer : m_buffers) {
+    separator();
+    file << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << buffer->thread_id
+         << R"(,"args":{"name":)";
+    WriteJsonString(file, buffer->thread_name.c_str());
+    file << "}}";
+    const auto head = buffer->head.load(std::memory_order_acquire);
+    for (auto i = head > RingCapacity ? head - RingCapacity : 0; i < head; i++) {
+      ZoneEvent event;
+      if (!ReadZone(*buffer, i, event)) {
+        continue;
+      }
+      separator();
+      file << R"({"name":)";
+      WriteJsonString(file, event.name);
+      file << R"(,"ph":"X","pid":0,"tid":)" << buffer->thread_id << R"(,"ts":)"
+           << to_us(event.begin) << R"(,"dur":)" << TicksToMs(event.end - event.begin) * 1e3
+           << R"(,"args":{"depth":)" << event.depth << "}}";
+    }
+  }
+  for (const auto mark : m_frame_marks) {
+    separator();
+    file << R"({"name":"Frame","ph":"i","s":"g","pid":0,"tid":0,"ts":)" << to_us(mark) << "}";
+  }
+  file << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"zone_overhead_ns\":"
+       << m_zone_overhead_ns << "}}\n";
+  return true;
+}
+}  // namespace ezg::util
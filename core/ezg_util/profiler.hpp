@@ -0,0 +1,175 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define EZG_PROFILER_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define EZG_PROFILER_RDTSC
+#endif
+
+namespace ezg::util {
+struct ZoneEvent {
+  const char* name;
+  uint64_t begin;
+  uint64_t end;
+  uint32_t depth;
+};
+
+struct ZoneStats {
+  const char* name;
+  uint32_t count;
+  double total_ms;
+  double max_ms;
+};
+
+/// @brief CPU zone profiler. Every thread writes finished zones into its own ring buffer
+/// (single producer, no locks on the hot path), the thread calling FrameMark / export reads them.
+/// Every slot carries a sequence number, zones overwritten while they are read are dropped.
+class Profiler {
+public:
+  static constexpr uint32_t RingCapacity = 1u << 16;
+
+  static Profiler& Get();
+
+  /// @brief Raw timestamp, rdtsc ticks where available, steady_clock ticks otherwise.
+  static uint64_t Now() {
+#ifdef EZG_PROFILER_RDTSC
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+  }
+
+  static uint32_t& Depth() {
+    thread_local uint32_t depth = 0;
+    return depth;
+  }
+
+  void RecordZone(const char* name, uint64_t begin, uint64_t end, uint32_t depth) {
+    auto* buffer    = LocalBuffer();
+    const auto head = buffer->head.load(std::memory_order_relaxed);
+    auto& slot      = buffer->slots[head & (RingCapacity - 1)];
+    // odd while the slot is written, readers drop it unless they see the even value of their
+    // index before and after copying. Plain stores on x86, the fence only orders the compiler
+    slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+    slot.sequence.store(2 * head + 2, std::memory_order_release);
+    buffer->head.store(head + 1, std::memory_order_release);
+  }
+
+  /// @brief Close the current frame and aggregate the zones finished since the last mark.
+  void FrameMark();
+
+  /// @brief Zones of the last completed frame, merged by name.
+  [[nodiscard]] std::vector<ZoneStats> GetFrameStats() const;
+  [[nodiscard]] double GetLastFrameMs() const;
+
+  /// @brief Write everything still in the ring buffers as Chrome trace / Perfetto JSON.
+  bool ExportChromeTrace(const std::string& path);
+
+  /// @brief Return a pointer to a copy of name that stays valid for the program lifetime,
+  /// zones only store the pointer so names built at runtime must be interned.
+  const char* Intern(std::string_view name);
+
+  /// @brief Average cost of one empty zone in nanoseconds, measured on the calling thread.
+  double MeasureZoneOverhead(uint32_t iterations = 100000);
+
+  [[nodiscard]] double TicksToMs(uint64_t ticks) const { return ticks * m_ns_per_tick * 1e-6; }
+
+  void SetThreadName(std::string name);
+
+private:
+  // a ring buffer entry, the producer may overwrite it while a reader copies it
+  struct ZoneSlot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> begin{0};
+    std::atomic<uint64_t> end{0};
+    std::atomic<uint32_t> depth{0};
+  };
+
+  struct ThreadBuffer {
+    std::unique_ptr<ZoneSlot[]> slots;
+    std::atomic<uint64_t> head{0};
+    // read cursor of the frame aggregation, only touched by the FrameMark thread
+    uint64_t frame_cursor{0};
+    uint32_t thread_id{0};
+    std::string thread_name;
+  };
+
+  Profiler();
+  ThreadBuffer* LocalBuffer() {
+    thread_local ThreadBuffer* buffer = RegisterThread();
+    return buffer;
+  }
+  ThreadBuffer* RegisterThread();
+  /// @brief Copy the zone with the given index, false if the producer lapped it meanwhile.
+  static bool ReadZone(const ThreadBuffer& buffer, uint64_t index, ZoneEvent& event);
+  void Calibrate();
+
+  double m_ns_per_tick{1.0};
+  uint64_t m_start_tick{0};
+
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+  std::unordered_set<std::string> m_interned;
+
+  uint64_t m_last_frame_tick{0};
+  double m_last_frame_ms{0.0};
+  std::vector<ZoneStats> m_frame_stats;
+  std::vector<uint64_t> m_frame_marks;
+  double m_zone_overhead_ns{0.0};
+};
+
+class ProfileZone {
+public:
+  explicit ProfileZone(const char* name)
+      : m_name(name), m_depth(Profiler::Depth()++), m_begin(Profiler::Now()) {}
+  ~ProfileZone() {
+    const auto end = Profiler::Now();
+    Profiler::Depth()--;
+    Profiler::Get().RecordZone(m_name, m_begin, end, m_depth);
+  }
+  ProfileZone(const ProfileZone&)            = delete;
+  ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+  const char* m_name;
+  uint32_t m_depth;
+  uint64_t m_begin;
+};
+}  // namespace ezg::util
+
+#ifdef EZG_ENABLE_PROFILER
+#define EZG_PROFILE_CONCAT_IMPL(a, b) a##b
+#define EZG_PROFILE_CONCAT(a, b) EZG_PROFILE_CONCAT_IMPL(a, b)
+/// name must outlive the profiler: a string literal or a pointer returned by Profiler::Intern
+#define EZG_PROFILE_ZONE(name) \
+  ::ezg::util::ProfileZone EZG_PROFILE_CONCAT(ezg_profile_zone_, __LINE__) { name }
+#define EZG_PROFILE_FUNCTION() EZG_PROFILE_ZONE(__func__)
+#define EZG_PROFILE_FRAME() ::ezg::util::Profiler::Get().FrameMark()
+/// stable zone name for a runtime string, resolve it once at setup time and not per zone
+#define EZG_PROFILE_NAME(str) ::ezg::util::Profiler::Get().Intern(str)
+#else
+#define EZG_PROFILE_ZONE(name)
+#define EZG_PROFILE_FUNCTION()
+#define EZG_PROFILE_FRAME()
+#define EZG_PROFILE_NAME(str) nullptr
+#endif
+
+#endif  //PROFILER_HPP
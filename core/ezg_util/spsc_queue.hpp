@@ -0,0 +1,46 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ezg::util {
+/// @brief Bounded lock-free queue for exactly one producer and one consumer thread.
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "capacity must be a power of two");
+
+public:
+  /// @brief Producer side, returns false and drops the value if the queue is full.
+  bool TryPush(const T& value) {
+    const auto head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    m_items[head & (Capacity - 1)] = value;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Consumer side, returns false if the queue is empty.
+  bool TryPop(T& value) {
+    const auto tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = m_items[tail & (Capacity - 1)];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  // producer and consumer cursors on their own cache lines
+  alignas(64) std::atomic<uint64_t> m_head{0};
+  alignas(64) std::atomic<uint64_t> m_tail{0};
+  std::array<T, Capacity> m_items{};
+};
+}  // namespace ezg::util
+
+#endif  //SPSC_QUEUE_HPP
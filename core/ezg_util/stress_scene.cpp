@@ -0,0 +1,191 @@
+#include "stress_scene.hpp"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace ezg::util {
+static constexpr float TwoPi = 6.28318530718f;
+
+// streams of the per instance random numbers, every property draws from its own
+enum RandomStream : uint64_t {
+  MeshStream,
+  MaterialStream,
+  PositionXStream,
+  PositionYStream,
+  PositionZStream,
+  ClusterStream,
+  ScaleStream,
+  PhaseStream,
+  AnimatedStream,
+  ClusterCenterStream,
+};
+
+// splitmix64, the layout only depends on the seed, not on the standard library
+static uint64_t Hash(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+StressSceneGenerator::StressSceneGenerator(const StressSceneConfig& config) : m_config(config) {
+  m_config.num_objects   = std::max(m_config.num_objects, 1u);
+  m_config.num_meshes    = std::max(m_config.num_meshes, 1u);
+  m_config.num_materials = std::max(m_config.num_materials, 1u);
+  m_config.num_clusters  = std::max(m_config.num_clusters, 1u);
+
+  const auto num_objects = static_cast<double>(m_config.num_objects);
+  m_grid_side            = static_cast<uint32_t>(std::ceil(std::cbrt(num_objects)));
+  // a few object sizes between neighbours of the grid
+  m_extent = m_config.extent > 0.0f ? m_config.extent
+                                    : 0.5f * static_cast<float>(m_grid_side) * 3.0f *
+                                          m_config.object_scale;
+
+  m_cluster_centers.resize(m_config.num_clusters);
+  for (uint32_t i = 0; i < m_config.num_clusters; i++) {
+    m_cluster_centers[i] = {
+        m_extent * (2.0f * Random(i * 3 + 0, ClusterCenterStream) - 1.0f),
+        m_extent * (2.0f * Random(i * 3 + 1, ClusterCenterStream)),
+        m_extent * (2.0f * Random(i * 3 + 2, ClusterCenterStream) - 1.0f),
+    };
+  }
+
+  m_instances.resize(m_config.num_objects);
+  for (uint32_t i = 0; i < m_config.num_objects; i++) {
+    auto& instance    = m_instances[i];
+    instance.mesh     = PickPrototype(i, m_config.num_meshes, MeshStream);
+    instance.material = PickPrototype(i, m_config.num_materials, MaterialStream);
+    instance.position = PlaceInstance(i);
+    instance.scale    = m_config.object_scale * (0.75f + 0.5f * Random(i, ScaleStream));
+    instance.phase    = TwoPi * Random(i, PhaseStream);
+    instance.animated = Random(i, AnimatedStream) < m_config.animated_fraction;
+    if (instance.animated) {
+      m_animated.push_back(i);
+    }
+  }
+}
+
+float StressSceneGenerator::Random(uint64_t index, uint64_t stream) const {
+  const auto bits = Hash(Hash((static_cast<uint64_t>(m_config.seed) << 32) ^ stream) ^ index);
+  // top 24 bits fill the float mantissa exactly, the result is in [0, 1)
+  return static_cast<float>(bits >> 40) * (1.0f / 16777216.0f);
+}
+
+uint32_t StressSceneGenerator::PickPrototype(uint32_t index, uint32_t count,
+                                             uint64_t stream) const {
+  switch (m_config.repetition) {
+    case StressRepetition::Sequential:
+      return static_cast<uint32_t>(static_cast<uint64_t>(index) * count / m_config.num_objects);
+    case StressRepetition::Interleaved:
+      return index % count;
+    case StressRepetition::Random:
+      return std::min(count - 1, static_cast<uint32_t>(Random(index, stream) * count));
+  }
+  return 0;
+}
+
+glm::vec3 StressSceneGenerator::PlaceInstance(uint32_t index) const {
+  switch (m_config.distribution) {
+    case StressDistribution::Grid: {
+      const auto spacing = 2.0f * m_extent / static_cast<float>(m_grid_side);
+      const auto x       = index % m_grid_side;
+      const auto z       = (index / m_grid_side) % m_grid_side;
+      const auto y       = index / (m_grid_side * m_grid_side);
+      return {-m_extent + (static_cast<float>(x) + 0.5f) * spacing,
+              (static_cast<float>(y) + 0.5f) * spacing,
+              -m_extent + (static_cast<float>(z) + 0.5f) * spacing};
+    }
+    case StressDistribution::Uniform:
+      return {m_extent * (2.0f * Random(index, PositionXStream) - 1.0f),
+              m_extent * (2.0f * Random(index, PositionYStream)),
+              m_extent * (2.0f * Random(index, PositionZStream) - 1.0f)};
+    case StressDistribution::Clusters: {
+      const auto cluster = std::min(m_config.num_clusters - 1,
+                                    static_cast<uint32_t>(Random(index, ClusterStream) *
+                                                          m_config.num_clusters));
+      // gaussian offsets (Box-Muller), clusters shrink as there are more of them
+      const auto num_clusters = static_cast<float>(m_config.num_clusters);
+      const auto sigma        = m_extent / (2.0f * std::cbrt(num_clusters));
+      const auto u            = 1.0f - Random(index, PositionXStream);
+      const auto radius       = sigma * std::sqrt(-2.0f * std::log(u));
+      const auto theta        = TwoPi * Random(index, PositionYStream);
+      const auto height       = sigma * (2.0f * Random(index, PositionZStream) - 1.0f);
+      const auto position     = m_cluster_centers[cluster] +
+                            glm::vec3(radius * std::cos(theta), height, radius * std::sin(theta));
+      return glm::clamp(position, GetBoundsMin(), GetBoundsMax());
+    }
+  }
+  return glm::vec3(0.0f);
+}
+
+glm::vec3 StressSceneGenerator::GetBoundsMin() const {
+  return {-m_extent, 0.0f, -m_extent};
+}
+
+glm::vec3 StressSceneGenerator::GetBoundsMax() const {
+  return {m_extent, 2.0f * m_extent, m_extent};
+}
+
+glm::mat4 StressSceneGenerator::ComputeTransform(uint32_t index, float time) const {
+  const auto& instance = m_instances[index];
+  auto position        = instance.position;
+  auto angle           = instance.phase;
+  if (instance.animated) {
+    switch (m_config.animation) {
+      case StressAnimation::Spin:
+        angle += time * (0.5f + instance.phase / TwoPi);
+        break;
+      case StressAnimation::Orbit: {
+        const auto theta = time + instance.phase;
+        position += 2.0f * instance.scale * glm::vec3(std::cos(theta), 0.0f, std::sin(theta));
+        break;
+      }
+      case StressAnimation::Bounce:
+        position.y += 2.0f * instance.scale * std::abs(std::sin(2.0f * time + instance.phase));
+        break;
+    }
+  }
+  auto transform = glm::translate(glm::mat4(1.0f), position);
+  transform      = glm::rotate(transform, angle, glm::vec3(0.0f, 1.0f, 0.0f));
+  return glm::scale(transform, glm::vec3(instance.scale));
+}
+
+bool StressSceneGenerator::ParseDistribution(std::string_view name, StressDistribution& out) {
+  if (name == "grid") {
+    out = StressDistribution::Grid;
+  } else if (name == "uniform") {
+    out = StressDistribution::Uniform;
+  } else if (name == "clusters") {
+    out = StressDistribution::Clusters;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool StressSceneGenerator::ParseRepetition(std::string_view name, StressRepetition& out) {
+  if (name == "sequential") {
+    out = StressRepetition::Sequential;
+  } else if (name == "interleaved") {
+    out = StressRepetition::Interleaved;
+  } else if (name == "random") {
+    out = StressRepetition::Random;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool StressSceneGenerator::ParseAnimation(std::string_view name, StressAnimation& out) {
+  if (name == "spin") {
+    out = StressAnimation::Spin;
+  } else if (name == "orbit") {
+    out = StressAnimation::Orbit;
+  } else if (name == "bounce") {
+    out = StressAnimation::Bounce;
+  } else {
+    return false;
+  }
+  return true;
+}
+}  // namespace ezg::util
@@ -0,0 +1,83 @@
+#ifndef STRESS_SCENE_HPP
+#define STRESS_SCENE_HPP
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <string_view>
+#include <vector>
+
+namespace ezg::util {
+enum class StressDistribution { Grid, Uniform, Clusters };
+
+// how instances pick their mesh and material prototypes
+enum class StressRepetition {
+  // runs of the same mesh / material, the best case for state sorting
+  Sequential,
+  // the prototype changes on every instance, the worst case
+  Interleaved,
+  Random,
+};
+
+enum class StressAnimation { Spin, Orbit, Bounce };
+
+struct StressSceneConfig {
+  uint32_t num_objects{1000};
+  // number of distinct meshes / materials the objects are instanced from
+  uint32_t num_meshes{8};
+  uint32_t num_materials{8};
+  StressDistribution distribution{StressDistribution::Grid};
+  StressRepetition repetition{StressRepetition::Interleaved};
+  // half size of the volume the objects are spread over, 0 derives it from the object count
+  float extent{0.0f};
+  float object_scale{0.4f};
+  uint32_t num_clusters{16};
+  // share of objects whose transform changes every frame
+  float animated_fraction{0.0f};
+  StressAnimation animation{StressAnimation::Spin};
+  uint32_t seed{1};
+};
+
+struct StressInstance {
+  uint32_t mesh;
+  uint32_t material;
+  glm::vec3 position;
+  float scale;
+  // per instance animation offset in radians
+  float phase;
+  bool animated;
+};
+
+/// @brief Deterministic procedural scene layout for scaling tests. Only indices and transforms
+/// are generated, the engines build the mesh and material prototypes themselves.
+class StressSceneGenerator {
+public:
+  explicit StressSceneGenerator(const StressSceneConfig& config);
+
+  [[nodiscard]] const StressSceneConfig& GetConfig() const { return m_config; }
+  [[nodiscard]] const std::vector<StressInstance>& GetInstances() const { return m_instances; }
+  /// @brief Indices of the instances to update every frame.
+  [[nodiscard]] const std::vector<uint32_t>& GetAnimated() const { return m_animated; }
+  [[nodiscard]] float GetExtent() const { return m_extent; }
+  [[nodiscard]] glm::vec3 GetBoundsMin() const;
+  [[nodiscard]] glm::vec3 GetBoundsMax() const;
+
+  /// @brief Model matrix of an instance at time seconds, static instances ignore the time.
+  [[nodiscard]] glm::mat4 ComputeTransform(uint32_t index, float time) const;
+
+  static bool ParseDistribution(std::string_view name, StressDistribution& out);
+  static bool ParseRepetition(std::string_view name, StressRepetition& out);
+  static bool ParseAnimation(std::string_view name, StressAnimation& out);
+
+private:
+  uint32_t PickPrototype(uint32_t index, uint32_t count, uint64_t stream) const;
+  glm::vec3 PlaceInstance(uint32_t index) const;
+  float Random(uint64_t index, uint64_t stream) const;
+
+  StressSceneConfig m_config;
+  float m_extent;
+  uint32_t m_grid_side{1};
+  std::vector<glm::vec3> m_cluster_centers;
+  std::vector<StressInstance> m_instances;
+  std::vector<uint32_t> m_animated;
+};
+}  // namespace ezg::util
+#endif  //STRESS_SCENE_HPP
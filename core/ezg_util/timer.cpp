@@ -1,4 +1,12 @@
 #include "timer.hpp"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
 namespace ezg::util {
 FrameTimer::FrameTimer() {
   m_initialisation_time = std::chrono::high_resolution_clock::now();
@@ -27,4 +35,26 @@ float FrameTimer::TimeStepSinceInitialisation() {
 
   return time_duration;
 }
-}  // namespace ezg::util
\ No newline at end of file
+
+double ProcessCpuTime() {
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time,
+                       &user_time)) {
+    return 0.0;
+  }
+  // FILETIME counts 100 ns intervals
+  const auto to_seconds = [](const FILETIME& time) {
+    ULARGE_INTEGER value;
+    value.LowPart  = time.dwLowDateTime;
+    value.HighPart = time.dwHighDateTime;
+    return static_cast<double>(value.QuadPart) * 1e-7;
+  };
+  return to_seconds(kernel_time) + to_seconds(user_time);
+#else
+  timespec time{};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+#endif
+}
+}  // namespace ezg::util
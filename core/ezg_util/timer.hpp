@@ -20,6 +20,10 @@ public:
   /// time which has passed since initialisation and now.
   [[nodiscard]] float TimeStepSinceInitialisation();
 };
+
+/// @brief CPU time consumed by all threads of the process in seconds, divide the difference of
+/// two calls by the elapsed wall time to get the CPU usage.
+[[nodiscard]] double ProcessCpuTime();
 }
 
 #endif  //TIMER_HPP
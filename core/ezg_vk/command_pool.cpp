@@ -1,5 +1,6 @@
 #include "command_pool.hpp"
 #include "device.hpp"
+#include "ezg_util/profiler.hpp"
 
 namespace ezg::vk {
 CommandPool::CommandPool(const Device* device, uint32_t qFamilyIndex) : m_device(device) {
@@ -75,6 +76,7 @@ void CommandPool::Trim() {
 }
 
 VkCommandBuffer CommandPool::RequestCmdBuffer() {
+  EZG_PROFILE_FUNCTION();
   if (m_index < m_buffers.size()) {
     auto ret = m_buffers[m_index++];
     m_inFlight.insert(ret);
@@ -1,6 +1,7 @@
 #include "swapchain.hpp"
 #include "device.hpp"
 #include "window.hpp"
+#include "ezg_util/profiler.hpp"
 
 namespace ezg::vk {
 Swapchain::Swapchain(const Device* device, const WindowSurface& surface, uint32_t width,
@@ -25,6 +26,7 @@ Swapchain::~Swapchain() {
 }
 
 uint32_t Swapchain::AcquireNextImage(VkSemaphore semaphore) {
+  EZG_PROFILE_FUNCTION();
   uint32_t imageIndex = 0;
   vkAcquireNextImageKHR(m_device->Handle(), m_swapchain, std::numeric_limits<std::uint64_t>::max(),
                         semaphore, VK_NULL_HANDLE, &imageIndex);
@@ -177,6 +179,7 @@ std::optional<VkCompositeAlphaFlagBitsKHR> Swapchain::FindCompositeAlphaFormat()
 }
 
 void Swapchain::Recreate(uint32_t windowWidth, uint32_t windowHeight) {
+  EZG_PROFILE_FUNCTION();
   // Store the old swapchain. This allows us to pass it to VkSwapchainCreateInfoKHR::oldSwapchain to speed up swapchain recreation.
   VkSwapchainKHR oldSwapchain = m_swapchain;
   // When swapchain needs to be recreated, all the old swapchain images need to be destroyed.
@@ -278,6 +281,7 @@ void Swapchain::Setup(VkSwapchainKHR oldSwapchain, uint32_t width, uint32_t heig
 }
 
 void Swapchain::QueuePresent(uint32_t imageIndex, VkSemaphore waitSemaphore) {
+  EZG_PROFILE_FUNCTION();
   VkPresentInfoKHR presentInfo{.sType          = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
                                .pNext          = nullptr,
                                .swapchainCount = 1,
@@ -1,4 +1,5 @@
 #include "vk_device.hpp"
+#include <algorithm>
 #include <memory>
 #include <string>
 #include "vk_functions.hpp"
@@ -59,10 +60,17 @@ PhysicalDevice PhysicalDeviceSelector::Select() {
   }
 
   auto fill_out_phys_dev_with_criteria = [&](PhysicalDevice& pd) {
-    pd.features = criteria.requiredFeatures;
+    pd.features                    = criteria.requiredFeatures;
+    const auto availableExtensions = pd.extensions;
     pd.extensions.clear();
     pd.extensions.insert(pd.extensions.end(), criteria.requiredExtensions.begin(),
                          criteria.requiredExtensions.end());
+    for (const auto& ext : criteria.optionalExtensions) {
+      if (std::find(availableExtensions.begin(), availableExtensions.end(), ext) !=
+          availableExtensions.end()) {
+        pd.extensions.push_back(ext);
+      }
+    }
     //    if (portability_ext_available) {
     //      pd.extensions.push_back("VK_KHR_portability_subset");
     //    }
@@ -153,6 +161,10 @@ PhysicalDeviceSelectorRef PhysicalDeviceSelector::AddRequiredExtension(
                                      extensions.cend());
   return *this;
 }
+PhysicalDeviceSelectorRef PhysicalDeviceSelector::AddOptionalExtension(const char* extension) {
+  criteria.optionalExtensions.emplace_back(extension);
+  return *this;
+}
 PhysicalDeviceSelectorRef PhysicalDeviceSelector::SetSurface(VkSurfaceKHR surface) {
   instanceInfo.surface = surface;
   return *this;
@@ -54,6 +54,8 @@ public:
   PhysicalDevice Select();
   PhysicalDeviceSelectorRef AddRequiredExtension(const char* extension);
   PhysicalDeviceSelectorRef AddRequiredExtension(std::vector<const char*>& extensions);
+  // enabled when the selected device supports it, check GetExtensions() after Select()
+  PhysicalDeviceSelectorRef AddOptionalExtension(const char* extension);
   PhysicalDeviceSelectorRef SetSurface(VkSurfaceKHR surface);
   PhysicalDeviceSelectorRef SetRequiredFeatures(const VkPhysicalDeviceFeatures& features);
   PhysicalDeviceSelectorRef RequirePresent(bool flag);
@@ -73,6 +75,7 @@ private:
     bool requireDedicateComputeQueue  = false;
     bool requireDedicateTransferQueue = true;
     std::vector<std::string> requiredExtensions;
+    std::vector<std::string> optionalExtensions;
     VkPhysicalDeviceFeatures requiredFeatures{};
   } criteria;
 };
@@ -1,7 +1,7 @@
 #include "vk_pipeline.hpp"
 #include "vk_tools.hpp"
 namespace vkh {
-VkPipeline PipelineBuilder::Build(VkDevice device, VkRenderPass pass) {
+VkPipeline PipelineBuilder::Build(VkDevice device, VkRenderPass pass, VkPipelineCache cache) {
   //make viewport state from our stored viewport and scissor.
   //at the moment we wont support multiple viewports or scissors
   VkPipelineViewportStateCreateInfo viewportState{};
@@ -46,8 +46,8 @@ VkPipeline PipelineBuilder::Build(VkDevice device, VkRenderPass pass) {
 
   //its easy to error out on create graphics pipeline, so we handle it a bit better than the common VK_CHECK case
   VkPipeline newPipeline;
-  if (fp_vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
-                                   &newPipeline) != VK_SUCCESS) {
+  if (fp_vkCreateGraphicsPipelines(device, cache, 1, &pipelineInfo, nullptr, &newPipeline) !=
+      VK_SUCCESS) {
     vkh::Log("Failed to create pipeline!");
     return VK_NULL_HANDLE;  // failed to create graphics pipeline
   } else {
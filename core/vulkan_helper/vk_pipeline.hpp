@@ -23,7 +23,7 @@ public:
   VkPipelineLayout m_pipelineLayout;
   VkPipelineDepthStencilStateCreateInfo m_depthStencil;
 
-  VkPipeline Build(VkDevice device, VkRenderPass pass);
+  VkPipeline Build(VkDevice device, VkRenderPass pass, VkPipelineCache cache = VK_NULL_HANDLE);
 
 private:
   PFN_vkCreateGraphicsPipelines fp_vkCreateGraphicsPipelines;
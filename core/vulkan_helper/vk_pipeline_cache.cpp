@@ -0,0 +1,123 @@
+#include "vk_pipeline_cache.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "vk_functions.hpp"
+#include "vk_tools.hpp"
+
+namespace vkh {
+void PipelineCache::Init(VkDevice device, const VkPhysicalDeviceProperties& properties,
+                         std::string path) {
+  m_device     = device;
+  m_properties = properties;
+  m_path       = std::move(path);
+
+  auto& functions = VulkanFunction::GetInstance();
+  m_table.fp_vkCreatePipelineCache = reinterpret_cast<PFN_vkCreatePipelineCache>(
+      functions.fp_vkGetDeviceProcAddr(m_device, "vkCreatePipelineCache"));
+
+  m_table.fp_vkDestroyPipelineCache = reinterpret_cast<PFN_vkDestroyPipelineCache>(
+      functions.fp_vkGetDeviceProcAddr(m_device, "vkDestroyPipelineCache"));
+
+  m_table.fp_vkGetPipelineCacheData = reinterpret_cast<PFN_vkGetPipelineCacheData>(
+      functions.fp_vkGetDeviceProcAddr(m_device, "vkGetPipelineCacheData"));
+
+  m_table.fp_vkMergePipelineCaches = reinterpret_cast<PFN_vkMergePipelineCaches>(
+      functions.fp_vkGetDeviceProcAddr(m_device, "vkMergePipelineCaches"));
+
+  std::ifstream file(m_path, std::ios::ate | std::ios::binary);
+  if (file.is_open()) {
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(data.data(), static_cast<std::streamsize>(data.size()));
+    if (IsCompatible(data)) {
+      m_initialData = std::move(data);
+      m_loaded      = true;
+    } else {
+      Log("Pipeline cache " + m_path + " was written by another device or driver, ignoring it");
+    }
+  }
+
+  VkPipelineCacheCreateInfo cacheInfo{};
+  cacheInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  cacheInfo.initialDataSize = m_initialData.size();
+  cacheInfo.pInitialData    = m_initialData.empty() ? nullptr : m_initialData.data();
+  VkCheck(m_table.fp_vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_cache),
+          "create pipeline cache");
+}
+
+bool PipelineCache::IsCompatible(const std::vector<char>& data) const {
+  VkPipelineCacheHeaderVersionOne header{};
+  if (data.size() < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  return header.headerSize >= sizeof(header) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == m_properties.vendorID && header.deviceID == m_properties.deviceID &&
+         memcmp(header.pipelineCacheUUID, m_properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+VkPipelineCache PipelineCache::CreateWorkerCache() {
+  VkPipelineCacheCreateInfo cacheInfo{};
+  cacheInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  cacheInfo.initialDataSize = m_initialData.size();
+  cacheInfo.pInitialData    = m_initialData.empty() ? nullptr : m_initialData.data();
+  VkPipelineCache workerCache;
+  VkCheck(m_table.fp_vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &workerCache),
+          "create worker pipeline cache");
+  std::lock_guard lock(m_workerMutex);
+  m_workerCaches.push_back(workerCache);
+  return workerCache;
+}
+
+void PipelineCache::MergeWorkerCaches() {
+  std::lock_guard lock(m_workerMutex);
+  if (m_workerCaches.empty()) {
+    return;
+  }
+  // the worker caches must not be in use anymore
+  VkCheck(m_table.fp_vkMergePipelineCaches(m_device, m_cache,
+                                           static_cast<uint32_t>(m_workerCaches.size()),
+                                           m_workerCaches.data()),
+          "merge pipeline caches");
+  for (auto workerCache : m_workerCaches) {
+    m_table.fp_vkDestroyPipelineCache(m_device, workerCache, nullptr);
+  }
+  m_workerCaches.clear();
+}
+
+bool PipelineCache::Save() {
+  MergeWorkerCaches();
+  size_t size = 0;
+  VkCheck(m_table.fp_vkGetPipelineCacheData(m_device, m_cache, &size, nullptr),
+          "get pipeline cache size");
+  std::vector<char> data(size);
+  VkCheck(m_table.fp_vkGetPipelineCacheData(m_device, m_cache, &size, data.data()),
+          "get pipeline cache data");
+
+  // write next to the old file and swap, a crash never leaves a truncated cache behind
+  const std::string tmpPath = m_path + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      Log("Failed to write pipeline cache " + tmpPath);
+      return false;
+    }
+    file.write(data.data(), static_cast<std::streamsize>(size));
+  }
+  std::error_code error;
+  std::filesystem::rename(tmpPath, m_path, error);
+  if (error) {
+    Log("Failed to replace pipeline cache " + m_path + ": " + error.message());
+    return false;
+  }
+  return true;
+}
+
+void PipelineCache::Cleanup() {
+  Save();
+  m_table.fp_vkDestroyPipelineCache(m_device, m_cache, nullptr);
+  m_cache = VK_NULL_HANDLE;
+}
+}  // namespace vkh
@@ -0,0 +1,54 @@
+#ifndef VK_PIPELINE_CACHE_HPP
+#define VK_PIPELINE_CACHE_HPP
+
+#include <vulkan/vulkan.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vkh {
+/// @brief VkPipelineCache persisted in a file. The file is only used if its header matches the
+/// vendor, device and pipeline cache UUID of the current driver, otherwise the cache starts empty.
+class PipelineCache {
+public:
+  void Init(VkDevice device, const VkPhysicalDeviceProperties& properties, std::string path);
+
+  /// @brief Merge the worker caches, write the data to the file and destroy all caches.
+  void Cleanup();
+
+  VkPipelineCache Get() const { return m_cache; }
+
+  /// @brief Separate cache for one compiling thread, seeded with the file data. It is merged into
+  /// the main cache by MergeWorkerCaches / Cleanup.
+  VkPipelineCache CreateWorkerCache();
+
+  void MergeWorkerCaches();
+
+  bool Save();
+
+  /// @brief true if the file held a valid cache for this device, i.e. a warm start.
+  bool WasLoaded() const { return m_loaded; }
+
+private:
+  bool IsCompatible(const std::vector<char>& data) const;
+
+  VkDevice m_device{VK_NULL_HANDLE};
+  VkPhysicalDeviceProperties m_properties{};
+  std::string m_path;
+
+  VkPipelineCache m_cache{VK_NULL_HANDLE};
+  std::vector<char> m_initialData;
+  bool m_loaded{false};
+
+  std::mutex m_workerMutex;
+  std::vector<VkPipelineCache> m_workerCaches;
+
+  struct {
+    PFN_vkCreatePipelineCache fp_vkCreatePipelineCache;
+    PFN_vkDestroyPipelineCache fp_vkDestroyPipelineCache;
+    PFN_vkGetPipelineCacheData fp_vkGetPipelineCacheData;
+    PFN_vkMergePipelineCaches fp_vkMergePipelineCaches;
+  } m_table;
+};
+}  // namespace vkh
+#endif  //VK_PIPELINE_CACHE_HPP
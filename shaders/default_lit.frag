@@ -3,6 +3,7 @@
 
 //shader input
 layout (location = 0) in vec3 inColor;
+layout (location = 2) flat in uint materialIndex;
 
 //output write
 layout (location = 0) out vec4 outFragColor;
@@ -15,8 +16,22 @@ layout(set = 0, binding = 1) uniform  SceneData{
 	vec4 sunlightColor;
 } sceneData;
 
+//every material, indexed by the object data
+struct MaterialData{
+	vec4 baseColor;
+	uint albedoTexture;
+	uint pad0;
+	uint pad1;
+	uint pad2;
+};
+
+layout(std430, set = 2, binding = 1) readonly buffer MaterialBuffer{
+	MaterialData materials[];
+} materialBuffer;
+
 
 void main() 
 {	
-	outFragColor = vec4(inColor + sceneData.ambientColor.xyz,1.0f);
+	vec4 baseColor = materialBuffer.materials[materialIndex].baseColor;
+	outFragColor = vec4(inColor + sceneData.ambientColor.xyz,1.0f) * baseColor;
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 
 layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
-layout (location = 2) in vec3 vColor;
 
 layout (location = 0) out vec3 outColor;
 
@@ -18,6 +17,6 @@ void main()
 	mat4 model = PushConstants.render_matrix;
 	gl_Position = model * vec4(vPosition, 1.0f);	
 
-	outColor = vColor;
+	outColor = vNormal;
 }
 
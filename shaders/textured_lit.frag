@@ -1,9 +1,11 @@
 //glsl version 4.5
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 //shader input
 layout (location = 0) in vec3 inColor;
 layout (location = 1) in vec2 texCoord;
+layout (location = 2) flat in uint materialIndex;
 //output write
 layout (location = 0) out vec4 outFragColor;
 
@@ -15,10 +17,27 @@ layout(set = 0, binding = 1) uniform  SceneData{
 	vec4 sunlightColor;
 } sceneData;
 
-layout(set = 2, binding = 0) uniform sampler2D tex1;
+//every loaded texture, partially bound
+layout(set = 2, binding = 0) uniform sampler2D textures[];
+
+//every material, indexed by the object data
+struct MaterialData{
+	vec4 baseColor;
+	uint albedoTexture;
+	uint pad0;
+	uint pad1;
+	uint pad2;
+};
+
+layout(std430, set = 2, binding = 1) readonly buffer MaterialBuffer{
+	MaterialData materials[];
+} materialBuffer;
 
 void main() 
 {
-	vec3 color = texture(tex1,texCoord).xyz;
+	MaterialData material = materialBuffer.materials[materialIndex];
+	//the material comes from the object data, the index isn't dynamically uniform
+	vec3 color = texture(textures[nonuniformEXT(material.albedoTexture)],texCoord).xyz;
+	color *= material.baseColor.xyz;
 	outFragColor = vec4(color,1.0f);
 }
\ No newline at end of file
@@ -1,7 +1,6 @@
 #version 450
 layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
-layout (location = 2) in vec3 vColor;
 
 layout (location = 0) out vec3 outColor;
 
@@ -23,5 +22,5 @@ void main()
 {	
 	mat4 transformMatrix = (cameraData.viewproj * PushConstants.render_matrix);
 	gl_Position = transformMatrix * vec4(vPosition, 1.0f);
-	outColor = vColor;
+	outColor = vNormal;
 }
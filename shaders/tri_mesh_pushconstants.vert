@@ -1,7 +1,6 @@
 #version 450
 layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
-layout (location = 2) in vec3 vColor;
 
 layout (location = 0) out vec3 outColor;
 
@@ -15,5 +14,5 @@ layout( push_constant ) uniform constants
 void main() 
 {	
 	gl_Position = PushConstants.render_matrix * vec4(vPosition, 1.0f);
-	outColor = vColor;
+	outColor = vNormal;
 }
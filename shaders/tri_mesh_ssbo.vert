@@ -2,11 +2,11 @@
 
 layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
-layout (location = 2) in vec3 vColor;
 layout (location = 3) in vec2 vTexCoord;
 
 layout (location = 0) out vec3 outColor;
 layout (location = 1) out vec2 texCoord;
+layout (location = 2) flat out uint materialIndex;
 
 layout(set = 0, binding = 0) uniform  CameraBuffer{   
     mat4 view;
@@ -16,6 +16,7 @@ layout(set = 0, binding = 0) uniform  CameraBuffer{
 
 struct ObjectData{
 	mat4 model;
+	uint materialIndex;
 }; 
 
 //all object matrices
@@ -24,6 +25,11 @@ layout(std140,set = 1, binding = 0) readonly buffer ObjectBuffer{
 	ObjectData objects[];
 } objectBuffer;
 
+//object index of every drawn instance, written by cull.comp
+layout(std430, set = 1, binding = 1) readonly buffer VisibleBuffer{
+	uint ids[];
+} visibleBuffer;
+
 //push constants block
 layout( push_constant ) uniform constants
 {
@@ -33,10 +39,12 @@ layout( push_constant ) uniform constants
 
 void main() 
 {	
-	mat4 modelMatrix = objectBuffer.objects[gl_BaseInstance].model;
+	ObjectData object = objectBuffer.objects[visibleBuffer.ids[gl_InstanceIndex]];
+	mat4 modelMatrix = object.model;
 	mat4 transformMatrix = (cameraData.viewproj * modelMatrix);
 //	mat4 transformMatrix = (cameraData.viewproj * PushConstants.render_matrix);
 	gl_Position = transformMatrix * vec4(vPosition, 1.0f);
-	outColor = vColor;
+	outColor = vNormal;
 	texCoord = vTexCoord;
+	materialIndex = object.materialIndex;
 }
@@ -2,7 +2,6 @@
 
 layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
-layout (location = 2) in vec3 vColor;
 layout (location = 3) in vec2 vTexCoord;
 
 layout (location = 0) out vec3 outColor;
@@ -37,6 +36,6 @@ void main()
 	mat4 transformMatrix = (cameraData.viewproj * modelMatrix);
 //	mat4 transformMatrix = (cameraData.viewproj * PushConstants.render_matrix);
 	gl_Position = transformMatrix * vec4(vPosition, 1.0f);
-	outColor = vColor;
+	outColor = vNormal;
 	texCoord = vTexCoord;
 }